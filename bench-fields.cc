@@ -0,0 +1,151 @@
+// Dump and parse time of a generated struct with FIELDS (10, 50, 200) fields, results are written to stdout in json
+// compile time is measured by make bench-fields, which builds this file for every number of fields
+// usage: bench-fields [runs]
+
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+#include "json-struct.hh"
+
+#ifndef FIELDS
+#define FIELDS 50
+#endif
+
+// ----------------------------------------------------------------------
+// generated struct
+// ----------------------------------------------------------------------
+
+#define FIELDS_10(M, p) M(int, p##0) M(double, p##1) M(std::string, p##2) M(bool, p##3) M(long, p##4) M(double, p##5) M(std::vector<int>, p##6) M(int, p##7) M(std::string, p##8) M(double, p##9)
+#define FIELDS_50(M, p) FIELDS_10(M, p##0_) FIELDS_10(M, p##1_) FIELDS_10(M, p##2_) FIELDS_10(M, p##3_) FIELDS_10(M, p##4_)
+#define FIELDS_100(M, p) FIELDS_50(M, p##a) FIELDS_50(M, p##b)
+#define FIELDS_200(M, p) FIELDS_100(M, p##c) FIELDS_100(M, p##d)
+
+#define CONCATENATE_(a, b) a##b
+#define CONCATENATE(a, b) CONCATENATE_(a, b)
+#define GENERATE(M) CONCATENATE(FIELDS_, FIELDS)(M, f_)
+
+#define DECLARE(type, name) type name{};
+#define LIST(type, name) #name, &a.name,
+#define FILL(type, name) fill(a.name, n++);
+
+class Generated
+{
+ public:
+    GENERATE(DECLARE)
+    int last{};
+
+    friend inline auto json_fields(Generated& a)
+        {
+            return std::make_tuple(GENERATE(LIST) "last", &a.last);
+        }
+};
+
+static inline void fill(int& target, int n) { target = n; }
+static inline void fill(long& target, int n) { target = -n * 1000L; }
+static inline void fill(double& target, int n) { target = n * 0.25; }
+static inline void fill(bool& target, int n) { target = n % 2 == 0; }
+static inline void fill(std::string& target, int n) { target = "value " + std::to_string(n); }
+static inline void fill(std::vector<int>& target, int n) { target = {n, n + 1}; }
+
+static inline std::vector<Generated> make_generated()
+{
+      // about the same number of fields in total for every FIELDS
+    std::vector<Generated> result(2000000 / (FIELDS + 1));
+    int n = 0;
+    for (auto& a: result) {
+        GENERATE(FILL)
+        a.last = n++;
+    }
+    return result;
+}
+
+// ----------------------------------------------------------------------
+// measuring
+// ----------------------------------------------------------------------
+
+class Timing
+{
+ public:
+    inline Timing() : seconds(0), ns_per_field(0) {}
+
+    double seconds;             // median of runs
+    double ns_per_field;
+
+    friend inline auto json_fields(Timing& a)
+        {
+            return std::make_tuple("seconds", &a.seconds, "ns/field", &a.ns_per_field);
+        }
+};
+
+class Result
+{
+ public:
+    inline Result() : fields(FIELDS + 1), objects(0), bytes(0), runs(0) {}
+
+    std::string compiler;
+    size_t fields;
+    size_t objects;
+    size_t bytes;
+    size_t runs;
+    Timing dump;
+    Timing parse;
+
+    friend inline auto json_fields(Result& a)
+        {
+            return std::make_tuple("compiler", &a.compiler, "fields", &a.fields, "objects", &a.objects, "bytes", &a.bytes, "runs", &a.runs, "dump", &a.dump, "parse", &a.parse);
+        }
+};
+
+template <typename F> static inline double seconds(F f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static inline Timing timing(std::vector<double> values, size_t fields)
+{
+    std::sort(values.begin(), values.end());
+    Timing result;
+    result.seconds = values[values.size() / 2];
+    result.ns_per_field = result.seconds * 1e9 / static_cast<double>(fields);
+    return result;
+}
+
+// ----------------------------------------------------------------------
+
+int main(int argc, const char* const* argv)
+{
+    const size_t runs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5;
+    if (runs == 0) {
+        std::cerr << "usage: " << argv[0] << " [runs]" << std::endl;
+        return 1;
+    }
+
+    const auto data = make_generated();
+    const auto text = json::dump(data);
+    std::vector<double> dump_seconds, parse_seconds;
+    for (size_t run = 0; run < runs; ++run) {
+        size_t size = 0;
+        dump_seconds.push_back(seconds([&]() { size = json::dump(data).size(); }));
+        std::vector<Generated> target;
+        parse_seconds.push_back(seconds([&]() { json::parse(text, target); }));
+        if (size != text.size() || json::dump(target) != text)
+            throw std::runtime_error("unstable dump or parse");
+    }
+
+    Result result;
+#ifdef __VERSION__
+    result.compiler = __VERSION__;
+#endif
+    result.objects = data.size();
+    result.bytes = text.size();
+    result.runs = runs;
+    result.dump = timing(dump_seconds, result.objects * result.fields);
+    result.parse = timing(parse_seconds, result.objects * result.fields);
+    std::cout << json::dump(result, 1) << std::endl;
+    return 0;
+}
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,676 @@
+// Parse and dump throughput for synthetic corpora, results are written to stdout in json
+// usage: bench [runs [corpus-name]]
+
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+// corpora
+// ----------------------------------------------------------------------
+
+class Numbers
+{
+ public:
+    std::vector<double> reals;
+    std::vector<int> integers;
+
+    friend inline auto json_fields(Numbers& a)
+        {
+            return std::make_tuple("reals", &a.reals, "integers", &a.integers);
+        }
+};
+
+class NumberLists               // Numbers read and written element by element
+{
+ public:
+    std::list<double> reals;
+    std::list<int> integers;
+
+    friend inline auto json_fields(NumberLists& a)
+        {
+            return std::make_tuple("reals", &a.reals, "integers", &a.integers);
+        }
+};
+
+class Strings
+{
+ public:
+    std::vector<std::string> lines;
+
+    friend inline auto json_fields(Strings& a)
+        {
+            return std::make_tuple("lines", &a.lines);
+        }
+};
+
+class Visit                     // few distinct strings repeated in every element
+{
+ public:
+    inline Visit() : id(0) {}
+
+    int id;
+    std::string country;
+    std::string host;
+    std::vector<std::string> tags;
+
+    friend inline auto json_fields(Visit& a)
+        {
+            return std::make_tuple("id", &a.id, "country", &a.country, "host", &a.host, "tags", &a.tags);
+        }
+};
+
+class InternedVisit
+{
+ public:
+    inline InternedVisit() : id(0) {}
+
+    int id;
+    json::interned_string country;
+    json::interned_string host;
+    std::vector<json::interned_string> tags;
+
+    friend inline auto json_fields(InternedVisit& a)
+        {
+            return std::make_tuple("id", &a.id, "country", &a.country, "host", &a.host, "tags", &a.tags);
+        }
+};
+
+class RawVisit
+{
+ public:
+    inline RawVisit() : id(0) {}
+
+    int id;
+    json::raw_string country;
+    json::raw_string host;
+    std::vector<json::raw_string> tags;
+
+    friend inline auto json_fields(RawVisit& a)
+        {
+            return std::make_tuple("id", &a.id, "country", &a.country, "host", &a.host, "tags", &a.tags);
+        }
+};
+
+class InternedVisits
+{
+ public:
+    json::string_pool pool;
+    std::vector<InternedVisit> visits;
+};
+
+enum class Level { debug, info, warning, error, fatal };
+
+inline auto json_enum_names(Level)
+{
+    return json::enum_names<Level>{{Level::debug, "debug"}, {Level::info, "info"}, {Level::warning, "warning"}, {Level::error, "error"}, {Level::fatal, "fatal"}};
+}
+
+class Levels                    // enum fields written as names
+{
+ public:
+    inline Levels() : l{} {}
+
+    std::array<Level, 6> l;
+
+    friend inline auto json_fields(Levels& a)
+        {
+            return std::make_tuple("l1", &a.l[0], "l2", &a.l[1], "l3", &a.l[2], "l4", &a.l[3], "l5", &a.l[4], "l6", &a.l[5]);
+        }
+};
+
+class LevelNames                // the same converted via std::string by a getter and a setter
+{
+ public:
+    inline LevelNames() : l{} {}
+
+    std::array<Level, 6> l;
+
+    template <size_t N> inline std::string get() const { return names()[static_cast<size_t>(l[N])]; }
+    template <size_t N> inline void set(std::string name) { l[N] = static_cast<Level>(std::find(names(), names() + 5, name) - names()); }
+    static inline const char* const* names() { static const char* const sNames[] = {"debug", "info", "warning", "error", "fatal"}; return sNames; }
+
+    friend inline auto json_fields(LevelNames& a)
+        {
+            return std::make_tuple("l1", json::field(&a, &LevelNames::get<0>, &LevelNames::set<0>), "l2", json::field(&a, &LevelNames::get<1>, &LevelNames::set<1>),
+                                   "l3", json::field(&a, &LevelNames::get<2>, &LevelNames::set<2>), "l4", json::field(&a, &LevelNames::get<3>, &LevelNames::set<3>),
+                                   "l5", json::field(&a, &LevelNames::get<4>, &LevelNames::set<4>), "l6", json::field(&a, &LevelNames::get<5>, &LevelNames::set<5>));
+        }
+};
+
+class Node
+{
+ public:
+    inline Node() : id(0) {}
+
+    int id;
+    std::string name;
+    std::vector<Node> children;
+
+    friend inline auto json_fields(Node& a)
+        {
+            return std::make_tuple("id", &a.id, "name", &a.name, "children", &a.children);
+        }
+};
+
+class Wide
+{
+ public:
+    inline Wide() : i1(0), i2(0), i3(0), i4(0), i5(0), i6(0), i7(0), i8(0), d1(0), d2(0), d3(0), d4(0), d5(0), d6(0), d7(0), d8(0), b1(false), b2(false), b3(false), b4(false) {}
+
+    int i1, i2, i3, i4, i5, i6, i7, i8;
+    double d1, d2, d3, d4, d5, d6, d7, d8;
+    bool b1, b2, b3, b4;
+    std::string s1, s2, s3, s4;
+    std::vector<int> v1, v2;
+
+    friend inline auto json_fields(Wide& a)
+        {
+            return std::make_tuple("integer_1", &a.i1, "integer_2", &a.i2, "integer_3", &a.i3, "integer_4", &a.i4,
+                                   "integer_5", &a.i5, "integer_6", &a.i6, "integer_7", &a.i7, "integer_8", &a.i8,
+                                   "real_1", &a.d1, "real_2", &a.d2, "real_3", &a.d3, "real_4", &a.d4,
+                                   "real_5", &a.d5, "real_6", &a.d6, "real_7", &a.d7, "real_8", &a.d8,
+                                   "flag_1", &a.b1, "flag_2", &a.b2, "flag_3", &a.b3, "flag_4", &a.b4,
+                                   "string_1", &a.s1, "string_2", &a.s2, "string_3", &a.s3, "string_4", &a.s4,
+                                   "vector_1", &a.v1, "vector_2", &a.v2);
+        }
+};
+
+class WideHead                  // first fields of Wide, the rest is skipped
+{
+ public:
+    inline WideHead() : i1(0) {}
+
+    int i1;
+    std::string s1;
+
+    friend inline auto json_fields(WideHead& a)
+        {
+            return std::make_tuple("integer_1", &a.i1, "string_1", &a.s1);
+        }
+};
+
+class Maps
+{
+ public:
+    std::map<std::string, std::map<std::string, int>> index;
+
+    friend inline auto json_fields(Maps& a)
+        {
+            return std::make_tuple("index", &a.index);
+        }
+};
+
+class HashMaps                  // Maps in unordered containers
+{
+ public:
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> index;
+
+    friend inline auto json_fields(HashMaps& a)
+        {
+            return std::make_tuple("index", &a.index);
+        }
+};
+
+class FlatMaps
+{
+ public:
+    json::flat_map<json::flat_map<int>> index;
+
+    friend inline auto json_fields(FlatMaps& a)
+        {
+            return std::make_tuple("index", &a.index);
+        }
+};
+
+template <typename Bytes> class Attachment // bytes as base64 (json::blob) or as arrays of numbers
+{
+ public:
+    inline Attachment() : id(0) {}
+
+    int id;
+    Bytes thumbnail;
+
+    friend inline auto json_fields(Attachment& a)
+        {
+            return std::make_tuple("id", &a.id, "thumbnail", &a.thumbnail);
+        }
+};
+
+class Sample
+{
+ public:
+    inline Sample() : id(0), x(0), y(0), time(0) {}
+
+    int id;
+    double x, y;
+    long time;
+
+    friend inline auto json_fields(Sample& a)
+        {
+            return std::make_tuple("id", &a.id, "x", &a.x, "y", &a.y, "time", &a.time);
+        }
+};
+
+class Columns                   // samples written as a map of arrays
+{
+ public:
+    std::vector<Sample> samples;
+
+    friend inline auto json_fields(Columns& a)
+        {
+            return std::make_tuple("samples", json::field(&a.samples, json::columnar));
+        }
+};
+
+class Sparse
+{
+ public:
+    inline Sparse() : id(0) {}
+
+    int id;
+    std::string note;
+
+    friend inline auto json_fields(Sparse& a, bool for_output)
+        {
+            if (for_output && a.id % 3 == 0)
+                throw json::no_value();
+            return std::make_tuple("id", &a.id, "note", json::field(&a.note, json::output_if_not_empty));
+        }
+};
+
+class Partial
+{
+ public:
+    std::vector<Sparse> items;
+
+    friend inline auto json_fields(Partial& a)
+        {
+            return std::make_tuple("items", &a.items);
+        }
+};
+
+// ----------------------------------------------------------------------
+
+static inline Numbers make_numbers()
+{
+    Numbers numbers;
+    for (int i = 0; i < 500000; ++i) {
+        numbers.reals.push_back(i * 1.0001 - 3e5);
+        numbers.integers.push_back(static_cast<int>(i * 7919L % 2000003) - 1000000);
+    }
+    return numbers;
+}
+
+static inline NumberLists make_number_lists()
+{
+    const auto numbers = make_numbers();
+    NumberLists lists;
+    lists.reals.assign(numbers.reals.begin(), numbers.reals.end());
+    lists.integers.assign(numbers.integers.begin(), numbers.integers.end());
+    return lists;
+}
+
+static inline Strings make_strings()
+{
+    Strings strings;
+    for (size_t i = 0; i < 5000; ++i) {
+        std::string line;
+        while (line.size() < 2000)
+            line += "line " + std::to_string(i) + " of the long strings corpus; ";
+        strings.lines.push_back(line);
+    }
+    return strings;
+}
+
+static inline std::vector<Visit> make_visits()
+{
+    const char* const countries[] = {"DE", "FR", "NL", "US", "JP"};
+    std::vector<Visit> visits(300000);
+    int no = 0;
+    for (auto& visit: visits) {
+        visit.id = no++;
+        visit.country = countries[no % 5];
+        visit.host = "frontend-" + std::to_string(no % 37) + ".eu-central.example.com";
+        visit.tags = {"tag-" + std::to_string(no % 3), "long tag shared by every visit"};
+    }
+    return visits;
+}
+
+template <typename T> static inline std::vector<T> make_levels()
+{
+    std::vector<T> result(200000);
+    size_t no = 0;
+    for (auto& levels: result) {
+        for (size_t i = 0; i < levels.l.size(); ++i)
+            levels.l[i] = static_cast<Level>((no + i) % 5);
+        ++no;
+    }
+    return result;
+}
+
+static inline void grow(Node& node, int depth, int& id)
+{
+    node.id = id++;
+    node.name = "node-" + std::to_string(node.id);
+    if (depth > 0) {
+        node.children.resize(2);
+        for (auto& child: node.children)
+            grow(child, depth - 1, id);
+    }
+}
+
+static inline std::vector<Node> make_deep()
+{
+    std::vector<Node> trees(4);
+    int id = 0;
+    for (auto& tree: trees)
+        grow(tree, 14, id);
+    Node chain;         // single very deep branch
+    Node* tip = &chain;
+    for (int level = 0; level < 200; ++level) {
+        tip->id = level;
+        tip->children.resize(1);
+        tip = &tip->children.front();
+    }
+    trees.push_back(chain);
+    return trees;
+}
+
+static inline std::vector<Wide> make_wide()
+{
+    std::vector<Wide> result(20000);
+    int n = 0;
+    for (auto& wide: result) {
+        wide.i1 = wide.i5 = n++; wide.i2 = wide.i6 = -n; wide.i3 = wide.i7 = n * 3; wide.i4 = wide.i8 = n / 3;
+        wide.d1 = wide.d5 = n * 0.5; wide.d2 = wide.d6 = n / 7.0; wide.d3 = wide.d7 = -n * 1e-3; wide.d4 = wide.d8 = n * 1e6;
+        wide.b1 = wide.b3 = n % 2 == 0; wide.b2 = wide.b4 = n % 3 == 0;
+        wide.s1 = wide.s3 = "wide-" + std::to_string(n); wide.s2 = wide.s4 = "struct";
+        wide.v1 = {n, n + 1, n + 2};
+        wide.v2 = {};
+    }
+    return result;
+}
+
+static inline std::vector<json::cached<Wide>> make_cached_wide()
+{
+    std::vector<json::cached<Wide>> result;
+    for (const auto& wide: make_wide())
+        result.emplace_back(wide);
+    return result;
+}
+
+static inline Maps make_maps()
+{
+    Maps maps;
+    for (int outer = 0; outer < 1000; ++outer) {
+        auto& inner = maps.index["key-" + std::to_string(outer * 7919 % 100003)];
+        for (int i = 0; i < 100; ++i)
+            inner["entry-" + std::to_string(i)] = outer * i;
+    }
+    return maps;
+}
+
+static inline std::pair<Maps, Maps> make_changed_maps() // every 10th entry changed, every 50th removed
+{
+    std::pair<Maps, Maps> result(make_maps(), make_maps());
+    int no = 0;
+    for (auto& outer: result.second.index) {
+        for (auto it = outer.second.begin(); it != outer.second.end(); ++no) {
+            if (no % 50 == 0)
+                it = outer.second.erase(it);
+            else
+                (it++)->second += no % 10 == 0 ? 1 : 0;
+        }
+    }
+    return result;
+}
+
+template <typename T> static inline T make_maps_in()
+{
+    T result;
+    json::parse(json::dump(make_maps()), result);
+    return result;
+}
+
+template <typename Bytes> static inline std::vector<Attachment<Bytes>> make_attachments()
+{
+    std::vector<Attachment<Bytes>> result(2000);
+    unsigned seed = 1;
+    for (auto& attachment: result) {
+        std::vector<unsigned char> bytes(16384);
+        for (auto& byte: bytes) {
+            seed = seed * 1103515245 + 12345;
+            byte = static_cast<unsigned char>(seed >> 16);
+        }
+        attachment.id = static_cast<int>(seed % 1000);
+        attachment.thumbnail = bytes;
+    }
+    return result;
+}
+
+static inline std::vector<Sample> make_samples()
+{
+    std::vector<Sample> samples(300000);
+    int no = 0;
+    for (auto& sample: samples) {
+        sample.id = no;
+        sample.x = (no % 1000) / 8.0;
+        sample.y = -(no % 77);
+        sample.time = 1500000000L + no++;
+    }
+    return samples;
+}
+
+static inline Columns make_columns()
+{
+    Columns columns;
+    columns.samples = make_samples();
+    return columns;
+}
+
+static inline Partial make_partial()
+{
+    Partial partial;
+    partial.items.resize(300000);
+    int id = 0;
+    for (auto& item: partial.items) {
+        item.id = ++id;
+        if (id % 5 == 0)
+            item.note = "note " + std::to_string(id);
+    }
+    return partial;
+}
+
+// ----------------------------------------------------------------------
+// measuring
+// ----------------------------------------------------------------------
+
+class Percentiles
+{
+ public:
+    inline Percentiles() : min(0), p10(0), p50(0), p90(0), max(0) {}
+
+    double min, p10, p50, p90, max;
+
+    friend inline auto json_fields(Percentiles& a)
+        {
+            return std::make_tuple("min", &a.min, "p10", &a.p10, "p50", &a.p50, "p90", &a.p90, "max", &a.max);
+        }
+};
+
+class Throughput
+{
+ public:
+    Percentiles seconds;
+    Percentiles mb_per_second;
+    Percentiles documents_per_second;
+
+    friend inline auto json_fields(Throughput& a)
+        {
+            return std::make_tuple("seconds", &a.seconds, "MB/s", &a.mb_per_second, "docs/s", &a.documents_per_second);
+        }
+};
+
+class Result
+{
+ public:
+    inline Result() : bytes(0), runs(0) {}
+
+    std::string corpus;
+    size_t bytes;
+    size_t runs;
+    Throughput dump;
+    Throughput parse;
+
+    friend inline auto json_fields(Result& a)
+        {
+            return std::make_tuple("corpus", &a.corpus, "bytes", &a.bytes, "runs", &a.runs, "dump", &a.dump, "parse", &a.parse);
+        }
+};
+
+class Report
+{
+ public:
+    std::string compiler;
+    std::vector<Result> results;
+
+    friend inline auto json_fields(Report& a)
+        {
+            return std::make_tuple("compiler", &a.compiler, "results", &a.results);
+        }
+};
+
+static inline Percentiles percentiles(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    auto at = [&values](double fraction) { return values[static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5)]; };
+    Percentiles result;
+    result.min = at(0);
+    result.p10 = at(0.1);
+    result.p50 = at(0.5);
+    result.p90 = at(0.9);
+    result.max = at(1);
+    return result;
+}
+
+static inline Throughput throughput(const std::vector<double>& seconds, size_t bytes)
+{
+    std::vector<double> mb_per_second, documents_per_second;
+    for (auto s: seconds) {
+        mb_per_second.push_back(static_cast<double>(bytes) / 1e6 / s);
+        documents_per_second.push_back(1.0 / s);
+    }
+    Throughput result;
+    result.seconds = percentiles(seconds);
+    result.mb_per_second = percentiles(mb_per_second);
+    result.documents_per_second = percentiles(documents_per_second);
+    return result;
+}
+
+template <typename F> static inline double seconds(F f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// dump(data) returns the text, parse(text, target) reads it, target is constructed outside of the measured time
+template <typename Target, typename Make, typename Dump, typename Parse> static inline void measure(Report& report, const char* corpus, Make make, Dump dump, Parse parse, size_t runs, const char* only)
+{
+    if (only && std::strcmp(only, corpus) != 0)
+        return;
+    std::cerr << corpus << std::endl;
+    const auto data = make();
+    const std::string text = dump(data);
+    std::vector<double> dump_seconds, parse_seconds;
+    for (size_t run = 0; run < runs; ++run) {
+        size_t size = 0;
+        dump_seconds.push_back(seconds([&]() { size = dump(data).size(); }));
+        if (size != text.size())
+            throw std::runtime_error(std::string("unstable dump of ") + corpus);
+        Target target;
+        parse_seconds.push_back(seconds([&]() { parse(text, target); }));
+    }
+    Result result;
+    result.corpus = corpus;
+    result.bytes = text.size();
+    result.runs = runs;
+    result.dump = throughput(dump_seconds, text.size());
+    result.parse = throughput(parse_seconds, text.size());
+    report.results.push_back(result);
+}
+
+template <typename Make> static inline void measure(Report& report, const char* corpus, Make make, size_t runs, const char* only)
+{
+    typedef decltype(make()) T;
+    measure<T>(report, corpus, make, [](const T& data) { return json::dump(data); }, [](const std::string& text, T& target) { json::parse(text, target); }, runs, only);
+}
+
+// ----------------------------------------------------------------------
+
+int main(int argc, const char* const* argv)
+{
+    const size_t runs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 9;
+    const char* only = argc > 2 ? argv[2] : nullptr;
+    if (runs == 0) {
+        std::cerr << "usage: " << argv[0] << " [runs [corpus-name]]" << std::endl;
+        return 1;
+    }
+
+    const auto dump = [](const auto& data) { return json::dump(data); };
+
+    Report report;
+#ifdef __VERSION__
+    report.compiler = __VERSION__;
+#endif
+    measure(report, "numeric-arrays", &make_numbers, runs, only);
+    measure(report, "long-strings", &make_strings, runs, only);
+    measure(report, "deep-nesting", &make_deep, runs, only);
+    measure(report, "wide-structs", &make_wide, runs, only);
+    measure(report, "maps", &make_maps, runs, only);
+    measure<std::vector<WideHead>>(report, "projection", &make_wide, dump, [](const std::string& text, std::vector<WideHead>& target) { json::parse(text, target, json::projection); }, runs, only);
+    measure<std::vector<WideHead>>(report, "ignore-unknown", &make_wide, dump, [](const std::string& text, std::vector<WideHead>& target) { json::parse(text, target, json::ignore_unknown); }, runs, only);
+    measure<std::vector<Wide>>(report, "exact-size", &make_wide, [](const std::vector<Wide>& data) { return json::dump(data, 0, json::exact_size); }, [](const std::string& text, std::vector<Wide>& target) { json::parse(text, target); }, runs, only);
+    measure<std::vector<Wide>>(report, "cbor", &make_wide, [](const std::vector<Wide>& data) { return json::dump_cbor(data); }, [](const std::string& data, std::vector<Wide>& target) { json::parse_cbor(data, target); }, runs, only);
+    measure<std::vector<Wide>>(report, "msgpack", &make_wide, [](const std::vector<Wide>& data) { return json::dump_msgpack(data); }, [](const std::string& data, std::vector<Wide>& target) { json::parse_msgpack(data, target); }, runs, only);
+    measure<std::vector<Wide>>(report, "snapshot", &make_wide, [](const std::vector<Wide>& data) { return json::dump_snapshot(data); }, [](const std::string& data, std::vector<Wide>& target) { json::parse_snapshot(data, target); }, runs, only);
+    measure<Maps>(report, "merge-patch", &make_changed_maps, [](const std::pair<Maps, Maps>& data) { return json::dump_diff(data.first, data.second); }, [](const std::string& text, Maps& target) { json::apply_patch(target, text); }, runs, only);
+    measure(report, "cached", &make_cached_wide, runs, only);
+    measure<std::vector<Wide>>(report, "push-parser", &make_wide, dump, [](const std::string& text, std::vector<Wide>& target) {
+        json::push_parser<std::vector<Wide>> parser(target);
+        for (size_t pos = 0; pos < text.size(); pos += 1500)
+            parser.feed(text.data() + pos, std::min(size_t(1500), text.size() - pos));
+        parser.finish();
+    }, runs, only);
+    measure<size_t>(report, "for-each-element", &make_wide, dump, [](const std::string& text, size_t& count) { json::for_each_element<Wide>(text, [&count](const Wide&) { ++count; }); }, runs, only);
+    measure<size_t>(report, "for-each-element-stream", &make_wide, dump, [](const std::string& text, size_t& count) {
+        std::istringstream input(text);
+        json::for_each_element<Wide>(input, [&count](const Wide&) { ++count; });
+    }, runs, only);
+    measure<HashMaps>(report, "unordered-maps", &make_maps_in<HashMaps>, [](const HashMaps& data) { return json::dump(data, 0, json::sorted_keys); }, [](const std::string& text, HashMaps& target) { json::parse(text, target); }, runs, only);
+    measure(report, "flat-maps", &make_maps_in<FlatMaps>, runs, only);
+    measure(report, "numeric-lists", &make_number_lists, runs, only);
+    measure(report, "repeated-strings", &make_visits, runs, only);
+    measure<InternedVisits>(report, "interned-strings", &make_visits, dump, [](const std::string& text, InternedVisits& target) { json::parse(text, target.visits, json::interning(target.pool)); }, runs, only);
+    measure<std::vector<RawVisit>>(report, "raw-strings", &make_visits, dump, [](const std::string& text, std::vector<RawVisit>& target) { json::parse(text, target); }, runs, only);
+    measure(report, "enums", &make_levels<Levels>, runs, only);
+    measure(report, "enum-strings", &make_levels<LevelNames>, runs, only);
+    measure<int>(report, "validate", &make_wide, dump, [](const std::string& text, int&) { json::validate<std::vector<Wide>>(text); }, runs, only);
+    measure<int>(report, "validate-syntax", &make_wide, dump, [](const std::string& text, int&) { json::validate(text); }, runs, only);
+    measure<std::string>(report, "extract", &make_wide, dump, [](const std::string& text, std::string& target) { target = json::extract<std::string>(text, "/19999/string_1"); }, runs, only);
+    measure(report, "blobs", &make_attachments<json::blob>, runs, only);
+    measure(report, "byte-arrays", &make_attachments<std::vector<unsigned char>>, runs, only);
+    measure(report, "rows", &make_samples, runs, only);
+    measure(report, "columns", &make_columns, runs, only);
+    measure<Numbers>(report, "float-precision", &make_numbers, [](const Numbers& data) { return json::dump(data, 0, json::precision(6)); }, [](const std::string& text, Numbers& target) { json::parse(text, target); }, runs, only);
+    measure<Numbers>(report, "float-fixed", &make_numbers, [](const Numbers& data) { return json::dump(data, 0, json::fixed(2)); }, [](const std::string& text, Numbers& target) { json::parse(text, target); }, runs, only);
+    measure(report, "partial-output", &make_partial, runs, only);
+    std::cout << json::dump(report, 1) << std::endl;
+    return 0;
+}
+
+// ----------------------------------------------------------------------
@@ -7,20 +7,70 @@
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <algorithm>
 #include <string>
 #include <vector>
+#include <array>
 #include <list>
 #include <set>
 #include <map>
 #include <functional>
+#include <memory>
+#include <bitset>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cerrno>
 #include <cmath>
+#include <typeindex>
+#include <unordered_map>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <deque>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "axe.h"
 
+// ----------------------------------------------------------------------
+// instrumentation: -DJSON_STRUCT_INSTRUMENT makes parse and dump report to
+// json::instrument::observer, without it hooks are compiled away;
+// -DJSON_STRUCT_USDT adds probes at document start and end (requires sys/sdt.h)
+
+#ifdef JSON_STRUCT_INSTRUMENT
+#define JSON_STRUCT_HOOK(event) do { if (auto* json_struct_observer = ::json::instrument::current()) json_struct_observer->event; } while (false)
+#define JSON_STRUCT_TRACK_GROWTH(kind, type, container, statement) do { const auto json_struct_capacity = ::json::u::capacity(container); statement; if (::json::u::capacity(container) != json_struct_capacity) JSON_STRUCT_HOOK(reallocation(kind, type)); } while (false)
+#else
+#define JSON_STRUCT_HOOK(event) do {} while (false)
+#define JSON_STRUCT_TRACK_GROWTH(kind, type, container, statement) do { statement; } while (false)
+#endif
+
+#ifdef JSON_STRUCT_USDT
+#include <sys/sdt.h>
+#define JSON_STRUCT_PROBE(name, kind, bytes) STAP_PROBE2(json_struct, name, static_cast<int>(kind), static_cast<size_t>(bytes))
+#else
+#define JSON_STRUCT_PROBE(name, kind, bytes) do {} while (false)
+#endif
+
 #ifdef __clang__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wglobal-constructors"
 #pragma GCC diagnostic ignored "-Wweak-vtables"
+#pragma GCC diagnostic ignored "-Wexit-time-destructors"
 #endif
 
 // ----------------------------------------------------------------------
@@ -44,21 +94,188 @@ namespace json
     enum output_only_if_not_empty_t { output_only_if_not_empty };
     enum output_if_true_t { output_if_true };
     enum output_if_not_empty_t { output_if_not_empty };
+    enum columnar_t { columnar }; // std::vector of objects written as an object of arrays, see json::columns
+
+    enum ignore_unknown_t { ignore_unknown };
+    enum projection_t { projection };
+
+    enum exact_size_t { exact_size };
+    enum sorted_keys_t { sorted_keys }; // keys of unordered maps are written sorted
+
+      // output of floating point numbers: the shortest text reading back the same value (default),
+      // json::precision(n) significant digits or json::fixed(n) digits after the point,
+      // for a field (json::field(&f, json::precision(4))) or the whole output (json::dump(a, 0, json::fixed(2)))
+    class float_format
+    {
+     public:
+        enum style_t { shortest, significant, fixed };
+
+        inline float_format() : mStyle(shortest), mDigits(0) {}
+        inline float_format(style_t aStyle, int aDigits) : mStyle(aStyle), mDigits(std::min(std::max(aDigits, aStyle == significant ? 1 : 0), 15)) {}
+
+        inline style_t style() const { return mStyle; }
+        inline int digits() const { return mDigits; }
+
+     private:
+        style_t mStyle;
+        int mDigits;            // 0..15 (at least 1 significant), digits a double always holds
+    };
+
+      // more than 15 significant digits is the default shortest round-trip output
+    inline float_format precision(int significant_digits) { return significant_digits > 15 ? float_format() : float_format(float_format::significant, significant_digits); }
+    inline float_format fixed(int decimals) { return float_format(float_format::fixed, decimals); }
+
+    template <typename T> class flat_set;
+    template <typename T> class flat_map;
+    template <typename T> class columns;
+    template <typename T> class cached;
+    class raw_string;
 
       // ----------------------------------------------------------------------
+      // instrumentation, events are sent if compiled with -DJSON_STRUCT_INSTRUMENT
+      // ----------------------------------------------------------------------
 
-    namespace u
+    namespace instrument
     {
-        template <std::size_t Skip, std::size_t... Ns, typename... Ts> inline auto tuple_tail(std::index_sequence<Ns...>, std::tuple<Ts...>& t)
+        enum kind { parsing, writing };
+
+          // receives events of json::parse and json::dump calls made by the current thread
+        class observer
+        {
+         public:
+            virtual inline ~observer() = default;
+              // json::parse or json::dump of the value of the type, bytes consumed or produced
+            virtual inline void document_begin(kind, const std::type_info&) {}
+            virtual inline void document_end(kind, const std::type_info&, size_t /*bytes*/) {}
+              // object having json_fields(), bytes include nested values
+            virtual inline void object_begin(kind, const std::type_info&) {}
+            virtual inline void object_end(kind, const std::type_info&, size_t /*bytes*/) {}
+              // array element or map entry
+            virtual inline void element(kind) {}
+              // value of the type is not written, json_fields() or field predicate threw no_value
+            virtual inline void skipped(const std::type_info&) {}
+              // capacity of a container (or output buffer) of the type grew
+            virtual inline void reallocation(kind, const std::type_info&) {}
+        };
+
+        inline observer*& current_slot()
         {
-            return std::make_tuple(std::get<Ns+Skip>(t)...);
+            static thread_local observer* current = nullptr;
+            return current;
         }
 
-        template <std::size_t Skip, typename... Ts> inline auto tuple_tail(std::tuple<Ts...>& t)
+        inline observer* current() { return current_slot(); }
+
+          // makes observer current for the thread during its life time
+        class scoped_observer
+        {
+         public:
+            inline scoped_observer(observer& aObserver) : previous(current_slot()) { current_slot() = &aObserver; }
+            inline ~scoped_observer() { current_slot() = previous; }
+            scoped_observer(const scoped_observer&) = delete;
+            scoped_observer& operator=(const scoped_observer&) = delete;
+
+         private:
+            observer* previous;
+        };
+
+        inline std::string type_name(const std::type_info& type)
         {
-            return tuple_tail<Skip>(std::make_index_sequence<sizeof...(Ts) - Skip>(), t);
+#ifdef __GNUG__
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+            if (demangled) {
+                std::string result(demangled);
+                std::free(demangled);
+                return result;
+            }
+#endif
+            return type.name();
         }
 
+          // Aggregated events per type, elements are counted for the innermost object (or document) being
+          // read or written. Written by json::dump (observer must not be current at that time).
+        class profile : public observer
+        {
+         public:
+            class entry
+            {
+             public:
+                inline entry() : documents(0), seconds(0), objects(0), bytes(0), elements(0), skipped(0), reallocations(0) {}
+
+                size_t documents;
+                double seconds;
+                size_t objects;
+                size_t bytes;           // of objects
+                size_t elements;
+                size_t skipped;
+                size_t reallocations;
+
+                friend inline auto json_fields(entry& a)
+                    {
+                        return std::make_tuple("documents", &a.documents, "seconds", &a.seconds, "objects", &a.objects, "bytes", &a.bytes,
+                                               "elements", &a.elements, "no_value", &a.skipped, "reallocations", &a.reallocations);
+                    }
+            };
+
+            std::map<std::string, entry> parse; // by type name
+            std::map<std::string, entry> dump;
+
+            friend inline auto json_fields(profile& a)
+                {
+                    return std::make_tuple("parse", &a.parse, "dump", &a.dump);
+                }
+
+            virtual inline void document_begin(kind, const std::type_info& type)
+                {
+                    documents.push_back({std::chrono::steady_clock::now(), scope.size()});
+                    scope.push_back(&type);
+                }
+
+            virtual inline void document_end(kind aKind, const std::type_info& type, size_t)
+                {
+                    auto& target = at(aKind, type);
+                    ++target.documents;
+                    target.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - documents.back().start).count();
+                    scope.resize(documents.back().scope); // objects are not ended if parsing failed
+                    documents.pop_back();
+                }
+
+            virtual inline void object_begin(kind, const std::type_info& type) { scope.push_back(&type); }
+
+            virtual inline void object_end(kind aKind, const std::type_info& type, size_t bytes)
+                {
+                    auto& target = at(aKind, type);
+                    ++target.objects;
+                    target.bytes += bytes;
+                    scope.pop_back();
+                }
+
+            virtual inline void element(kind aKind) { if (!scope.empty()) ++at(aKind, *scope.back()).elements; }
+            virtual inline void skipped(const std::type_info& type) { ++at(writing, type).skipped; }
+            virtual inline void reallocation(kind aKind, const std::type_info& type) { ++at(aKind, type).reallocations; }
+
+         private:
+            struct document { std::chrono::steady_clock::time_point start; size_t scope; };
+
+            std::vector<document> documents;
+            std::vector<const std::type_info*> scope;
+            std::unordered_map<std::type_index, entry*> index[2];
+
+            inline entry& at(kind aKind, const std::type_info& type)
+                {
+                    auto& found = index[aKind][std::type_index(type)];
+                    if (!found)
+                        found = &(aKind == parsing ? parse : dump)[type_name(type)];
+                    return *found;
+                }
+        };
+    }
+
+      // ----------------------------------------------------------------------
+
+    namespace u
+    {
           // void_t is a C++17 feature
         template<class ...> using void_t = void; // http://stackoverflow.com/questions/26513095/void-t-can-implement-concepts
 
@@ -95,6 +312,165 @@ namespace json
 
         template <typename T, typename = void> struct is_emplace_back_defined : public std::false_type {};
         template <typename T> struct is_emplace_back_defined<T, void_t<decltype(std::declval<T>().emplace_back())>> : public std::true_type {};
+
+          // kinds of values written as json array, object with arbitrary keys, object with json_fields()
+        template <typename T> struct is_array : public std::false_type {};
+        template <typename T> struct is_array<std::vector<T>> : public std::true_type {};
+        template <typename T> struct is_array<std::list<T>> : public std::true_type {};
+        template <typename T> struct is_array<std::set<T>> : public std::true_type {};
+        template <typename T> struct is_array<flat_set<T>> : public std::true_type {};
+        template <typename T, size_t N> struct is_array<std::array<T, N>> : public std::true_type {};
+
+        template <typename T> struct is_map : public std::false_type {};
+        template <typename T> struct is_map<std::map<std::string, T>> : public std::true_type {};
+        template <typename T> struct is_map<std::unordered_map<std::string, T>> : public std::true_type {};
+        template <typename T> struct is_map<flat_map<T>> : public std::true_type {};
+
+          // iterated in the key order
+        template <typename T> struct is_sorted_map : public is_map<T> {};
+        template <typename T> struct is_sorted_map<std::unordered_map<std::string, T>> : public std::false_type {};
+
+          // arrays of them are parsed and written by the dedicated loops
+        template <typename T> struct is_number : public std::integral_constant<bool, std::is_arithmetic<T>{} && !std::is_same<T, bool>{}> {};
+
+        template <typename T> struct is_object : public std::integral_constant<bool, is_json_fields_defined<T>{} || is_json_fields_bool_defined<T>{}> {};
+
+        template <typename T> struct is_columns : public std::false_type {};
+        template <typename T> struct is_columns<columns<T>> : public std::true_type {};
+
+        constexpr bool any_of(std::initializer_list<bool> values)
+        {
+            for (bool value: values)
+                if (value)
+                    return true;
+            return false;
+        }
+
+          // if T holds raw_string values (in fields, items, map values), Visited are the objects
+          // already looked into, i.e. recursive types are looked into once
+        template <typename T, typename Visited = std::tuple<>, typename = void> struct has_raw_string : public std::false_type {};
+        template <typename Visited> struct has_raw_string<raw_string, Visited> : public std::true_type {};
+        template <typename T, typename Visited> struct has_raw_string<T, Visited, typename std::enable_if<is_array<T>{}>::type> : public has_raw_string<typename T::value_type, Visited> {};
+        template <typename T, typename Visited> struct has_raw_string<T, Visited, typename std::enable_if<is_map<T>{}>::type> : public has_raw_string<typename T::mapped_type, Visited> {};
+        template <typename T, typename Visited> struct has_raw_string<columns<T>, Visited> : public has_raw_string<std::vector<T>, Visited> {};
+        template <typename T, typename Visited> struct has_raw_string<cached<T>, Visited> : public has_raw_string<T, Visited> {};
+
+        template <typename F> struct field_value { typedef typename F::value_type type; }; // field_t
+        template <typename F> struct field_value<F*> { typedef typename std::remove_const<F>::type type; };
+
+        template <typename Fields, typename Visited, typename Ns> struct fields_have_raw_string;
+        template <typename Fields, typename Visited, size_t... Ns> struct fields_have_raw_string<Fields, Visited, std::index_sequence<Ns...>>
+            : public std::integral_constant<bool, any_of({false, has_raw_string<typename field_value<typename std::tuple_element<2 * Ns + 1, Fields>::type>::type, Visited>::value...})> {};
+
+        template <typename T, typename Visited, bool visited> struct object_has_raw_string : public std::false_type {};
+        template <typename T, typename... Vs> struct object_has_raw_string<T, std::tuple<Vs...>, false>
+        {
+            typedef decltype(call_json_fields(std::declval<T&>(), false)) fields_type;
+            static constexpr bool value = fields_have_raw_string<fields_type, std::tuple<T, Vs...>, std::make_index_sequence<std::tuple_size<fields_type>::value / 2>>::value;
+        };
+
+        template <typename T, typename... Vs> struct has_raw_string<T, std::tuple<Vs...>, typename std::enable_if<is_object<T>{}>::type>
+            : public std::integral_constant<bool, object_has_raw_string<T, std::tuple<Vs...>, any_of({false, std::is_same<T, Vs>{}...})>::value> {};
+
+        template <typename T> struct is_tuple : public std::false_type {};
+        template <typename... Ts> struct is_tuple<std::tuple<Ts...>> : public std::true_type {};
+
+          // enum with json_enum_names() defined, written as string
+        template <typename T, typename = void> struct is_named_enum : public std::false_type {};
+        template <typename T> struct is_named_enum<T, void_t<decltype(json_enum_names(std::declval<T>()))>> : public std::is_enum<T> {};
+
+        template <typename T, typename = void> struct is_reserve_defined : public std::false_type {};
+        template <typename T> struct is_reserve_defined<T, void_t<decltype(std::declval<T>().reserve(size_t()))>> : public std::true_type {};
+
+        template <typename T, typename std::enable_if<is_reserve_defined<T>{}>::type* = nullptr> inline void reserve(T& container, size_t size) { container.reserve(size); }
+        template <typename T, typename std::enable_if<!is_reserve_defined<T>{}>::type* = nullptr> inline void reserve(T&, size_t) {}
+
+        template <typename T, typename = void> struct is_capacity_defined : public std::false_type {};
+        template <typename T> struct is_capacity_defined<T, void_t<decltype(std::declval<const T&>().capacity())>> : public std::true_type {};
+
+        template <typename T, typename std::enable_if<is_capacity_defined<T>{}>::type* = nullptr> inline size_t capacity(const T& container) { return container.capacity(); }
+        template <typename T, typename std::enable_if<!is_capacity_defined<T>{}>::type* = nullptr> inline size_t capacity(const T&) { return 0; }
+
+          // ----------------------------------------------------------------------
+          // json_fields() tuple traversal
+
+        template <typename Fields, typename F, size_t... Ns> inline void for_each_field(Fields& fields, F& f, std::index_sequence<Ns...>)
+        {
+            using expand = int[];
+            (void)expand{0, (static_cast<void>(f(std::integral_constant<size_t, Ns>(), std::get<2 * Ns>(fields), std::get<2 * Ns + 1>(fields))), 0)...};
+        }
+
+          // calls f(index, key, value) for every key/value pair of the json_fields() tuple, index is the number of the pair
+          // (std::integral_constant, i.e. usable as template argument, e.g. to get the same field of another object)
+        template <typename Fields, typename F> inline void for_each_field(Fields& fields, F&& f)
+        {
+            for_each_field(fields, f, std::make_index_sequence<std::tuple_size<Fields>::value / 2>());
+        }
+
+        template <size_t N, typename Fields, typename F> inline bool find_field_at(Fields& fields, const char* key, size_t key_size, F& f)
+        {
+            const char* field_key = std::get<2 * N>(fields);
+            if (std::strncmp(field_key, key, key_size) == 0 && field_key[key_size] == 0) {
+                f(std::integral_constant<size_t, N>(), std::get<2 * N + 1>(fields));
+                return true;
+            }
+            return false;
+        }
+
+          // keys are compared starting from the pair number hint (usually the field after the previous one) and then from the beginning
+        template <typename Fields, typename F, size_t... Ns> inline bool find_field(Fields& fields, const char* key, size_t key_size, F& f, size_t hint, std::index_sequence<Ns...>)
+        {
+            static_cast<void>(key), static_cast<void>(key_size); // unused for objects without fields
+            bool found = false;
+            using expand = bool[];
+            (void)expand{false, (found = found || (Ns >= hint && find_field_at<Ns>(fields, key, key_size, f)))...};
+            (void)expand{false, (found = found || (Ns < hint && find_field_at<Ns>(fields, key, key_size, f)))...};
+            return found;
+        }
+
+          // calls f(index, value) for the value with the key [key, key + key_size) in the json_fields() tuple (index as in for_each_field),
+          // returns false if there is no such key
+        template <typename Fields, typename F> inline bool find_field(Fields& fields, const char* key, size_t key_size, F&& f, size_t hint = 0)
+        {
+            return find_field(fields, key, key_size, f, hint, std::make_index_sequence<std::tuple_size<Fields>::value / 2>());
+        }
+
+        template <typename Fields, typename F, size_t... Ns> inline void for_each_field_pair(Fields& fields1, Fields& fields2, F& f, std::index_sequence<Ns...>)
+        {
+            using expand = int[];
+            (void)expand{0, (static_cast<void>(f(Ns, std::get<2 * Ns>(fields2), std::get<2 * Ns + 1>(fields1), std::get<2 * Ns + 1>(fields2))), 0)...};
+        }
+
+          // calls f(index, key, value1, value2) for every pair of the json_fields() tuples of two objects of the same type
+        template <typename Fields, typename F> inline void for_each_field_pair(Fields& fields1, Fields& fields2, F&& f)
+        {
+            for_each_field_pair(fields1, fields2, f, std::make_index_sequence<std::tuple_size<Fields>::value / 2>());
+        }
+
+          // ----------------------------------------------------------------------
+
+          // first position in [first, last) holding one of Cs, last if there is none
+          // scans 16 bytes per step when SSE2 is available
+        template <char... Cs> inline const char* find_first_of(const char* first, const char* last)
+        {
+            using expand = int[];
+#ifdef __SSE2__
+            for (; last - first >= 16; first += 16) {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                int mask = 0;
+                (void)expand{0, (mask |= _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(Cs))), 0)...};
+                if (mask)
+                    return first + __builtin_ctz(static_cast<unsigned>(mask));
+            }
+#endif
+            for (; first != last; ++first) {
+                bool found = false;
+                (void)expand{0, (found |= *first == Cs, 0)...};
+                if (found)
+                    return first;
+            }
+            return last;
+        }
     }
 
       // ----------------------------------------------------------------------
@@ -102,10 +478,12 @@ namespace json
     template <typename G, typename S, typename P> class field_t
     {
      public:
-        typedef typename G::result_type value_type;
+        typedef typename G::result_type result_type; // const reference if getter returns it, the value is then written in place
+        typedef typename std::decay<result_type>::type value_type;
         inline field_t(G&& aG, S&& aS, P&& aPredicate) : mG(aG), mS(aS), mPredicate(aPredicate) {}
 
-        inline value_type get() const { if (!mPredicate()) throw no_value(); return mG(); }
+        inline result_type get() const { if (!mPredicate()) throw no_value(); return mG(); }
+        inline const G& getter() const { return mG; }
         inline S& setter() { return mS; }
 
      private:
@@ -141,18 +519,29 @@ namespace json
     template <typename T> class _default_getter
     {
      public:
-        typedef T result_type;
+        typedef const T& result_type;
         inline _default_getter(const T* aField) : mField(aField) {}
         inline const T& operator()() const { return *mField; }
      private:
         const T* mField;
     };
 
+      // default getter of json::field(&f, json::precision(4)), floating point numbers in the value are written with the format
+    template <typename T> class _float_format_getter : public _default_getter<T>
+    {
+     public:
+        inline _float_format_getter(const T* aField, const float_format& aFormat) : _default_getter<T>(aField), mFormat(aFormat) {}
+        inline const float_format& format() const { return mFormat; }
+     private:
+        float_format mFormat;
+    };
+
     template <typename T> class _default_setter
     {
      public:
         inline _default_setter(T* aField) : mField(aField) {}
         inline void operator()(const T& val) const { *mField = val; }
+        inline void operator()(T&& val) const { *mField = std::move(val); }
      private:
         T* mField;
     };
@@ -164,6 +553,55 @@ namespace json
         inline void operator()(const Arg&) const {}
     };
 
+      // provided getter or setter bound to the object: member function or function taking the object pointer,
+      // just two pointers are stored (unlike std::bind)
+    template <typename F, typename T> inline auto _call_bound(F f, T* obj) -> decltype((obj->*f)()) { return (obj->*f)(); }
+    template <typename F, typename T> inline auto _call_bound(F f, T* obj) -> decltype(f(obj)) { return f(obj); }
+    template <typename F, typename T, typename V> inline auto _call_bound(F f, T* obj, V&& val) -> decltype((obj->*f)(std::forward<V>(val))) { return (obj->*f)(std::forward<V>(val)); }
+    template <typename F, typename T, typename V> inline auto _call_bound(F f, T* obj, V&& val) -> decltype(f(obj, std::forward<V>(val))) { return f(obj, std::forward<V>(val)); }
+
+    template <typename T, typename F> class _bound_getter
+    {
+     public:
+        typedef decltype(_call_bound(std::declval<F>(), std::declval<T*>())) result_type;
+        inline _bound_getter(T* aObj, F aF) : mObj(aObj), mF(aF) {}
+        inline result_type operator()() const { return _call_bound(mF, mObj); }
+     private:
+        T* mObj;
+        F mF;
+    };
+
+    template <typename T, typename F> class _bound_setter
+    {
+     public:
+        inline _bound_setter(T* aObj, F aF) : mObj(aObj), mF(aF) {}
+        template <typename V> inline void operator()(V&& val) const { _call_bound(mF, mObj, std::forward<V>(val)); }
+     private:
+        T* mObj;
+        F mF;
+    };
+
+      // string literal of json::comment(), text is written without making std::string
+    class _literal_getter
+    {
+     public:
+        typedef std::string result_type;
+        inline _literal_getter(const char* aText) : mText(aText), mSize(std::strlen(aText)) {} // strlen of a literal is computed by compiler
+        inline std::string operator()() const { return std::string(mText, mSize); }
+        inline const char* text() const { return mText; }
+        inline size_t size() const { return mSize; }
+        inline bool operator==(const _literal_getter& a) const { return mSize == a.mSize && std::memcmp(mText, a.mText, mSize) == 0; }
+     private:
+        const char* mText;
+        size_t mSize;
+    };
+
+    template <typename S, typename P> using _literal_field_t = field_t<_literal_getter, S, P>;
+
+      // if value of the field is read by the parser, i.e. field is not output only
+    template <typename F> struct _is_input_field : public std::true_type {};
+    template <typename G, typename T, typename Arg, typename P> struct _is_input_field<field_t<G, _no_setter<T, Arg>, P>> : public std::false_type {};
+
     template <typename G, typename S, typename P> inline auto _field_t_make(G&& aG, S&& aS, P&& aPredicate)
     {
         return field_t<G, S, P>(std::forward<G>(aG), std::forward<S>(aS), std::forward<P>(aPredicate));
@@ -189,6 +627,13 @@ namespace json
         return _field_t_make(_default_getter<T>(field), _default_setter<T>(field), _predicate_if_not_empty<T>(field));
     }
 
+      // default getter and setter, floating point numbers (of double, std::vector<double>, nested objects) written with format,
+      // parsing is not affected
+    template <typename T> inline auto field(T* field, float_format format)
+    {
+        return _field_t_make(_float_format_getter<T>(field, format), _default_setter<T>(field), &_predicate_always);
+    }
+
       // --------------------
 
       // default getter, no setter - output only
@@ -214,15 +659,15 @@ namespace json
       // provided getter, no setter - output only
     template <typename T, typename GF> inline auto field(T* field, GF aGetter)
     {
-        typedef decltype(std::bind(aGetter, field)()) value_type;
-        return _field_t_make(std::bind(aGetter, field), _no_setter<T, value_type>(field), &_predicate_always);
+        typedef typename std::decay<typename _bound_getter<T, GF>::result_type>::type value_type;
+        return _field_t_make(_bound_getter<T, GF>(field, aGetter), _no_setter<T, value_type>(field), &_predicate_always);
     }
 
       // provided getter, no setter - output only if true
     template <typename T, typename GF> inline auto field(T* field, GF aGetter, output_only_if_true_t)
     {
-        typedef decltype(std::bind(aGetter, field)()) value_type;
-        return _field_t_make(std::bind(aGetter, field), _no_setter<T, value_type>(field), _predicate_if_true<T>(field));
+        typedef typename std::decay<typename _bound_getter<T, GF>::result_type>::type value_type;
+        return _field_t_make(_bound_getter<T, GF>(field, aGetter), _no_setter<T, value_type>(field), _predicate_if_true<T>(field));
     }
 
       // same as above, another option type for convenience
@@ -234,8 +679,8 @@ namespace json
       // provided getter, no setter - output only if not empty
     template <typename T, typename GF> inline auto field(T* field, GF aGetter, output_only_if_not_empty_t)
     {
-        typedef decltype(std::bind(aGetter, field)()) value_type;
-        return _field_t_make(std::bind(aGetter, field), _no_setter<T, value_type>(field), _predicate_if_not_empty<T>(field));
+        typedef typename std::decay<typename _bound_getter<T, GF>::result_type>::type value_type;
+        return _field_t_make(_bound_getter<T, GF>(field, aGetter), _no_setter<T, value_type>(field), _predicate_if_not_empty<T>(field));
     }
 
       // same as above, another option type for convenience
@@ -249,19 +694,70 @@ namespace json
       // provided getter and setter
     template <typename T, typename GF, typename SF> inline auto field(T* field, GF aGetter, SF aSetter)
     {
-        return _field_t_make(std::bind(aGetter, field), std::bind(aSetter, field, std::placeholders::_1), &_predicate_always);
+        return _field_t_make(_bound_getter<T, GF>(field, aGetter), _bound_setter<T, SF>(field, aSetter), &_predicate_always);
     }
 
       // provided getter and setter, output if true
     template <typename T, typename GF, typename SF> inline auto field(T* field, GF aGetter, SF aSetter, output_if_true_t)
     {
-        return _field_t_make(std::bind(aGetter, field), std::bind(aSetter, field, std::placeholders::_1), _predicate_if_true<T>(field));
+        return _field_t_make(_bound_getter<T, GF>(field, aGetter), _bound_setter<T, SF>(field, aSetter), _predicate_if_true<T>(field));
     }
 
       // provided getter and setter, output if not empty
     template <typename T, typename GF, typename SF> inline auto field(T* field, GF aGetter, SF aSetter, output_if_not_empty_t)
     {
-        return _field_t_make(std::bind(aGetter, field), std::bind(aSetter, field, std::placeholders::_1), _predicate_if_not_empty<T>(field));
+        return _field_t_make(_bound_getter<T, GF>(field, aGetter), _bound_setter<T, SF>(field, aSetter), _predicate_if_not_empty<T>(field));
+    }
+
+      // ----------------------------------------------------------------------
+      // vector of objects written by columns
+      // ----------------------------------------------------------------------
+
+      // Value of json::field(&items, json::columnar) for std::vector<T> (T has json_fields()): written
+      // as an object with an array of values for every field, {"id": [1, 2], "name": ["a", "b"]}, instead
+      // of an array of objects repeating every key. Arrays of numbers are written and read by the
+      // dedicated loops, the vector is sized once by the first array. Refers to the field on writing,
+      // parsed items are kept inside until moved to the field.
+    template <typename T> class columns
+    {
+     public:
+        inline columns() : mSource(nullptr) {}
+        inline columns(const std::vector<T>* aSource) : mSource(aSource) {}
+
+        inline const std::vector<T>& items() const { return mSource ? *mSource : mItems; }
+          // cleared storage for parsed items, no longer refers to the field
+        inline std::vector<T>& parsed() { mSource = nullptr; mItems.clear(); return mItems; }
+        inline std::vector<T>&& release() { return std::move(mItems); }
+
+     private:
+        std::vector<T> mItems;
+        const std::vector<T>* mSource;
+    };
+
+    template <typename T> class _columns_getter
+    {
+     public:
+        typedef columns<T> result_type;
+        inline _columns_getter(const std::vector<T>* aField) : mField(aField) {}
+        inline columns<T> operator()() const { return columns<T>(mField); }
+     private:
+        const std::vector<T>* mField;
+    };
+
+    template <typename T> class _columns_setter
+    {
+     public:
+        inline _columns_setter(std::vector<T>* aField) : mField(aField) {}
+        inline void operator()(columns<T>&& val) const { *mField = val.release(); }
+        inline void operator()(const columns<T>& val) const { *mField = val.items(); }
+     private:
+        std::vector<T>* mField;
+    };
+
+      // default getter and setter, written by columns
+    template <typename T> inline auto field(std::vector<T>* field, columnar_t)
+    {
+        return _field_t_make(_columns_getter<T>(field), _columns_setter<T>(field), &_predicate_always);
     }
 
       // ----------------------------------------------------------------------
@@ -269,7 +765,7 @@ namespace json
     template <typename T> class _const_getter
     {
      public:
-        typedef T result_type;
+        typedef const T& result_type;
           //inline _const_getter(const T& aData) : m(aData) {}
         inline _const_getter(T&& aData) : m(std::move(aData)) {}
         inline const T& operator()() const { return m; }
@@ -284,636 +780,6170 @@ namespace json
 
     inline auto comment(const char* aComment)
     {
-        return _field_t_make(_const_getter<std::string>(std::string(aComment)), _no_setter<std::string>(), &_predicate_always);
+        return _field_t_make(_literal_getter(aComment), _no_setter<std::string>(), &_predicate_always);
     }
 
       // ----------------------------------------------------------------------
 
-    namespace r
+    namespace w { class output; }
+
+      // Object (having json_fields()) which json text is kept after dumping and copied to the
+      // next dumps while the object is not modified. Modifications are made via modify() or
+      // assignment, both drop the kept text. Kept text is per output layout (compact or
+      // pretty with the indentation and nesting depth), the last one is kept.
+    template <typename T> class cached
     {
-        typedef std::string::iterator iterator;
+     public:
+        inline cached() : mLayout(0, 0), mValid(false) {}
+        inline cached(const T& aValue) : mValue(aValue), mLayout(0, 0), mValid(false) {}
+        inline cached(T&& aValue) : mValue(std::move(aValue)), mLayout(0, 0), mValid(false) {}
+        inline cached& operator=(const T& aValue) { mValue = aValue; changed(); return *this; }
+        inline cached& operator=(T&& aValue) { mValue = std::move(aValue); changed(); return *this; }
 
-        class failure : public std::exception
-        {
-         public:
-            virtual ~failure() noexcept {}
-            template<class T> failure(T&& aMsg, iterator i1, iterator i2) : msg(std::forward<T>(aMsg)), text_start(i1), text(i1, std::min(i1 + 40, i2)) {}
-            failure(const failure&) = default;
-            virtual const char* what() const noexcept { return msg.c_str(); }
-            std::string message(std::string::iterator buffer_start) const { return msg + " at offset " + std::to_string(text_start - buffer_start) + " when parsing '" + text + "'"; }
+        inline const T& get() const { return mValue; }
+        inline operator const T&() const { return mValue; }
+        inline const T* operator->() const { return &mValue; }
 
-         private:
-            std::string msg;
-            iterator text_start;
-            std::string text;
-        };
+          // access for modification, kept text is dropped
+        inline T& modify() { changed(); return mValue; }
+          // to be called if the object was modified bypassing modify(), e.g. through a pointer kept elsewhere
+        inline void changed() { mValid = false; mFragment.clear(); }
 
-        template<typename R1, typename R2> class r_atomic_t AXE_RULE
-        {
-          public:
-            r_atomic_t(R1&& r1, R2&& r2) : r1_(std::forward<R1>(r1)), r2_(std::forward<R2>(r2)) {}
+     private:
+        T mValue;
+        mutable std::string mFragment; // text between the object braces
+        mutable std::pair<size_t, size_t> mLayout;
+        mutable bool mValid;
 
-            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+        friend class w::output;
+    };
+
+      // ----------------------------------------------------------------------
+
+      // Sorted vector of unique values used as std::set. The parser appends read values and
+      // sorts them once at the end of the array (not at all if they come sorted).
+    template <typename T> class flat_set
+    {
+     public:
+        typedef T key_type;
+        typedef T value_type;
+        typedef typename std::vector<T>::const_iterator iterator;
+        typedef typename std::vector<T>::const_iterator const_iterator;
+
+        inline flat_set() = default;
+        inline flat_set(std::initializer_list<T> aValues) : mData(aValues) { restore_order(); }
+        template <typename I> inline flat_set(I first, I last) : mData(first, last) { restore_order(); }
+
+        inline const_iterator begin() const { return mData.begin(); }
+        inline const_iterator end() const { return mData.end(); }
+        inline size_t size() const { return mData.size(); }
+        inline bool empty() const { return mData.empty(); }
+        inline void clear() { mData.clear(); }
+        inline void reserve(size_t size) { mData.reserve(size); }
+
+        inline const_iterator find(const T& value) const
             {
-                auto match = r1_(i1, i2);
-                if (match.matched) {   // if r1_ matched r2_ must match too
-                    match = r2_(match.position, i2);
-                    if (!match.matched)
-                        throw failure(std::string("matching failed for [") + axe::get_name(r1_) + "] followed by [" + axe::get_name(r2_) + "]", match.position, i2);
-                      // throw failure(std::string("R1 >= R2 rule failed with\n   R1: ") + axe::get_name(r1_) + "\n   R2: " + axe::get_name(r2_), match.position, i2);
-                    return axe::make_result(true, match.position);
-                }
-                return match;
+                const auto found = lower_bound(value);
+                return found != end() && !(value < *found) ? found : end();
             }
+        inline size_t count(const T& value) const { return find(value) != end() ? 1 : 0; }
 
-          private:
-            R1 r1_;
-            R2 r2_;
-        };
-
-        template<typename R1, typename R2> inline r_atomic_t<typename std::enable_if<AXE_IS_RULE(R1), R1>::type, typename std::enable_if<AXE_IS_RULE(R2), R2>::type> operator >= (R1&& r1, R2&& r2)
-        {
-            return r_atomic_t<R1, R2>(std::forward<R1>(r1), std::forward<R2>(r2));
-        }
+        template <typename V> inline std::pair<iterator, bool> insert(V&& value)
+            {
+                const auto found = lower_bound(value);
+                if (found != end() && !(value < *found))
+                    return {found, false};
+                return {mData.insert(found, std::forward<V>(value)), true};
+            }
+          // appended at the end if value is greater than the last one (e.g. values are inserted in order)
+        template <typename V> inline iterator insert(const_iterator, V&& value)
+            {
+                if (mData.empty() || mData.back() < value) {
+                    mData.push_back(std::forward<V>(value));
+                    return end() - 1;
+                }
+                return insert(std::forward<V>(value)).first;
+            }
+        inline size_t erase(const T& value)
+            {
+                const auto found = find(value);
+                if (found == end())
+                    return 0;
+                mData.erase(found);
+                return 1;
+            }
 
-          // ----------------------------------------------------------------------
+          // bulk filling: append in any order, then call restore_order()
+        template <typename V> inline void append(V&& value) { mData.push_back(std::forward<V>(value)); }
+          // sorts (unless sorted already) and removes duplicates
+        inline void restore_order()
+            {
+                if (std::adjacent_find(mData.begin(), mData.end(), [](const T& a, const T& b) { return !(a < b); }) == mData.end())
+                    return;
+                std::sort(mData.begin(), mData.end());
+                mData.erase(std::unique(mData.begin(), mData.end(), [](const T& a, const T& b) { return !(a < b); }), mData.end());
+            }
 
-        const auto space = axe::r_any(" \t\n\r");
-        const auto object_begin = axe::r_named(*space & axe::r_lit('{') & *space, "object_begin");
-        const auto object_end = axe::r_named(*space & axe::r_lit('}') & *space, "object end");
-        const auto array_begin = axe::r_named(*space & axe::r_lit('[') & *space, "array begin");
-        const auto array_end = axe::r_named(*space & axe::r_lit(']') & *space, "array end");
-        const auto comma = axe::r_named(*space & axe::r_lit(',') & *space, "comma");
-        const auto doublequotes = axe::r_named(axe::r_lit('"'), "doublequotes");
-        const auto colon = axe::r_named(*space & axe::r_lit(':') & *space, "colon");
-        const auto string_content = *("\\\"" | (axe::r_any() - axe::r_any("\"\n\r")));
-        const auto null = axe::r_lit("null");
-        inline auto skey(const char* key) { return axe::r_named(axe::r_named(doublequotes & key, "object key") >= doublequotes, "object key + doublequotes") >= colon; };
+        inline bool operator==(const flat_set& other) const { return mData == other.mData; }
+        inline bool operator!=(const flat_set& other) const { return mData != other.mData; }
 
-          // ----------------------------------------------------------------------
-          // forward decalrations
+     private:
+        std::vector<T> mData;
 
-        template <typename T> class parser_object_t;
-        template <typename T, typename std::enable_if<u::is_json_fields_defined<T>{} || u::is_json_fields_bool_defined<T>{}>::type* = nullptr> parser_object_t<T> parser_value(T& value);
+        inline const_iterator lower_bound(const T& value) const { return std::lower_bound(mData.begin(), mData.end(), value); }
+    };
 
-        template <typename T> class parser_array_t;
-          // Note use method for arrays only if there is no json_fields(T&) defined
-        template <typename T, typename std::enable_if<u::is_emplace_back_defined<T>{} && !u::is_json_fields_defined<T>{} && !u::is_json_fields_bool_defined<T>{}>::type* = nullptr> parser_array_t<T> parser_value(T& value);
+      // Vector of key-value pairs sorted by key used as std::map<std::string, T>. The parser
+      // appends read members and sorts them once at the end of the object (not at all if they
+      // come sorted). Keys must not be modified via iterators.
+    template <typename T> class flat_map
+    {
+     public:
+        typedef std::string key_type;
+        typedef T mapped_type;
+        typedef std::pair<std::string, T> value_type;
+        typedef typename std::vector<value_type>::iterator iterator;
+        typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+        inline flat_map() = default;
+        inline flat_map(std::initializer_list<value_type> aValues) : mData(aValues) { restore_order(); }
+
+        inline iterator begin() { return mData.begin(); }
+        inline iterator end() { return mData.end(); }
+        inline const_iterator begin() const { return mData.begin(); }
+        inline const_iterator end() const { return mData.end(); }
+        inline size_t size() const { return mData.size(); }
+        inline bool empty() const { return mData.empty(); }
+        inline void clear() { mData.clear(); }
+        inline void reserve(size_t size) { mData.reserve(size); }
+
+        inline iterator find(const std::string& key)
+            {
+                const auto found = lower_bound(key);
+                return found != end() && found->first == key ? found : end();
+            }
+        inline const_iterator find(const std::string& key) const { return const_cast<flat_map*>(this)->find(key); }
+        inline size_t count(const std::string& key) const { return find(key) != end() ? 1 : 0; }
 
-        template <typename T> class parser_set_t;
-        template <typename T> auto parser_value(std::set<T>& value);
-        template <typename T> class parser_map_t;
-        template <typename T> auto parser_value(std::map<std::string, T>& value);
+        inline T& at(const std::string& key) { const auto found = find(key); if (found == end()) throw std::out_of_range("json::flat_map::at"); return found->second; }
+        inline const T& at(const std::string& key) const { return const_cast<flat_map*>(this)->at(key); }
+        inline T& operator[](const std::string& key) { return emplace(key, T()).first->second; }
 
-          // ----------------------------------------------------------------------
-
-        // inline iterator s_to_number(iterator i1, iterator i2, int& target) { std::size_t pos = 0; target = std::stoi(std::string(i1, i2), &pos, 0); return i1 + static_cast<std::string::difference_type>(pos); }
-        // inline iterator s_to_number(iterator i1, iterator i2, long& target) { std::size_t pos = 0; target = std::stol(std::string(i1, i2), &pos, 0); return i1 + static_cast<std::string::difference_type>(pos); }
-        // inline iterator s_to_number(iterator i1, iterator i2, long long& target) { std::size_t pos = 0; target = std::stoll(std::string(i1, i2), &pos, 0); return i1 + static_cast<std::string::difference_type>(pos); }
-        // inline iterator s_to_number(iterator i1, iterator i2, unsigned long& target) { std::size_t pos = 0; target = std::stoul(std::string(i1, i2), &pos, 0); return i1 + static_cast<std::string::difference_type>(pos); }
-        // inline iterator s_to_number(iterator i1, iterator i2, unsigned long long& target) { std::size_t pos = 0; target = std::stoull(std::string(i1, i2), &pos, 0); return i1 + static_cast<std::string::difference_type>(pos); }
-        // inline iterator s_to_number(iterator i1, iterator i2, float& target) { std::size_t pos = 0; target = std::stof(std::string(i1, i2), &pos); return i1 + static_cast<std::string::difference_type>(pos); }
-        // inline iterator s_to_number(iterator i1, iterator i2, double& target) { std::size_t pos = 0; target = std::stod(std::string(i1, i2), &pos); return i1 + static_cast<std::string::difference_type>(pos); }
-        // inline iterator s_to_number(iterator i1, iterator i2, long double& target) { std::size_t pos = 0; target = std::stold(std::string(i1, i2), &pos); return i1 + static_cast<std::string::difference_type>(pos); }
+        template <typename K, typename V> inline std::pair<iterator, bool> emplace(K&& key, V&& value)
+            {
+                const auto found = lower_bound(key);
+                if (found != end() && found->first == key)
+                    return {found, false};
+                return {mData.emplace(found, std::forward<K>(key), std::forward<V>(value)), true};
+            }
+        inline std::pair<iterator, bool> insert(const value_type& value) { return emplace(value.first, value.second); }
+        inline std::pair<iterator, bool> insert(value_type&& value) { return emplace(std::move(value.first), std::move(value.second)); }
+          // appended at the end if key is greater than the last one (e.g. members are inserted in order)
+        template <typename K, typename V> inline iterator emplace_hint(const_iterator, K&& key, V&& value)
+            {
+                if (mData.empty() || mData.back().first < key) {
+                    mData.emplace_back(std::forward<K>(key), std::forward<V>(value));
+                    return end() - 1;
+                }
+                return emplace(std::forward<K>(key), std::forward<V>(value)).first;
+            }
+        inline size_t erase(const std::string& key)
+            {
+                const auto found = find(key);
+                if (found == end())
+                    return 0;
+                mData.erase(found);
+                return 1;
+            }
 
-        // template <typename T, typename = void> struct is_s_to_number_defined : public std::false_type {};
-        // template <typename T> struct is_s_to_number_defined<T, u::void_t<decltype(s_to_number(iterator(), iterator(), std::declval<T&>()))>> : public std::true_type {};
+          // bulk filling: append in any order, then call restore_order()
+        template <typename K, typename V> inline void append(K&& key, V&& value) { mData.emplace_back(std::forward<K>(key), std::forward<V>(value)); }
+          // sorts by key (unless sorted already) and removes duplicated keys keeping the first member (as std::map::insert does)
+        inline void restore_order()
+            {
+                const auto not_less = [](const value_type& a, const value_type& b) { return !(a.first < b.first); };
+                if (std::adjacent_find(mData.begin(), mData.end(), not_less) == mData.end())
+                    return;
+                std::stable_sort(mData.begin(), mData.end(), [](const value_type& a, const value_type& b) { return a.first < b.first; });
+                mData.erase(std::unique(mData.begin(), mData.end(), not_less), mData.end());
+            }
 
-        // template <typename T> class parser_number_t AXE_RULE
-        // {
-        //   public:
-        //     inline parser_number_t(T& v) : m(v) {}
-        //     inline axe::result<iterator> operator()(iterator i1, iterator i2) const
-        //     {
-        //         int t;
-        //         auto r = axe::r_decimal(t)(i1, i2);
-        //         m = static_cast<T>(t);
-        //         return r;
+        inline bool operator==(const flat_map& other) const { return mData == other.mData; }
+        inline bool operator!=(const flat_map& other) const { return mData != other.mData; }
 
-        //         // try {
-        //         //     const auto end = s_to_number(i1, i2, m);
-        //         //     return axe::make_result(end > i1, end, i1);
-        //         // }
-        //         // catch (std::invalid_argument&) {
-        //         //     return axe::make_result(false, i1);
-        //         // }
-        //         // catch (std::out_of_range&) {
-        //         //     axe::throw_failure("out of range", i1, i2);
-        //         // }
-        //     }
-        //   private:
-        //     T& m;
-        // };
+     private:
+        std::vector<value_type> mData;
 
-        // template <typename T, typename std::enable_if<is_s_to_number_defined<T>{}>::type* = nullptr> auto parser_value(T& value)
-        // {
-        //     return parser_number_t<T>(value);
-        // }
+        inline iterator lower_bound(const std::string& key) { return std::lower_bound(mData.begin(), mData.end(), key, [](const value_type& a, const std::string& k) { return a.first < k; }); }
+    };
 
-          // ----------------------------------------------------------------------
+      // ----------------------------------------------------------------------
+      // strings read in place
+      // ----------------------------------------------------------------------
 
-        template <typename T> class parser_float_t AXE_RULE
-        {
-          public:
-            inline parser_float_t(T& v) : m(v) {}
-            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+      // Text of a string value in the parsed input (without doublequotes, escapes are kept
+      // as with std::string), nothing is copied. Valid as long as the input buffer is.
+    class raw_string
+    {
+     public:
+        inline raw_string() : mData(""), mSize(0) {}
+        inline raw_string(const char* aData, size_t aSize) : mData(aData), mSize(aSize) {}
+        inline raw_string(const std::string& aText) : mData(aText.data()), mSize(aText.size()) {}
+
+        inline const char* data() const { return mData; }
+        inline size_t size() const { return mSize; }
+        inline bool empty() const { return mSize == 0; }
+        inline const char* begin() const { return mData; }
+        inline const char* end() const { return mData + mSize; }
+        inline std::string str() const { return std::string(mData, mSize); }
+
+        friend inline bool operator==(const raw_string& a, const raw_string& b) { return a.mSize == b.mSize && std::memcmp(a.mData, b.mData, a.mSize) == 0; }
+        friend inline bool operator!=(const raw_string& a, const raw_string& b) { return !(a == b); }
+        friend inline bool operator<(const raw_string& a, const raw_string& b)
             {
-                auto set_nan = axe::e_ref([this](auto, auto) { m = std::numeric_limits<T>::quiet_NaN(); });
-                return (axe::r_double(m) | (null >> set_nan))(i1, i2);
+                const auto result = std::memcmp(a.mData, b.mData, std::min(a.mSize, b.mSize));
+                return result < 0 || (result == 0 && a.mSize < b.mSize);
             }
-          private:
-            T& m;
-        };
+        friend inline std::ostream& operator<<(std::ostream& out, const raw_string& a) { return out.write(a.mData, static_cast<std::streamsize>(a.mSize)); }
+
+     private:
+        const char* mData;
+        size_t mSize;
+    };
+
+      // ----------------------------------------------------------------------
+      // binary data as base64 strings
+      // ----------------------------------------------------------------------
+
+      // Bytes (image, serialized message) written as a base64 string (RFC 4648, padded),
+      // instead of an array of numbers std::vector<unsigned char> is written as.
+      // null and "" are read as no bytes.
+    class blob
+    {
+     public:
+        inline blob() = default;
+        inline blob(std::vector<unsigned char> aData) : mData(std::move(aData)) {}
+        inline blob(const void* aData, size_t aSize) { assign(aData, aSize); }
+
+        inline const unsigned char* data() const { return mData.data(); }
+        inline unsigned char* data() { return mData.data(); }
+        inline size_t size() const { return mData.size(); }
+        inline bool empty() const { return mData.empty(); }
+        inline const unsigned char* begin() const { return mData.data(); }
+        inline const unsigned char* end() const { return mData.data() + mData.size(); }
+        inline void assign(const void* aData, size_t aSize) { const auto first = static_cast<const unsigned char*>(aData); mData.assign(first, first + aSize); }
+        inline void resize(size_t aSize) { mData.resize(aSize); }
+        inline void reserve(size_t aSize) { mData.reserve(aSize); }
+        inline void clear() { mData.clear(); }
+        inline const std::vector<unsigned char>& bytes() const { return mData; }
+        inline std::vector<unsigned char>& bytes() { return mData; }
+
+        friend inline bool operator==(const blob& a, const blob& b) { return a.mData == b.mData; }
+        friend inline bool operator!=(const blob& a, const blob& b) { return !(a == b); }
+
+     private:
+        std::vector<unsigned char> mData;
+    };
+
+      // Codec: 16 chars are decoded (and 12 bytes encoded) per step with SSE2, the rest
+      // is done by table lookups. Output is written into memory of the exact size
+      // allocated beforehand.
+    namespace base64
+    {
+        constexpr const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        constexpr unsigned char not_base64 = 0x80;
 
-        template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> auto parser_value(T& value)
+        constexpr size_t encoded_size(size_t size) { return (size + 2) / 3 * 4; }
+
+          // 6-bit value of every char, not_base64 for chars out of the alphabet
+        inline const unsigned char* decoding_table()
         {
-            return parser_float_t<T>(value);
+            struct table
+            {
+                inline table() { std::memset(values, not_base64, sizeof(values)); for (unsigned char no = 0; no < 64; ++no) values[static_cast<unsigned char>(alphabet[no])] = no; }
+                unsigned char values[256];
+            };
+            static const table decoding;
+            return decoding.values;
         }
 
-        template <typename T, typename std::enable_if<std::is_unsigned<T>{}>::type* = nullptr> auto parser_value(T& value)
+          // strips padding off size, returns number of bytes encoded by text or std::string::npos if size is not possible
+        inline size_t decoded_size(const char* text, size_t& size)
         {
-            return axe::r_udecimal(value);
+            if (size % 4 == 0 && size > 0 && text[size - 1] == '=')
+                size -= text[size - 2] == '=' ? 2 : 1;
+            if (size % 4 == 1)
+                return std::string::npos;
+            return size / 4 * 3 + (size % 4 == 0 ? 0 : size % 4 - 1);
         }
 
-        template <typename T, typename std::enable_if<std::is_integral<T>{} && std::is_signed<T>{}>::type* = nullptr> auto parser_value(T& value)
+#ifdef __SSE2__
+        inline void encode_block(const unsigned char* first, char* out)
         {
-            return axe::r_decimal(value);
+            const auto group = [first](int no) { return static_cast<int>(first[no * 3] << 16 | first[no * 3 + 1] << 8 | first[no * 3 + 2]); };
+            const __m128i groups = _mm_set_epi32(group(3), group(2), group(1), group(0));
+            const __m128i mask = _mm_set1_epi32(0x3F);
+              // 4 indices of every group into its 4 bytes, the first one into the lowest byte
+            const __m128i indices = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(groups, 18), mask), _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(groups, 12), mask), 8)),
+                                                 _mm_or_si128(_mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(groups, 6), mask), 16), _mm_slli_epi32(_mm_and_si128(groups, mask), 24)));
+              // 'A' - 0 for 0..25, then 'a' - 26, '0' - 52, '+' - 62, '/' - 63
+            const auto above = [&indices](char index, char offset) { return _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(index)), _mm_set1_epi8(offset)); };
+            const __m128i offsets = _mm_add_epi8(_mm_add_epi8(_mm_set1_epi8('A'), above(25, 6)), _mm_add_epi8(_mm_add_epi8(above(51, -75), above(61, -15)), above(62, 3)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_add_epi8(indices, offsets));
         }
 
-          // ----------------------------------------------------------------------
-
-        class parser_string_t AXE_RULE
+          // false if any of the chars is not in the alphabet
+        inline bool decode_block(const char* text, unsigned char* out)
         {
-          public:
-            inline parser_string_t(std::string& v) : m(v) {}
-            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
-            {
-                auto clear_target = axe::e_ref([this](auto, auto) { m.clear(); });
-                return ((doublequotes >= (string_content >> m) >= doublequotes) | (null >> clear_target))(i1, i2);
+            const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+            const auto between = [&chars](char lowest, char highest) { return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(static_cast<char>(lowest - 1))), _mm_cmplt_epi8(chars, _mm_set1_epi8(static_cast<char>(highest + 1)))); };
+            const __m128i upper = between('A', 'Z'), lower = between('a', 'z'), digit = between('0', '9');
+            const __m128i plus = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+')), slash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+            if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), digit), _mm_or_si128(plus, slash))) != 0xFFFF)
+                return false;
+            const auto offset = [](__m128i selected, char value) { return _mm_and_si128(selected, _mm_set1_epi8(value)); };
+            const __m128i values = _mm_add_epi8(chars, _mm_or_si128(_mm_or_si128(_mm_or_si128(offset(upper, -'A'), offset(lower, 26 - 'a')), offset(digit, 52 - '0')),
+                                                                    _mm_or_si128(offset(plus, 62 - '+'), offset(slash, 63 - '/'))));
+              // 4 values of 6 bits in every 32 bit lane joined into 24 bits
+            const __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0xFF)), 6), _mm_srli_epi16(values, 8));
+            const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+            uint32_t group[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(group), groups);
+            for (size_t no = 0; no < 4; ++no, out += 3) {
+                out[0] = static_cast<unsigned char>(group[no] >> 16);
+                out[1] = static_cast<unsigned char>(group[no] >> 8);
+                out[2] = static_cast<unsigned char>(group[no]);
             }
-          private:
-            std::string& m;
-        };
+            return true;
+        }
+#endif
 
-        inline auto parser_value(std::string& target)
+          // writes encoded_size(size) chars to out
+        inline void encode(const unsigned char* first, size_t size, char* out)
         {
-            return parser_string_t(target);
+            const unsigned char* const last = first + size;
+#ifdef __SSE2__
+            for (; last - first >= 12; first += 12, out += 16)
+                encode_block(first, out);
+#endif
+            for (; last - first >= 3; first += 3, out += 4) {
+                out[0] = alphabet[first[0] >> 2];
+                out[1] = alphabet[(first[0] & 0x03) << 4 | first[1] >> 4];
+                out[2] = alphabet[(first[1] & 0x0F) << 2 | first[2] >> 6];
+                out[3] = alphabet[first[2] & 0x3F];
+            }
+            if (first != last) {
+                const unsigned second = last - first == 2 ? first[1] : 0;
+                out[0] = alphabet[first[0] >> 2];
+                out[1] = alphabet[(first[0] & 0x03) << 4 | second >> 4];
+                out[2] = last - first == 2 ? alphabet[(second & 0x0F) << 2] : '=';
+                out[3] = '=';
+            }
         }
 
-        class parser_bool_t AXE_RULE
+          // text of size chars without padding (see decoded_size()) into out, false if text is not base64
+        inline bool decode(const char* text, size_t size, unsigned char* out)
         {
-          public:
-            inline parser_bool_t(bool& v) : m(v) {}
-            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            const char* const last = text + size;
+#ifdef __SSE2__
+            for (; last - text >= 16; text += 16, out += 12) {
+                if (!decode_block(text, out))
+                    return false;
+            }
+#endif
+            const unsigned char* const table = decoding_table();
+            const auto value = [table](char c) -> uint32_t { return table[static_cast<unsigned char>(c)]; };
+            for (; last - text >= 4; text += 4, out += 3) {
+                const uint32_t a = value(text[0]), b = value(text[1]), c = value(text[2]), d = value(text[3]);
+                if ((a | b | c | d) & not_base64)
+                    return false;
+                const uint32_t group = a << 18 | b << 12 | c << 6 | d;
+                out[0] = static_cast<unsigned char>(group >> 16);
+                out[1] = static_cast<unsigned char>(group >> 8);
+                out[2] = static_cast<unsigned char>(group);
+            }
+            if (text != last) { // 2 or 3 chars left
+                const uint32_t a = value(text[0]), b = value(text[1]), c = last - text == 3 ? value(text[2]) : 0;
+                if ((a | b | c) & not_base64)
+                    return false;
+                out[0] = static_cast<unsigned char>(a << 2 | b >> 4);
+                if (last - text == 3)
+                    out[1] = static_cast<unsigned char>(b << 4 | c >> 2);
+            }
+            return true;
+        }
+    }
+
+      // ----------------------------------------------------------------------
+      // enum values written as strings
+      // ----------------------------------------------------------------------
+
+      // Names of the values of enum E, returned by json_enum_names(E) found by ADL (declared
+      // next to the enum):
+      //   inline auto json_enum_names(Color) { return json::enum_names<Color>{{Color::red, "red"}, {Color::green, "green"}}; }
+      // json_enum_names() is called once per type. A name is found by value with direct indexing
+      // (binary search if values are sparse), a value is found by name with a perfect hash built
+      // for the names: one hash and one comparison.
+    template <typename E> class enum_names
+    {
+     public:
+        inline enum_names(std::initializer_list<std::pair<E, const char*>> aNames)
             {
-                auto yes = axe::e_ref([this](auto, auto) { m = true; });
-                auto no = axe::e_ref([this](auto, auto) { m = false; });
-                return ((axe::r_str("true") >> yes) | (axe::r_str("1") >> yes) | (axe::r_str("false") >> no) | (axe::r_str("0") >> no) | axe::r_fail("true or 1 or false or 0 expected"))(i1, i2);
+                for (const auto& name: aNames)
+                    mEntries.push_back({name.first, name.second, std::strlen(name.second)});
+                make_by_value();
+                make_by_name();
             }
-          private:
-            bool& m;
-        };
 
-        inline auto parser_value(bool& target)
-        {
-            return parser_bool_t(target);
-        }
+          // the table of E made by json_enum_names(E)
+        static inline const enum_names& get()
+            {
+                static const enum_names names = json_enum_names(E{});
+                return names;
+            }
 
-          // ----------------------------------------------------------------------
-          // field_t
-          // ----------------------------------------------------------------------
+          // returns nullptr if value has no name
+        inline const char* name(E value, size_t& size) const
+            {
+                const auto no = find(value);
+                if (no == 0)
+                    return nullptr;
+                size = mEntries[no - 1].size;
+                return mEntries[no - 1].name;
+            }
 
-        template <typename S, typename V> class parser_field_t AXE_RULE
-        {
-          public:
-            inline parser_field_t(S& aS) : mS(aS) {}
-            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+          // throws std::out_of_range if value has no name
+        inline const char* at(E value, size_t& size) const
             {
-                V v;
-                auto r = parser_value(v)(i1, i2);
-                mS(v);
-                return r;
+                if (const char* result = name(value, size))
+                    return result;
+                throw std::out_of_range("json::enum_names: value " + std::to_string(static_cast<underlying>(value)) + " of " + typeid(E).name() + " has no name");
             }
-          private:
-            S mS;
-        };
 
-        template <typename G, typename S, typename P> inline auto parser_value(field_t<G, S, P>& a)
-        {
-            typedef typename field_t<G, S, P>::value_type value_type;
-            return parser_field_t<S, value_type>(a.setter());
-        }
+        inline bool value(const char* name, size_t size, E& target) const
+            {
+                const auto no = mByName[hash(name, size, mSeed) & (mByName.size() - 1)];
+                if (no == 0 || mEntries[no - 1].size != size || std::memcmp(mEntries[no - 1].name, name, size) != 0)
+                    return false;
+                target = mEntries[no - 1].value;
+                return true;
+            }
 
-          // ----------------------------------------------------------------------
-          // object -> struct
-          // ----------------------------------------------------------------------
+     private:
+        typedef typename std::underlying_type<E>::type underlying;
 
-        template <typename T> inline auto parser_object_item(const char* key, T& value)
-        {
-            return skey(key) >= parser_value(value);
-        }
+        struct entry { E value; const char* name; size_t size; };
 
-        template <typename T> inline auto parser_object_item(const char* key, T* value)
-        {
-            return skey(key) >= parser_value(*value);
-        }
+        std::vector<entry> mEntries;
+        uint64_t mMin;
+        bool mDense;
+        std::vector<unsigned> mByValue; // entry number + 1, 0 for no entry: indexed by value - mMin if mDense, sorted by value otherwise
+        std::vector<unsigned> mByName;  // entry number + 1, 0 for no entry, indexed by hash of the name
+        uint32_t mSeed;
 
-        template <typename T> inline auto make_items_parser_tuple(std::tuple<const char*, T*>&& a)
-        {
-            return parser_object_item(std::get<0>(a), std::get<1>(a)); // *
-        }
+        static inline uint64_t key(E value) { return static_cast<uint64_t>(static_cast<underlying>(value)); }
 
-          // Necessary for tuple<const char *, json::field_t<>>
-        template <typename T> inline auto make_items_parser_tuple(std::tuple<const char*, T>&& a)
-        {
-            return parser_object_item(std::get<0>(a), std::get<1>(a));
-        }
+        static inline uint32_t hash(const char* name, size_t size, uint32_t seed)
+            {
+                uint32_t result = 2166136261u ^ seed; // FNV-1a
+                for (const char* end = name + size; name != end; ++name)
+                    result = (result ^ static_cast<unsigned char>(*name)) * 16777619u;
+                return result ^ (result >> 15);
+            }
 
-        template <typename... Ts> inline auto make_items_parser_tuple(std::tuple<Ts...>&& a)
-        {
-            return parser_object_item(std::get<0>(a), std::get<1>(a)) | make_items_parser_tuple(u::tuple_tail<2>(a));
-        }
+        inline unsigned find(E value) const
+            {
+                if (mDense) {
+                    const auto index = key(value) - mMin; // values less than mMin wrap around
+                    return index < mByValue.size() ? mByValue[index] : 0;
+                }
+                const auto found = std::lower_bound(mByValue.begin(), mByValue.end(), value, [this](unsigned no, E v) { return static_cast<underlying>(mEntries[no - 1].value) < static_cast<underlying>(v); });
+                return found != mByValue.end() && mEntries[*found - 1].value == value ? *found : 0;
+            }
 
-        template <typename T> class parser_object_t AXE_RULE
-        {
-          public:
-            inline parser_object_t(T& v) : m(v) {}
-            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+        inline void make_by_value()
             {
-                auto item = make_items_parser_tuple(u::call_json_fields(m, false));
-                return (object_begin >= ~( item & *(comma >= item) ) >= object_end)(i1, i2);
+                const auto less = [](const entry& a, const entry& b) { return static_cast<underlying>(a.value) < static_cast<underlying>(b.value); };
+                const auto range = std::minmax_element(mEntries.begin(), mEntries.end(), less);
+                mMin = range.first == mEntries.end() ? 0 : key(range.first->value);
+                const uint64_t span = range.first == mEntries.end() ? 0 : key(range.second->value) - mMin + 1;
+                mDense = span <= 2 * mEntries.size() + 16;
+                if (mDense) {
+                    mByValue.assign(static_cast<size_t>(span), 0);
+                    for (unsigned no = static_cast<unsigned>(mEntries.size()); no > 0; --no) // the first name of the value is written
+                        mByValue[static_cast<size_t>(key(mEntries[no - 1].value) - mMin)] = no;
+                }
+                else {
+                    for (unsigned no = 1; no <= mEntries.size(); ++no)
+                        mByValue.push_back(no);
+                    std::stable_sort(mByValue.begin(), mByValue.end(), [&less, this](unsigned a, unsigned b) { return less(mEntries[a - 1], mEntries[b - 1]); });
+                }
             }
-          private:
-            T& m;
-        };
 
-        template <typename T, typename std::enable_if<u::is_json_fields_defined<T>{} || u::is_json_fields_bool_defined<T>{}>::type*> parser_object_t<T> parser_value(T& value)
-        {
-            return parser_object_t<T>(value);
-        }
+          // tries seeds until all names get different slots, table size is doubled after every 64 seeds
+        inline void make_by_name()
+            {
+                size_t size = 2;
+                while (size < mEntries.size() * 2)
+                    size *= 2;
+                for (uint32_t attempt = 0; ; ++attempt) {
+                    if (attempt > 0 && attempt % 64 == 0)
+                        size *= 2;
+                    mSeed = attempt * 2654435761u;
+                    mByName.assign(size, 0);
+                    bool collision = false;
+                    for (unsigned no = 1; !collision && no <= mEntries.size(); ++no) {
+                        auto& slot = mByName[hash(mEntries[no - 1].name, mEntries[no - 1].size, mSeed) & (size - 1)];
+                        if (slot != 0) {
+                            const auto& other = mEntries[slot - 1];
+                            if (other.size == mEntries[no - 1].size && std::memcmp(other.name, mEntries[no - 1].name, other.size) == 0)
+                                throw std::invalid_argument(std::string("json::enum_names: duplicated name \"") + other.name + "\"");
+                            collision = true;
+                        }
+                        slot = no;
+                    }
+                    if (!collision)
+                        return;
+                }
+            }
+    };
 
-          // ----------------------------------------------------------------------
-          // array -> vector, list, set
-          // ----------------------------------------------------------------------
+      // ----------------------------------------------------------------------
+      // string interning
+      // ----------------------------------------------------------------------
 
-        template <typename T> class parser_list_t AXE_RULE
-        {
-          public:
-            typedef typename T::value_type item_type;
-            inline parser_list_t(T& v) : m(v) {}
-            inline parser_list_t(const parser_list_t<T>& v) = default;
-            virtual inline ~parser_list_t() = default;
-            virtual void add() const = 0;
-            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+    class string_pool;
+
+      // Immutable string shared by all equal values read via the same pool. Copying
+      // and comparing values of the same pool is just copying and comparing a pointer.
+    class interned_string
+    {
+     public:
+        inline interned_string() : mText(&empty_text()) {}
+
+        inline const std::string& str() const { return *mText; }
+        inline operator const std::string& () const { return *mText; }
+        inline const char* data() const { return mText->data(); }
+        inline const char* c_str() const { return mText->c_str(); }
+        inline size_t size() const { return mText->size(); }
+        inline bool empty() const { return mText->empty(); }
+
+        friend inline bool operator==(const interned_string& a, const interned_string& b) { return a.mText == b.mText || *a.mText == *b.mText; }
+        friend inline bool operator!=(const interned_string& a, const interned_string& b) { return !(a == b); }
+        friend inline bool operator<(const interned_string& a, const interned_string& b) { return a.mText != b.mText && *a.mText < *b.mText; }
+        friend inline std::ostream& operator<<(std::ostream& out, const interned_string& a) { return out << *a.mText; }
+
+     private:
+        const std::string* mText;
+
+        inline interned_string(const std::string* aText) : mText(aText) {}
+        static inline const std::string& empty_text() { static const std::string empty; return empty; }
+
+        friend class string_pool;
+    };
+
+      // Set of unique strings for interned_string values, strings live as long as the pool.
+      // Lookup of an already interned text is lock free, adding a new text takes a mutex,
+      // so the same pool can be used by several parsing threads at once.
+    class string_pool
+    {
+     public:
+        inline string_pool(size_t expected_size = 512) : mSize(0)
             {
-                auto clear_target = axe::e_ref([this](auto, auto) { this->m.clear(); });
-                auto insert_item = axe::e_ref([this](auto, auto) { this->add(); });
-                auto clear_item = axe::e_ref([this](auto, auto) { this->keep = item_type(); });
-                auto item = (axe::r_empty() >> clear_item) & (parser_value(keep) >> insert_item);
-                return ((array_begin >> clear_target) >= ~( item & *(comma >= item) ) >= array_end)(i1, i2);
+                size_t slots = 16;
+                while (slots < expected_size * 2)
+                    slots *= 2;
+                mCurrent.store(add_table(slots), std::memory_order_release);
             }
-          protected:
-            T& m;
-            mutable item_type keep;
-        };
 
-        template <typename T> class parser_set_t : public parser_list_t<T>
+        string_pool(const string_pool&) = delete;
+        string_pool& operator=(const string_pool&) = delete;
+
+        inline interned_string intern(const char* text, size_t size)
+            {
+                if (size == 0)
+                    return interned_string();
+                const auto hash = hash_of(text, size);
+                if (const auto* found = find(*mCurrent.load(std::memory_order_acquire), hash, text, size))
+                    return &found->text;
+                std::lock_guard<std::mutex> lock(mMutex);
+                table* current = mCurrent.load(std::memory_order_relaxed);
+                if (const auto* found = find(*current, hash, text, size)) // added by another thread
+                    return &found->text;
+                if ((mSize + 1) * 2 > current->mask + 1)
+                    current = grow(*current);
+                mEntries.push_back(entry{hash, std::string(text, size)});
+                insert(*current, &mEntries.back());
+                ++mSize;
+                return &mEntries.back().text;
+            }
+
+        inline interned_string intern(const std::string& text) { return intern(text.data(), text.size()); }
+
+          // number of unique strings
+        inline size_t size() const { std::lock_guard<std::mutex> lock(mMutex); return mSize; }
+
+     private:
+        struct entry
         {
-         public:
-            inline parser_set_t(T& v) : parser_list_t<T>(v) {}
-            virtual inline void add() const { this->m.insert(this->keep); }
+            uint64_t hash;
+            std::string text;
         };
 
-        template <typename T> auto parser_value(std::set<T>& value)
+        struct table
         {
-            return parser_set_t<std::set<T>>(value);
-        }
+            size_t mask;
+            std::unique_ptr<std::atomic<const entry*>[]> slots;
+        };
 
-        template <typename T> class parser_array_t : public parser_list_t<T>
+        mutable std::mutex mMutex;
+        std::atomic<table*> mCurrent;
+          // tables replaced on growth are kept: threads may still be looking into them
+        std::vector<std::unique_ptr<table>> mTables;
+          // deque does not move its elements on push_back
+        std::deque<entry> mEntries;
+        size_t mSize;
+
+        static inline uint64_t hash_of(const char* text, size_t size)
+            {
+                uint64_t hash = 14695981039346656037ULL; // FNV-1a
+                for (const char* end = text + size; text != end; ++text)
+                    hash = (hash ^ static_cast<unsigned char>(*text)) * 1099511628211ULL;
+                return hash;
+            }
+
+        static inline const entry* find(const table& tab, uint64_t hash, const char* text, size_t size)
+            {
+                for (size_t index = hash & tab.mask; ; index = (index + 1) & tab.mask) {
+                    const entry* candidate = tab.slots[index].load(std::memory_order_acquire);
+                    if (candidate == nullptr)
+                        return nullptr;
+                    if (candidate->hash == hash && candidate->text.size() == size && std::memcmp(candidate->text.data(), text, size) == 0)
+                        return candidate;
+                }
+            }
+
+        static inline void insert(table& tab, const entry* item)
+            {
+                size_t index = item->hash & tab.mask;
+                while (tab.slots[index].load(std::memory_order_relaxed) != nullptr)
+                    index = (index + 1) & tab.mask;
+                tab.slots[index].store(item, std::memory_order_release);
+            }
+
+        inline table* add_table(size_t slots)
+            {
+                mTables.push_back(std::unique_ptr<table>(new table{slots - 1, std::unique_ptr<std::atomic<const entry*>[]>(new std::atomic<const entry*>[slots]())}));
+                return mTables.back().get();
+            }
+
+        inline table* grow(const table& current)
+            {
+                table* bigger = add_table((current.mask + 1) * 2);
+                for (const auto& item: mEntries)
+                    insert(*bigger, &item);
+                mCurrent.store(bigger, std::memory_order_release);
+                return bigger;
+            }
+    };
+
+      // parsing option: interned_string values are added to the pool, required to read them
+    class interning_t
+    {
+     public:
+        inline interning_t(string_pool& aPool) : pool(&aPool) {}
+        string_pool* pool;
+    };
+
+    inline interning_t interning(string_pool& pool) { return interning_t(pool); }
+
+      // ----------------------------------------------------------------------
+
+    namespace r
+    {
+        typedef const char* iterator;
+
+        class failure : public std::exception
+        {
+         public:
+            virtual ~failure() noexcept {}
+            template<class T> failure(T&& aMsg, iterator i1, iterator i2) : msg(std::forward<T>(aMsg)), text_start(i1), text(i1, std::min(i1 + 40, i2)) {}
+            template<class T> explicit failure(T&& aMsg) : msg(std::forward<T>(aMsg)), text_start(nullptr) {}
+            failure(const failure&) = default;
+            virtual const char* what() const noexcept { return msg.c_str(); }
+            std::string message(iterator buffer_start) const { return msg + " at offset " + std::to_string(text_start - buffer_start) + " when parsing '" + text + "'"; }
+
+         private:
+            std::string msg;
+            iterator text_start;
+            std::string text;
+        };
+
+        template<typename R1, typename R2> class r_atomic_t AXE_RULE
+        {
+          public:
+            r_atomic_t(R1&& r1, R2&& r2) : r1_(std::forward<R1>(r1)), r2_(std::forward<R2>(r2)) {}
+
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                auto match = r1_(i1, i2);
+                if (match.matched) {   // if r1_ matched r2_ must match too
+                    match = r2_(match.position, i2);
+                    if (!match.matched)
+                        throw failure(std::string("matching failed for [") + axe::get_name(r1_) + "] followed by [" + axe::get_name(r2_) + "]", match.position, i2);
+                      // throw failure(std::string("R1 >= R2 rule failed with\n   R1: ") + axe::get_name(r1_) + "\n   R2: " + axe::get_name(r2_), match.position, i2);
+                    return axe::make_result(true, match.position);
+                }
+                return match;
+            }
+
+          private:
+            R1 r1_;
+            R2 r2_;
+        };
+
+        template<typename R1, typename R2> inline r_atomic_t<typename std::enable_if<AXE_IS_RULE(R1), R1>::type, typename std::enable_if<AXE_IS_RULE(R2), R2>::type> operator >= (R1&& r1, R2&& r2)
+        {
+            return r_atomic_t<R1, R2>(std::forward<R1>(r1), std::forward<R2>(r2));
+        }
+
+          // ----------------------------------------------------------------------
+
+        const auto space = axe::r_any(" \t\n\r");
+        const auto object_begin = axe::r_named(*space & axe::r_lit('{') & *space, "object_begin");
+        const auto object_end = axe::r_named(*space & axe::r_lit('}') & *space, "object end");
+        const auto array_begin = axe::r_named(*space & axe::r_lit('[') & *space, "array begin");
+        const auto array_end = axe::r_named(*space & axe::r_lit(']') & *space, "array end");
+        const auto comma = axe::r_named(*space & axe::r_lit(',') & *space, "comma");
+        const auto doublequotes = axe::r_named(axe::r_lit('"'), "doublequotes");
+        const auto colon = axe::r_named(*space & axe::r_lit(':') & *space, "colon");
+        const auto string_content = *("\\\"" | (axe::r_any() - axe::r_any("\"\n\r")));
+        const auto null = axe::r_lit("null");
+
+          // ----------------------------------------------------------------------
+          // parsing options shared by all the rules of a single json::parse call
+
+        class context
+        {
+         public:
+            inline context() : ignore_unknown(false), projection(false), merge_patch(false), transient_input(false), strings(nullptr) {}
+
+            bool ignore_unknown;   // skip values of the keys not listed in json_fields() instead of failing
+            bool projection;       // ignore_unknown + skip the rest of an object as soon as all its fields were read
+            bool merge_patch;      // RFC 7386: objects and maps are updated in place, null removes/resets the member
+            bool transient_input;  // input is fed in chunks and not kept (push parser), raw_string cannot be read
+            string_pool* strings;  // pool for interned_string values (json::interning), they cannot be read without it
+        };
+
+          // ----------------------------------------------------------------------
+          // skipping values without materializing them
+          // ----------------------------------------------------------------------
+
+        inline iterator skip_space(iterator i1, iterator i2)
+        {
+            while (i1 != i2 && (*i1 == ' ' || *i1 == '\t' || *i1 == '\n' || *i1 == '\r'))
+                ++i1;
+            return i1;
+        }
+
+          // i1 is just after the opening doublequotes, returns position after the closing doublequotes
+        inline iterator skip_string_rest(iterator i1, iterator i2)
+        {
+            const iterator start = i1;
+            for (;;) {
+                i1 = u::find_first_of<'"', '\\'>(i1, i2);
+                if (i1 == i2)
+                    throw failure("unterminated string", start, i2);
+                if (*i1 == '"')
+                    return i1 + 1;
+                i1 += 2;        // escaped char
+                if (i1 > i2)
+                    throw failure("unterminated string", start, i2);
+            }
+        }
+
+          // i1 is inside of the object or array nested depth levels deep, returns position after the bracket closing the outermost one
+        inline iterator skip_nested_rest(iterator i1, iterator i2, size_t depth)
+        {
+            const iterator start = i1;
+            while (depth) {
+                i1 = u::find_first_of<'"', '{', '}', '[', ']'>(i1, i2);
+                if (i1 == i2)
+                    throw failure("unterminated object or array", start, i2);
+                switch (*i1) {
+                  case '"':
+                      i1 = skip_string_rest(i1 + 1, i2);
+                      break;
+                  case '{':
+                  case '[':
+                      ++depth;
+                      ++i1;
+                      break;
+                  default:
+                      --depth;
+                      ++i1;
+                      break;
+                }
+            }
+            return i1;
+        }
+
+          // skips a value of any kind (including deeply nested objects and arrays), returns position after it
+        inline iterator skip_value(iterator i1, iterator i2)
+        {
+            i1 = skip_space(i1, i2);
+            if (i1 == i2)
+                throw failure("value expected", i1, i2);
+            switch (*i1) {
+              case '"':
+                  return skip_string_rest(i1 + 1, i2);
+              case '{':
+              case '[':
+                  return skip_nested_rest(i1 + 1, i2, 1);
+              default: {
+                  const iterator end = u::find_first_of<',', '}', ']', ' ', '\t', '\n', '\r'>(i1, i2);
+                  if (end == i1)
+                      throw failure("value expected", i1, i2);
+                  return end;
+              }
+            }
+        }
+
+          // ----------------------------------------------------------------------
+          // forward decalrations
+
+        template <typename T> class parser_object_t;
+        template <typename T, typename std::enable_if<u::is_json_fields_defined<T>{} || u::is_json_fields_bool_defined<T>{}>::type* = nullptr> parser_object_t<T> parser_value(T& value, context& ctx);
+
+        template <typename T> class parser_array_t;
+          // Note use method for arrays only if there is no json_fields(T&) defined
+        template <typename T, typename std::enable_if<u::is_emplace_back_defined<T>{} && !u::is_json_fields_defined<T>{} && !u::is_json_fields_bool_defined<T>{}>::type* = nullptr> parser_array_t<T> parser_value(T& value, context& ctx);
+
+        template <typename T> class parser_set_t;
+        template <typename T> auto parser_value(std::set<T>& value, context& ctx);
+        template <typename T> auto parser_value(flat_set<T>& value, context& ctx);
+        template <typename T, typename std::enable_if<u::is_number<T>{}>::type* = nullptr> auto parser_value(std::vector<T>& value, context& ctx);
+        template <typename T, size_t N> auto parser_value(std::array<T, N>& value, context& ctx);
+        template <typename T> class parser_map_t;
+        template <typename T> auto parser_value(std::map<std::string, T>& value, context& ctx);
+        template <typename T> auto parser_value(std::unordered_map<std::string, T>& value, context& ctx);
+        template <typename T> auto parser_value(flat_map<T>& value, context& ctx);
+        template <typename T> auto parser_value(columns<T>& value, context& ctx);
+
+        template <typename T> inline auto parser_value(cached<T>& value, context& ctx)
+        {
+            return parser_value(value.modify(), ctx);
+        }
+
+          // ----------------------------------------------------------------------
+
+        // inline iterator s_to_number(iterator i1, iterator i2, int& target) { std::size_t pos = 0; target = std::stoi(std::string(i1, i2), &pos, 0); return i1 + static_cast<std::string::difference_type>(pos); }
+        // inline iterator s_to_number(iterator i1, iterator i2, long& target) { std::size_t pos = 0; target = std::stol(std::string(i1, i2), &pos, 0); return i1 + static_cast<std::string::difference_type>(pos); }
+        // inline iterator s_to_number(iterator i1, iterator i2, long long& target) { std::size_t pos = 0; target = std::stoll(std::string(i1, i2), &pos, 0); return i1 + static_cast<std::string::difference_type>(pos); }
+        // inline iterator s_to_number(iterator i1, iterator i2, unsigned long& target) { std::size_t pos = 0; target = std::stoul(std::string(i1, i2), &pos, 0); return i1 + static_cast<std::string::difference_type>(pos); }
+        // inline iterator s_to_number(iterator i1, iterator i2, unsigned long long& target) { std::size_t pos = 0; target = std::stoull(std::string(i1, i2), &pos, 0); return i1 + static_cast<std::string::difference_type>(pos); }
+        // inline iterator s_to_number(iterator i1, iterator i2, float& target) { std::size_t pos = 0; target = std::stof(std::string(i1, i2), &pos); return i1 + static_cast<std::string::difference_type>(pos); }
+        // inline iterator s_to_number(iterator i1, iterator i2, double& target) { std::size_t pos = 0; target = std::stod(std::string(i1, i2), &pos); return i1 + static_cast<std::string::difference_type>(pos); }
+        // inline iterator s_to_number(iterator i1, iterator i2, long double& target) { std::size_t pos = 0; target = std::stold(std::string(i1, i2), &pos); return i1 + static_cast<std::string::difference_type>(pos); }
+
+        // template <typename T, typename = void> struct is_s_to_number_defined : public std::false_type {};
+        // template <typename T> struct is_s_to_number_defined<T, u::void_t<decltype(s_to_number(iterator(), iterator(), std::declval<T&>()))>> : public std::true_type {};
+
+        // template <typename T> class parser_number_t AXE_RULE
+        // {
+        //   public:
+        //     inline parser_number_t(T& v) : m(v) {}
+        //     inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+        //     {
+        //         int t;
+        //         auto r = axe::r_decimal(t)(i1, i2);
+        //         m = static_cast<T>(t);
+        //         return r;
+
+        //         // try {
+        //         //     const auto end = s_to_number(i1, i2, m);
+        //         //     return axe::make_result(end > i1, end, i1);
+        //         // }
+        //         // catch (std::invalid_argument&) {
+        //         //     return axe::make_result(false, i1);
+        //         // }
+        //         // catch (std::out_of_range&) {
+        //         //     axe::throw_failure("out of range", i1, i2);
+        //         // }
+        //     }
+        //   private:
+        //     T& m;
+        // };
+
+        // template <typename T, typename std::enable_if<is_s_to_number_defined<T>{}>::type* = nullptr> auto parser_value(T& value)
+        // {
+        //     return parser_number_t<T>(value);
+        // }
+
+          // ----------------------------------------------------------------------
+
+        template <typename T> class parser_float_t AXE_RULE
+        {
+          public:
+            inline parser_float_t(T& v) : m(v) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                auto set_nan = axe::e_ref([this](auto, auto) { m = std::numeric_limits<T>::quiet_NaN(); });
+                return (axe::r_double(m) | (null >> set_nan))(i1, i2);
+            }
+          private:
+            T& m;
+        };
+
+        template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> auto parser_value(T& value, context&)
+        {
+            return parser_float_t<T>(value);
+        }
+
+        template <typename T, typename std::enable_if<std::is_unsigned<T>{}>::type* = nullptr> auto parser_value(T& value, context&)
+        {
+            return axe::r_udecimal(value);
+        }
+
+        template <typename T, typename std::enable_if<std::is_integral<T>{} && std::is_signed<T>{}>::type* = nullptr> auto parser_value(T& value, context&)
+        {
+            return axe::r_decimal(value);
+        }
+
+          // ----------------------------------------------------------------------
+
+        class parser_string_t AXE_RULE
+        {
+          public:
+            inline parser_string_t(std::string& v) : m(v) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                auto clear_target = axe::e_ref([this](auto, auto) { m.clear(); });
+                return ((doublequotes >= (string_content >> m) >= doublequotes) | (null >> clear_target))(i1, i2);
+            }
+          private:
+            std::string& m;
+        };
+
+        inline auto parser_value(std::string& target, context&)
+        {
+            return parser_string_t(target);
+        }
+
+          // repeated values share the pooled string, nothing is allocated for them
+        class parser_interned_t AXE_RULE
+        {
+          public:
+            inline parser_interned_t(interned_string& v, string_pool* p) : m(v), pool(p) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                if (i1 != i2 && *i1 == '"') {
+                    const iterator end = skip_string_rest(i1 + 1, i2);
+                    const auto size = static_cast<size_t>(end - i1 - 2);
+                    if (size == 0)
+                        m = interned_string();
+                    else if (pool)
+                        m = pool->intern(i1 + 1, size);
+                    else
+                        throw failure("interned_string value needs json::interning(pool)", i1, i2);
+                    return axe::make_result(true, end, i1);
+                }
+                const auto null_value = null(i1, i2);
+                if (null_value.matched)
+                    m = interned_string();
+                return null_value;
+            }
+          private:
+            interned_string& m;
+            string_pool* pool;
+        };
+
+        inline auto parser_value(interned_string& target, context& ctx)
+        {
+            return parser_interned_t(target, ctx.strings);
+        }
+
+        class parser_raw_t AXE_RULE
+        {
+          public:
+            inline parser_raw_t(raw_string& v, const context& c) : m(v), ctx(c) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                if (i1 != i2 && *i1 == '"') {
+                    if (ctx.transient_input)
+                        throw failure("raw_string cannot be read from the input fed in chunks", i1, i2);
+                    const iterator end = skip_string_rest(i1 + 1, i2);
+                    m = raw_string(i1 + 1, static_cast<size_t>(end - i1 - 2));
+                    return axe::make_result(true, end, i1);
+                }
+                const auto null_value = null(i1, i2);
+                if (null_value.matched)
+                    m = raw_string();
+                return null_value;
+            }
+          private:
+            raw_string& m;
+            const context& ctx;
+        };
+
+        inline auto parser_value(raw_string& target, context& ctx)
+        {
+            return parser_raw_t(target, ctx);
+        }
+
+          // text of a json string, the only escape base64 text may have is \/
+        inline bool decode_base64(const char* text, size_t size, blob& target)
+        {
+            if (std::memchr(text, '\\', size) != nullptr) {
+                std::string unescaped;
+                for (const char* last = text + size; text != last; ++text) {
+                    if (*text == '\\' && (++text == last || *text != '/'))
+                        return false;
+                    unescaped.append(1, *text);
+                }
+                return decode_base64(unescaped.data(), unescaped.size(), target);
+            }
+            const auto bytes = base64::decoded_size(text, size);
+            if (bytes == std::string::npos)
+                return false;
+            target.resize(bytes); // capacity of the previous value is reused
+            return base64::decode(text, size, target.data());
+        }
+
+        class parser_blob_t AXE_RULE
+        {
+          public:
+            inline parser_blob_t(blob& v) : m(v) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                if (i1 != i2 && *i1 == '"') {
+                    const iterator end = skip_string_rest(i1 + 1, i2);
+                    if (!decode_base64(i1 + 1, static_cast<size_t>(end - i1 - 2), m))
+                        throw failure("invalid base64 text", i1, i2);
+                    return axe::make_result(true, end, i1);
+                }
+                const auto null_value = null(i1, i2);
+                if (null_value.matched)
+                    m.clear();
+                return null_value;
+            }
+          private:
+            blob& m;
+        };
+
+        inline auto parser_value(blob& target, context&)
+        {
+            return parser_blob_t(target);
+        }
+
+        template <typename E> class parser_enum_t AXE_RULE
+        {
+          public:
+            inline parser_enum_t(E& v) : m(v) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                if (i1 == i2 || *i1 != '"')
+                    return axe::make_result(false, i1);
+                const iterator end = skip_string_rest(i1 + 1, i2);
+                if (!enum_names<E>::get().value(i1 + 1, static_cast<size_t>(end - i1 - 2), m))
+                    throw failure("unknown enum value name", i1, end);
+                return axe::make_result(true, end, i1);
+            }
+          private:
+            E& m;
+        };
+
+        template <typename E, typename std::enable_if<u::is_named_enum<E>{}>::type* = nullptr> inline auto parser_value(E& target, context&)
+        {
+            return parser_enum_t<E>(target);
+        }
+
+        class parser_bool_t AXE_RULE
+        {
+          public:
+            inline parser_bool_t(bool& v) : m(v) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                auto yes = axe::e_ref([this](auto, auto) { m = true; });
+                auto no = axe::e_ref([this](auto, auto) { m = false; });
+                return ((axe::r_str("true") >> yes) | (axe::r_str("1") >> yes) | (axe::r_str("false") >> no) | (axe::r_str("0") >> no) | axe::r_fail("true or 1 or false or 0 expected"))(i1, i2);
+            }
+          private:
+            bool& m;
+        };
+
+        inline auto parser_value(bool& target, context&)
+        {
+            return parser_bool_t(target);
+        }
+
+          // ----------------------------------------------------------------------
+          // field_t
+          // ----------------------------------------------------------------------
+
+        template <typename S, typename V> class parser_field_t AXE_RULE
+        {
+          public:
+            inline parser_field_t(S& aS, context& c, V&& aInitial) : mS(aS), ctx(c), mInitial(std::move(aInitial)) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                V v = mInitial;
+                auto r = parser_value(v, ctx)(i1, i2);
+                mS(std::move(v));
+                return r;
+            }
+          private:
+            S mS;
+            context& ctx;
+            V mInitial;
+        };
+
+        template <typename G, typename S, typename P> inline auto parser_value(field_t<G, S, P>& a, context& ctx)
+        {
+            typedef typename field_t<G, S, P>::value_type value_type;
+            value_type initial{};
+            if (ctx.merge_patch) { // patch is applied to the current value
+                try {
+                    initial = a.get();
+                }
+                catch (no_value&) {
+                }
+            }
+            return parser_field_t<S, value_type>(a.setter(), ctx, std::move(initial));
+        }
+
+          // value of json::comment() is output only, it is skipped without materializing
+        class parser_skip_t AXE_RULE
+        {
+          public:
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const { return axe::make_result(true, skip_value(i1, i2), i1); }
+        };
+
+        template <typename S, typename P> inline auto parser_value(_literal_field_t<S, P>&, context&)
+        {
+            return parser_skip_t();
+        }
+
+          // ----------------------------------------------------------------------
+          // object -> struct
+          // ----------------------------------------------------------------------
+
+        template <typename T> inline auto parser_object_item(T& value, context& ctx)
+        {
+            return parser_value(value, ctx);
+        }
+
+        template <typename T> inline auto parser_object_item(T* value, context& ctx)
+        {
+            return parser_value(*value, ctx);
+        }
+
+          // number of fields in the json_fields() tuple which values are read by the parser
+        template <typename Tuple, size_t... Ns> constexpr size_t count_input_fields(std::index_sequence<Ns...>)
+        {
+            const bool input[] = {false, _is_input_field<typename std::tuple_element<Ns * 2 + 1, Tuple>::type>::value...};
+            size_t result = 0;
+            for (auto i: input)
+                result += i;
+            return result;
+        }
+
+        template <typename Tuple> constexpr size_t count_input_fields()
+        {
+            return count_input_fields<Tuple>(std::make_index_sequence<std::tuple_size<Tuple>::value / 2>());
+        }
+
+          // value a member gets when merge patch sets it to null: NaN for floating point (i.e. what null is read as), default otherwise
+        template <typename T> inline void reset_value(T& value, std::false_type) { value = T(); }
+        template <typename T> inline void reset_value(T& value, std::true_type) { value = std::numeric_limits<T>::quiet_NaN(); }
+
+        template <typename T> inline void reset_object_item(T* value)
+        {
+            reset_value(*value, std::is_floating_point<T>());
+        }
+
+        template <typename G, typename S, typename P> inline void reset_object_item(field_t<G, S, P>& a)
+        {
+            typedef typename field_t<G, S, P>::value_type value_type;
+            value_type value{};
+            reset_value(value, std::is_floating_point<value_type>());
+            a.setter()(std::move(value));
+        }
+
+          // i is at the opening doublequotes of the object key, returns position of the value
+        inline iterator object_key(iterator i, iterator i2, iterator& key_first, iterator& key_last)
+        {
+            if (i == i2 || *i != '"')
+                throw failure("object key expected", i, i2);
+            key_first = i + 1;
+            key_last = skip_string_rest(key_first, i2) - 1;
+            const auto after_colon = colon(key_last + 1, i2);
+            if (!after_colon.matched)
+                throw failure("colon expected", key_last + 1, i2);
+            return after_colon.position;
+        }
+
+          // i is after the object item value, moves it to the next key or after the end of the object, returns true for the latter
+        inline bool object_next(iterator& i, iterator i2)
+        {
+            i = skip_space(i, i2);
+            if (i != i2 && *i == '}') {
+                i = skip_space(i + 1, i2);
+                return true;
+            }
+            if (i == i2 || *i != ',')
+                throw failure("comma or object end expected", i, i2);
+            i = skip_space(i + 1, i2);
+            return false;
+        }
+
+          // Looks for the field with the key [key_first, key_last) in the json_fields() tuple starting from
+          // the field number next (keys usually come in the json_fields() order), parses its value, marks it
+          // in seen (input fields only, see count_input_fields()) and sets next to the field after it.
+          // Returns false if there is no such key.
+        template <typename Fields, typename Seen> inline bool parse_object_item(Fields& fields, iterator key_first, iterator key_last, iterator& i1, iterator i2, context& ctx, Seen& seen, size_t& next)
+        {
+            return u::find_field(fields, key_first, static_cast<size_t>(key_last - key_first), [&](size_t index, auto& value) {
+                    const auto match = parser_object_item(value, ctx)(i1, i2);
+                    if (!match.matched)
+                        throw failure("cannot parse value for key \"" + std::string(key_first, key_last) + "\"", i1, i2);
+                    i1 = match.position;
+                    if (_is_input_field<typename std::decay<decltype(value)>::type>::value)
+                        seen.set(index);
+                    next = index + 1;
+                }, next);
+        }
+
+          // merge patch set the field with the key [key_first, key_last) to null. Returns false if there is no such key.
+        template <typename Fields, typename Seen> inline bool reset_object_item(Fields& fields, iterator key_first, iterator key_last, Seen& seen, size_t& next)
+        {
+            return u::find_field(fields, key_first, static_cast<size_t>(key_last - key_first), [&](size_t index, auto& value) {
+                    reset_object_item(value);
+                    if (_is_input_field<typename std::decay<decltype(value)>::type>::value)
+                        seen.set(index);
+                    next = index + 1;
+                }, next);
+        }
+
+        template <typename T> class parser_object_t AXE_RULE
+        {
+          public:
+            inline parser_object_t(T& v, context& c) : m(v), ctx(c) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                JSON_STRUCT_HOOK(object_begin(instrument::parsing, typeid(T)));
+                const auto result = read(i1, i2);
+                JSON_STRUCT_HOOK(object_end(instrument::parsing, typeid(T), result.matched ? static_cast<size_t>(result.position - i1) : 0));
+                return result;
+            }
+
+          private:
+            T& m;
+            context& ctx;
+
+            inline axe::result<iterator> read(iterator i1, iterator i2) const
+            {
+                const auto begin = object_begin(i1, i2);
+                if (!begin.matched)
+                    return axe::make_result(false, i1);
+                iterator i = begin.position;
+                if (i != i2 && *i == '}')
+                    return axe::make_result(true, skip_space(i + 1, i2), i1);
+
+                auto fields = u::call_json_fields(m, false);
+                typedef decltype(fields) fields_type;
+                constexpr size_t number_of_fields = std::tuple_size<fields_type>::value / 2;
+                constexpr size_t number_of_input_fields = count_input_fields<fields_type>();
+                std::bitset<number_of_fields> seen;
+                size_t next = 0;
+                for (;;) {
+                    iterator key_first, key_last;
+                    i = object_key(i, i2, key_first, key_last);
+                    const auto null_value = ctx.merge_patch ? null(i, i2) : axe::make_result(false, i);
+                    bool known;
+                    if (null_value.matched) {
+                        if ((known = reset_object_item(fields, key_first, key_last, seen, next)))
+                            i = null_value.position;
+                    }
+                    else {
+                        known = parse_object_item(fields, key_first, key_last, i, i2, ctx, seen, next);
+                    }
+                    if (known) {
+                        if (ctx.projection && seen.count() == number_of_input_fields) // everything we need is read, the rest of the object is not looked at
+                            return axe::make_result(true, skip_space(skip_nested_rest(i, i2, 1), i2), i1);
+                    }
+                    else if (ctx.ignore_unknown) {
+                        i = skip_value(i, i2);
+                    }
+                    else {
+                        throw failure(std::string("unknown key \"") + std::string(key_first, key_last) + "\"", key_first, i2);
+                    }
+                    if (object_next(i, i2))
+                        return axe::make_result(true, i, i1);
+                }
+            }
+        };
+
+        template <typename T, typename std::enable_if<u::is_json_fields_defined<T>{} || u::is_json_fields_bool_defined<T>{}>::type*> parser_object_t<T> parser_value(T& value, context& ctx)
+        {
+            return parser_object_t<T>(value, ctx);
+        }
+
+          // ----------------------------------------------------------------------
+          // array -> vector, list, set
+          // ----------------------------------------------------------------------
+
+          // flat containers are filled in bulk: items are appended and sorted at the end
+        template <typename C, typename V> inline void add_item(C& container, V&& value) { container.push_back(std::forward<V>(value)); }
+        template <typename T, typename V> inline void add_item(std::set<T>& container, V&& value) { container.insert(std::forward<V>(value)); }
+        template <typename T, typename V> inline void add_item(flat_set<T>& container, V&& value) { container.append(std::forward<V>(value)); }
+
+        template <typename M, typename V> inline void add_member(M& container, std::string&& key, V&& value) { container.emplace(std::move(key), std::forward<V>(value)); }
+        template <typename T, typename V> inline void add_member(flat_map<T>& container, std::string&& key, V&& value) { container.append(std::move(key), std::forward<V>(value)); }
+
+        template <typename C> inline void restore_order(C&) {}
+        template <typename T> inline void restore_order(flat_set<T>& container) { container.restore_order(); }
+        template <typename T> inline void restore_order(flat_map<T>& container) { container.restore_order(); }
+
+        template <typename T> class parser_list_t AXE_RULE
+        {
+          public:
+            typedef typename T::value_type item_type;
+            inline parser_list_t(T& v, context& c) : m(v), ctx(c) {}
+            inline parser_list_t(const parser_list_t<T>& v) = default;
+            virtual inline ~parser_list_t() = default;
+            virtual void add() const = 0;
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                context item_ctx = ctx; // merge patch replaces arrays, their items are plain values
+                item_ctx.merge_patch = false;
+                auto clear_target = axe::e_ref([this](auto, auto) { this->m.clear(); });
+                auto insert_item = axe::e_ref([this](auto, auto) { this->add(); });
+                auto clear_item = axe::e_ref([this](auto, auto) { this->keep = item_type(); });
+                auto item = (axe::r_empty() >> clear_item) & (parser_value(keep, item_ctx) >> insert_item);
+                const auto result = ((array_begin >> clear_target) >= ~( item & *(comma >= item) ) >= array_end)(i1, i2);
+                if (result.matched)
+                    restore_order(m);
+                return result;
+            }
+          protected:
+            T& m;
+            context& ctx;
+            mutable item_type keep;
+        };
+
+        template <typename T> class parser_set_t : public parser_list_t<T>
+        {
+         public:
+            inline parser_set_t(T& v, context& c) : parser_list_t<T>(v, c) {}
+            virtual inline void add() const
+            {
+                JSON_STRUCT_HOOK(element(instrument::parsing));
+                this->m.insert(this->keep);
+            }
+        };
+
+        template <typename T> auto parser_value(std::set<T>& value, context& ctx)
+        {
+            return parser_set_t<std::set<T>>(value, ctx);
+        }
+
+        template <typename T> class parser_flat_set_t : public parser_list_t<T>
+        {
+         public:
+            inline parser_flat_set_t(T& v, context& c) : parser_list_t<T>(v, c) {}
+            virtual inline void add() const
+            {
+                JSON_STRUCT_HOOK(element(instrument::parsing));
+                add_item(this->m, std::move(this->keep));
+            }
+        };
+
+        template <typename T> auto parser_value(flat_set<T>& value, context& ctx)
+        {
+            return parser_flat_set_t<flat_set<T>>(value, ctx);
+        }
+
+        template <typename T> class parser_array_t : public parser_list_t<T>
+        {
+         public:
+            inline parser_array_t(T& v, context& c) : parser_list_t<T>(v, c) {}
+            virtual inline void add() const
+            {
+                JSON_STRUCT_HOOK(element(instrument::parsing));
+                JSON_STRUCT_TRACK_GROWTH(instrument::parsing, typeid(T), this->m, this->m.push_back(this->keep));
+            }
+        };
+
+          // Note use method for arrays only if there is no json_fields(T&) defined
+        template <typename T, typename std::enable_if<u::is_emplace_back_defined<T>{} && !u::is_json_fields_defined<T>{} && !u::is_json_fields_bool_defined<T>{}>::type*> parser_array_t<T> parser_value(T& value, context& ctx)
+        {
+            return parser_array_t<T>(value, ctx);
+        }
+
+          // ----------------------------------------------------------------------
+          // array of numbers -> vector<number>, array -> std::array<T, N>
+          // ----------------------------------------------------------------------
+
+        inline float to_floating(const char* text, char** end, float) { return std::strtof(text, end); }
+        inline double to_floating(const char* text, char** end, double) { return std::strtod(text, end); }
+        inline long double to_floating(const char* text, char** end, long double) { return std::strtold(text, end); }
+
+          // reads number at i without axe rules, returns position after it,
+          // integers out of the range of T are rejected as by json::validate<T>()
+        template <typename T, typename std::enable_if<std::is_integral<T>{}>::type* = nullptr> inline iterator read_number(iterator i, iterator i2, T& target)
+        {
+            const iterator start = i;
+            const bool negative = i != i2 && *i == '-';
+            if (negative) {
+                if (std::is_unsigned<T>{})
+                    throw failure("unsigned number expected", i, i2);
+                ++i;
+            }
+            const uint64_t limit = negative ? static_cast<uint64_t>(-(static_cast<int64_t>(std::numeric_limits<T>::min()) + 1)) + 1 : static_cast<uint64_t>(std::numeric_limits<T>::max());
+            const iterator digits = i;
+            uint64_t value = 0;
+            for (; i != i2 && *i >= '0' && *i <= '9'; ++i) {
+                const auto d = static_cast<uint64_t>(*i - '0');
+                if (value > (limit - d) / 10)
+                    throw failure("number out of range", start, i2);
+                value = value * 10 + d;
+            }
+            if (i == digits)
+                throw failure("number expected", digits, i2);
+            target = static_cast<T>(negative ? uint64_t(0) - value : value);
+            return i;
+        }
+
+        template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> inline iterator read_number(iterator i, iterator i2, T& target)
+        {
+            if (i2 - i >= 4 && std::memcmp(i, "null", 4) == 0) {
+                target = std::numeric_limits<T>::quiet_NaN();
+                return i + 4;
+            }
+            iterator last = i;
+            while (last != i2 && ((*last >= '0' && *last <= '9') || *last == '-' || *last == '+' || *last == '.' || *last == 'e' || *last == 'E'))
+                ++last;
+            const auto size = static_cast<size_t>(last - i);
+              // source text is not terminated, the number is copied
+            char buffer[64];
+            std::string long_number;
+            char* text = buffer;
+            if (size >= sizeof(buffer)) {
+                long_number.assign(i, last);
+                text = &long_number[0];
+            }
+            else {
+                std::memcpy(buffer, i, size);
+                buffer[size] = 0;
+            }
+            char* end = nullptr;
+            target = to_floating(text, &end, T());
+            if (size == 0 || end != text + size)
+                throw failure("number expected", i, i2);
+            return last;
+        }
+
+        template <typename T, typename std::enable_if<u::is_number<T>{}>::type* = nullptr> inline iterator read_item(iterator i, iterator i2, T& target, context&)
+        {
+            return read_number(i, i2, target);
+        }
+
+        template <typename T, typename std::enable_if<!u::is_number<T>{}>::type* = nullptr> inline iterator read_item(iterator i, iterator i2, T& target, context& ctx)
+        {
+            const auto match = parser_value(target, ctx)(i, i2);
+            if (!match.matched)
+                throw failure("cannot parse array element", i, i2);
+            return match.position;
+        }
+
+          // [item, item, ...] at i1, read(index, i) reads item at i and returns position after it
+        template <typename Read> inline axe::result<iterator> read_array(iterator i1, iterator i2, Read read)
+        {
+            iterator i = skip_space(i1, i2);
+            if (i == i2 || *i != '[')
+                return axe::make_result(false, i1);
+            i = skip_space(i + 1, i2);
+            if (i != i2 && *i == ']')
+                return axe::make_result(true, skip_space(i + 1, i2), i1);
+            for (size_t index = 0; ; ++index) {
+                JSON_STRUCT_HOOK(element(instrument::parsing));
+                i = skip_space(read(index, i), i2);
+                if (i != i2 && *i == ']')
+                    return axe::make_result(true, skip_space(i + 1, i2), i1);
+                if (i == i2 || *i != ',')
+                    throw failure("comma or array end expected", i, i2);
+                i = skip_space(i + 1, i2);
+            }
+        }
+
+          // number of items in the array of numbers at i (just after [), used to reserve storage: items are
+          // counted up to the array end or anything that cannot be in an array of numbers, an empty item
+          // (e.g. [,,,]) stops counting, i.e. malformed input reserves no more than valid input of its size
+        inline size_t count_numbers(iterator i, iterator i2)
+        {
+            size_t count = 0;
+            bool item = false;  // number (or null) since the last comma
+            for (; i != i2; ++i) {
+                switch (*i) {
+                  case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+                  case '-': case '+': case '.': case 'e': case 'E': case 'n': case 'u': case 'l':
+                      item = true;
+                      break;
+                  case ',':
+                      if (!item)
+                          return count;
+                      ++count;
+                      item = false;
+                      break;
+                  case ']':
+                      return item ? count + 1 : count;
+                  case ' ': case '\t': case '\n': case '\r':
+                      break;
+                  default:
+                      return count;
+                }
+            }
+            return count;
+        }
+
+        template <typename T> class parser_numbers_t AXE_RULE
+        {
+          public:
+            inline parser_numbers_t(std::vector<T>& v) : m(v) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                const iterator begin = skip_space(i1, i2);
+                if (begin != i2 && *begin == '[') {
+                    m.clear();
+                    m.reserve(count_numbers(begin + 1, i2));
+                }
+                return read_array(i1, i2, [this, i2](size_t, iterator i) {
+                        T value;
+                        i = read_number(i, i2, value);
+                        JSON_STRUCT_TRACK_GROWTH(instrument::parsing, typeid(std::vector<T>), m, m.push_back(value));
+                        return i;
+                    });
+            }
+          private:
+            std::vector<T>& m;
+        };
+
+        template <typename T, typename std::enable_if<u::is_number<T>{}>::type*> auto parser_value(std::vector<T>& value, context&)
+        {
+            return parser_numbers_t<T>(value);
+        }
+
+          // exactly N items are expected
+        template <typename T, size_t N> class parser_std_array_t AXE_RULE
+        {
+          public:
+            inline parser_std_array_t(std::array<T, N>& v, context& c) : m(v), ctx(c) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                context item_ctx = ctx; // merge patch replaces arrays, their items are plain values
+                item_ctx.merge_patch = false;
+                size_t size = 0;
+                const auto result = read_array(i1, i2, [this, i2, &item_ctx, &size](size_t index, iterator i) {
+                        if (index >= N)
+                            throw failure("too many array elements, " + std::to_string(N) + " expected", i, i2);
+                        size = index + 1;
+                        return read_item(i, i2, m[index], item_ctx);
+                    });
+                if (result.matched && size != N)
+                    throw failure(std::to_string(size) + " array elements found, " + std::to_string(N) + " expected", i1, i2);
+                return result;
+            }
+          private:
+            std::array<T, N>& m;
+            context& ctx;
+        };
+
+        template <typename T, size_t N> auto parser_value(std::array<T, N>& value, context& ctx)
+        {
+            return parser_std_array_t<T, N>(value, ctx);
+        }
+
+          // ----------------------------------------------------------------------
+          // object -> map<string, T>, unordered_map<string, T>, flat_map<T>
+          // ----------------------------------------------------------------------
+
+          // number of members of the object at i, values are skipped without parsing, 0 if text is not an object
+        inline size_t count_members(iterator i, iterator i2)
+        {
+            try {
+                i = skip_space(i, i2);
+                if (i == i2 || *i != '{')
+                    return 0;
+                i = skip_space(i + 1, i2);
+                if (i != i2 && *i == '}')
+                    return 0;
+                for (size_t count = 1; ; ++count) {
+                    iterator key_first, key_last;
+                    i = skip_value(object_key(i, i2, key_first, key_last), i2);
+                    if (object_next(i, i2))
+                        return count;
+                }
+            }
+            catch (failure&) { // reported by the parser
+                return 0;
+            }
+        }
+
+          // hash table is sized before filling to avoid rehashing
+        template <typename M> inline void reserve_members(M&, iterator, iterator) {}
+        template <typename T> inline void reserve_members(std::unordered_map<std::string, T>& target, iterator i1, iterator i2) { target.reserve(count_members(i1, i2)); }
+
+        template <typename T> inline auto parser_map_item(std::string& key, T& value, context& ctx)
+        {
+            return doublequotes >= (string_content >> key) >= doublequotes >= colon >= parser_value(value, ctx);
+        }
+
+        template <typename T> class parser_map_t AXE_RULE
+        {
+          public:
+            typedef typename T::mapped_type item_type;
+            inline parser_map_t(T& v, context& c) : m(v), ctx(c) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                if (ctx.merge_patch)
+                    return merge(i1, i2);
+                auto clear_target = axe::e_ref([this, i1, i2](auto, auto) { m.clear(); reserve_members(m, i1, i2); });
+                auto insert_item = axe::e_ref([this](auto, auto) { JSON_STRUCT_HOOK(element(instrument::parsing)); add_member(m, std::move(keep_key), std::move(keep_value)); });
+                auto clear_item = axe::e_ref([this](auto, auto) { this->keep_value = item_type(); });
+                auto item = (axe::r_empty() >> clear_item) & (parser_map_item(keep_key, keep_value, ctx) >> insert_item);
+                const auto result = ((object_begin >> clear_target) >= ~( item & *(comma >= item) ) >= object_end)(i1, i2);
+                if (result.matched)
+                    restore_order(m);
+                return result;
+            }
+          private:
+            T& m;
+            context& ctx;
+            mutable std::string keep_key;
+            mutable item_type keep_value;
+
+              // merge patch: existing entries are kept, null removes the entry, other values are merged into the entry
+            inline axe::result<iterator> merge(iterator i1, iterator i2) const
+            {
+                const auto begin = object_begin(i1, i2);
+                if (!begin.matched)
+                    return axe::make_result(false, i1);
+                iterator i = begin.position;
+                if (i != i2 && *i == '}')
+                    return axe::make_result(true, skip_space(i + 1, i2), i1);
+                for (;;) {
+                    iterator key_first, key_last;
+                    i = object_key(i, i2, key_first, key_last);
+                    keep_key.assign(key_first, key_last);
+                    const auto null_value = null(i, i2);
+                    if (null_value.matched) {
+                        m.erase(keep_key);
+                        i = null_value.position;
+                    }
+                    else {
+                        const auto match = parser_value(m[keep_key], ctx)(i, i2);
+                        if (!match.matched)
+                            throw failure("cannot parse value for key \"" + keep_key + "\"", i, i2);
+                        i = match.position;
+                    }
+                    if (object_next(i, i2))
+                        return axe::make_result(true, i, i1);
+                }
+            }
+        };
+
+        template <typename T> auto parser_value(std::map<std::string, T>& value, context& ctx)
+        {
+            return parser_map_t<std::map<std::string, T>>(value, ctx);
+        }
+
+        template <typename T> auto parser_value(std::unordered_map<std::string, T>& value, context& ctx)
+        {
+            return parser_map_t<std::unordered_map<std::string, T>>(value, ctx);
+        }
+
+        template <typename T> auto parser_value(flat_map<T>& value, context& ctx)
+        {
+            return parser_map_t<flat_map<T>>(value, ctx);
+        }
+
+          // ----------------------------------------------------------------------
+          // object of arrays -> vector of objects (json::columnar)
+          // ----------------------------------------------------------------------
+
+          // number of items in the array at i, values are skipped without parsing
+        inline size_t count_items(iterator i, iterator i2)
+        {
+            i = skip_space(i, i2);
+            if (i == i2 || *i != '[')
+                return 0;
+            i = skip_space(i + 1, i2);
+            if (i != i2 && *i == ']')
+                return 0;
+            for (size_t count = 1; ; ++count) {
+                i = skip_space(skip_value(i, i2), i2);
+                if (i == i2 || *i != ',')
+                    return count;
+                i = skip_space(i + 1, i2);
+            }
+        }
+
+        template <typename V, typename std::enable_if<u::is_number<V>{}>::type* = nullptr> inline size_t column_size(iterator i, iterator i2, V*)
+        {
+            const iterator first = skip_space(i, i2);
+            if (first == i2 || *first != '[')
+                return 0;
+            const iterator item = skip_space(first + 1, i2);
+            return item != i2 && *item == ']' ? 0 : count_numbers(item, i2);
+        }
+
+        template <typename V, typename std::enable_if<!u::is_number<V>{}>::type* = nullptr> inline size_t column_size(iterator i, iterator i2, V*) { return count_items(i, i2); }
+        template <typename G, typename S, typename P> inline size_t column_size(iterator i, iterator i2, const field_t<G, S, P>&) { return count_items(i, i2); }
+
+        template <typename V> inline iterator read_column_item(iterator i, iterator i2, V* target, context& ctx)
+        {
+            return read_item(i, i2, *target, ctx);
+        }
+
+          // null is written for json::no_value, the setter is not called
+        template <typename G, typename S, typename P> inline iterator read_column_item(iterator i, iterator i2, field_t<G, S, P>& target, context& ctx)
+        {
+            if (i2 - i >= 4 && std::memcmp(i, "null", 4) == 0)
+                return i + 4;
+            typename field_t<G, S, P>::value_type value{};
+            i = read_item(i, i2, value, ctx);
+            target.setter()(std::move(value));
+            return i;
+        }
+
+        template <typename S, typename P> inline iterator read_column_item(iterator i, iterator i2, _literal_field_t<S, P>&, context&)
+        {
+            return skip_value(i, i2);
+        }
+
+          // reads the array at i into the field number K of items, the first array read sets the number of items
+        template <size_t K, typename T, typename F> inline iterator read_column(iterator i, iterator i2, F& prototype, std::vector<T>& items, bool& sized, context& ctx)
+        {
+            if (!sized) {
+                items.resize(column_size(i, i2, prototype));
+                sized = true;
+            }
+            size_t size = 0;
+            const auto result = read_array(i, i2, [&items, &size, i2, &ctx](size_t index, iterator at) {
+                    if (index >= items.size())
+                        throw failure("columns of different sizes", at, i2);
+                    size = index + 1;
+                    auto fields = u::call_json_fields(items[index], false);
+                    return read_column_item(at, i2, std::get<2 * K + 1>(fields), ctx);
+                });
+            if (!result.matched)
+                throw failure("array expected", i, i2);
+            if (size != items.size())
+                throw failure("columns of different sizes", i, i2);
+            return result.position;
+        }
+
+        template <typename T> class parser_columns_t AXE_RULE
+        {
+          public:
+            inline parser_columns_t(columns<T>& v, context& c) : m(v), ctx(c) {}
+            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
+            {
+                const auto begin = object_begin(i1, i2);
+                if (!begin.matched)
+                    return axe::make_result(false, i1);
+                std::vector<T>& items = m.parsed();
+                iterator i = begin.position;
+                if (i != i2 && *i == '}')
+                    return axe::make_result(true, skip_space(i + 1, i2), i1);
+
+                context item_ctx = ctx; // merge patch replaces the whole vector
+                item_ctx.merge_patch = false;
+                T prototype{};
+                auto fields = u::call_json_fields(prototype, false);
+                bool sized = false;
+                size_t next = 0;
+                for (;;) {
+                    iterator key_first, key_last;
+                    i = object_key(i, i2, key_first, key_last);
+                    const bool known = u::find_field(fields, key_first, static_cast<size_t>(key_last - key_first), [&](auto index, auto& field) {
+                            i = read_column<decltype(index)::value>(i, i2, field, items, sized, item_ctx);
+                            next = index + 1;
+                        }, next);
+                    if (!known) {
+                        if (!ctx.ignore_unknown)
+                            throw failure(std::string("unknown key \"") + std::string(key_first, key_last) + "\"", key_first, i2);
+                        i = skip_value(i, i2);
+                    }
+                    if (object_next(i, i2))
+                        return axe::make_result(true, i, i1);
+                }
+            }
+          private:
+            columns<T>& m;
+            context& ctx;
+        };
+
+        template <typename T> auto parser_value(columns<T>& value, context& ctx)
+        {
+            return parser_columns_t<T>(value, ctx);
+        }
+
+          // ----------------------------------------------------------------------
+
+        template <typename T> inline void parse(iterator first, iterator last, T& target, context& ctx)
+        {
+            JSON_STRUCT_PROBE(document_start, instrument::parsing, last - first);
+            JSON_STRUCT_HOOK(document_begin(instrument::parsing, typeid(T)));
+            auto parser = parser_value(target, ctx);
+            try {
+                parser(first, last);
+            }
+            catch (failure& err) {
+                JSON_STRUCT_HOOK(document_end(instrument::parsing, typeid(T), 0));
+                throw parsing_error(err.message(first));
+            }
+            catch (axe::failure<char>& err) {
+                JSON_STRUCT_HOOK(document_end(instrument::parsing, typeid(T), 0));
+                throw parsing_error(err.message());
+            }
+            JSON_STRUCT_HOOK(document_end(instrument::parsing, typeid(T), static_cast<size_t>(last - first)));
+            JSON_STRUCT_PROBE(document_end, instrument::parsing, last - first);
+        }
+    }
+
+      // ----------------------------------------------------------------------
+
+    template <typename T> inline void parse(const char* first, const char* last, T& target)
+    {
+        r::context ctx;
+        r::parse(first, last, target, ctx);
+    }
+
+      // keys not listed in json_fields() are skipped with their values
+    template <typename T> inline void parse(const char* first, const char* last, T& target, ignore_unknown_t)
+    {
+        r::context ctx;
+        ctx.ignore_unknown = true;
+        r::parse(first, last, target, ctx);
+    }
+
+      // reads just the fields listed in json_fields() from a (much larger) document,
+      // the rest of an object is skipped as soon as all its fields are read
+    template <typename T> inline void parse(const char* first, const char* last, T& target, projection_t)
+    {
+        r::context ctx;
+        ctx.ignore_unknown = ctx.projection = true;
+        r::parse(first, last, target, ctx);
+    }
+
+      // interned_string values are added to the given pool
+    template <typename T> inline void parse(const char* first, const char* last, T& target, interning_t interning)
+    {
+        r::context ctx;
+        ctx.strings = interning.pool;
+        r::parse(first, last, target, ctx);
+    }
+
+    template <typename T, typename... Option> inline void parse(const std::string& source, T& target, Option... option)
+    {
+        parse(source.data(), source.data() + source.size(), target, option...);
+    }
+
+      // raw_string values of target would point into the temporary source
+    template <typename T, typename... Option> inline void parse(std::string&& source, T& target, Option... option)
+    {
+        static_assert(!u::has_raw_string<T>::value, "json::parse: target has raw_string values, source must outlive them and cannot be a temporary");
+        parse(source.data(), source.data() + source.size(), target, option...);
+    }
+
+      // applies RFC 7386 merge patch (see json::dump_diff) to target: just the members mentioned in the patch are changed,
+      // null removes map entry or resets field, arrays are replaced
+    template <typename T> inline void apply_patch(T& target, const char* first, const char* last)
+    {
+        r::context ctx;
+        ctx.merge_patch = true;
+        r::parse(first, last, target, ctx);
+    }
+
+      // interned_string values of the patch are added to the given pool
+    template <typename T> inline void apply_patch(T& target, const char* first, const char* last, interning_t interning)
+    {
+        r::context ctx;
+        ctx.merge_patch = true;
+        ctx.strings = interning.pool;
+        r::parse(first, last, target, ctx);
+    }
+
+    template <typename T, typename... Option> inline void apply_patch(T& target, const std::string& patch, Option... option)
+    {
+        apply_patch(target, patch.data(), patch.data() + patch.size(), option...);
+    }
+
+    template <typename T, typename... Option> inline void apply_patch(T& target, std::string&& patch, Option... option)
+    {
+        static_assert(!u::has_raw_string<T>::value, "json::apply_patch: target has raw_string values, patch must outlive them and cannot be a temporary");
+        apply_patch(target, patch.data(), patch.data() + patch.size(), option...);
+    }
+
+      // ----------------------------------------------------------------------
+      // push parser: input is fed in chunks as it arrives, position in the
+      // document is kept in the stack of frames (one per open object or array)
+      // ----------------------------------------------------------------------
+
+    namespace r
+    {
+          // open object, array or map being read
+        class frame
+        {
+         public:
+            virtual inline ~frame() = default;
+              // key of the next value (objects and maps)
+            virtual void key(iterator first, iterator last) = 0;
+              // the next value is complete scalar: string with doublequotes, number, true, false, null
+            virtual void scalar(iterator first, iterator last) = 0;
+              // the next value is object ('{') or array ('['), returns frame to read it
+            virtual std::unique_ptr<frame> open(char bracket) = 0;
+              // end of the object or array
+            virtual inline void close() {}
+        };
+
+        template <typename Parser> inline void match_scalar(const Parser& parser, iterator first, iterator last)
+        {
+            const auto match = parser(first, last);
+            if (!match.matched || match.position != last)
+                throw failure("unexpected value", first, last);
+        }
+
+        template <typename T, typename std::enable_if<u::is_object<T>{}>::type* = nullptr> std::unique_ptr<frame> open_frame(T& target, context& ctx, char bracket);
+        template <typename T, typename std::enable_if<u::is_emplace_back_defined<T>{} && !u::is_object<T>{}>::type* = nullptr> std::unique_ptr<frame> open_frame(T& target, context& ctx, char bracket);
+        template <typename T, typename std::enable_if<u::is_array<T>{} && !u::is_emplace_back_defined<T>{}>::type* = nullptr> std::unique_ptr<frame> open_frame(T& target, context& ctx, char bracket);
+        template <typename T, size_t N> std::unique_ptr<frame> open_frame(std::array<T, N>& target, context& ctx, char bracket);
+        template <typename T, typename std::enable_if<u::is_map<T>{}>::type* = nullptr> std::unique_ptr<frame> open_frame(T& target, context& ctx, char bracket);
+        template <typename T> std::unique_ptr<frame> open_frame(cached<T>& target, context& ctx, char bracket);
+        template <typename T, typename std::enable_if<std::is_arithmetic<T>{}>::type* = nullptr> std::unique_ptr<frame> open_frame(T& target, context& ctx, char bracket);
+        std::unique_ptr<frame> open_frame(std::string& target, context& ctx, char bracket);
+        std::unique_ptr<frame> open_frame(interned_string& target, context& ctx, char bracket);
+        std::unique_ptr<frame> open_frame(raw_string& target, context& ctx, char bracket);
+        std::unique_ptr<frame> open_frame(blob& target, context& ctx, char bracket);
+        template <typename T> std::unique_ptr<frame> open_frame(columns<T>& target, context& ctx, char bracket);
+        template <typename E, typename std::enable_if<u::is_named_enum<E>{}>::type* = nullptr> std::unique_ptr<frame> open_frame(E& target, context& ctx, char bracket);
+
+          // ----------------------------------------------------------------------
+
+          // values of unknown keys (with ignore_unknown)
+        class skip_frame : public frame
+        {
+         public:
+            virtual inline void key(iterator, iterator) {}
+            virtual inline void scalar(iterator, iterator) {}
+            virtual inline std::unique_ptr<frame> open(char) { return std::make_unique<skip_frame>(); }
+        };
+
+          // value read into a temporary which is passed to done() on close, used for set items and fields with setter
+        template <typename V, typename Done> class value_frame : public frame
+        {
+         public:
+            inline value_frame(context& ctx, char bracket, Done&& aDone) : value{}, inner(open_frame(value, ctx, bracket)), done(std::move(aDone)) {}
+            virtual inline void key(iterator first, iterator last) { inner->key(first, last); }
+            virtual inline void scalar(iterator first, iterator last) { inner->scalar(first, last); }
+            virtual inline std::unique_ptr<frame> open(char bracket) { return inner->open(bracket); }
+            virtual inline void close() { inner->close(); done(value); }
+
+         private:
+            V value;
+            std::unique_ptr<frame> inner;
+            Done done;
+        };
+
+        template <typename V, typename Done> inline std::unique_ptr<frame> make_value_frame(context& ctx, char bracket, Done&& done)
+        {
+            return std::make_unique<value_frame<V, Done>>(ctx, bracket, std::forward<Done>(done));
+        }
+
+          // the top level value
+        template <typename T> class root_frame : public frame
+        {
+         public:
+            inline root_frame(T& target, context& c) : m(target), ctx(c) {}
+            virtual inline void key(iterator first, iterator last) { throw failure("unexpected key", first, last); }
+            virtual inline void scalar(iterator first, iterator last) { match_scalar(parser_value(m, ctx), first, last); }
+            virtual inline std::unique_ptr<frame> open(char bracket) { return open_frame(m, ctx, bracket); }
+
+         private:
+            T& m;
+            context& ctx;
+        };
+
+          // ----------------------------------------------------------------------
+
+        template <typename T> inline std::unique_ptr<frame> open_field(T* value, context& ctx, char bracket)
+        {
+            return open_frame(*value, ctx, bracket);
+        }
+
+        template <typename G, typename S, typename P> inline std::unique_ptr<frame> open_field(field_t<G, S, P>& value, context& ctx, char bracket)
+        {
+            typedef typename field_t<G, S, P>::value_type value_type;
+            auto setter = value.setter();
+            return make_value_frame<value_type>(ctx, bracket, [setter](value_type& v) { setter(std::move(v)); });
+        }
+
+        template <typename T> class object_frame : public frame
+        {
+         public:
+            inline object_frame(T& target, context& c) : fields(u::call_json_fields(target, false)), ctx(c), next(0) {}
+
+            virtual inline void key(iterator first, iterator last) { pending_key.assign(first, last); }
+
+            virtual inline void scalar(iterator first, iterator last)
+                {
+                    if (!u::find_field(fields, pending_key.data(), pending_key.size(), [&](size_t index, auto& value) { match_scalar(parser_object_item(value, ctx), first, last); next = index + 1; }, next))
+                        unknown_key(first, last);
+                }
+
+            virtual inline std::unique_ptr<frame> open(char bracket)
+                {
+                    std::unique_ptr<frame> result;
+                    if (!u::find_field(fields, pending_key.data(), pending_key.size(), [&](size_t index, auto& value) { result = open_field(value, ctx, bracket); next = index + 1; }, next)) {
+                        unknown_key(pending_key.data(), pending_key.data() + pending_key.size());
+                        result = std::make_unique<skip_frame>();
+                    }
+                    return result;
+                }
+
+         private:
+            decltype(u::call_json_fields(std::declval<T&>(), false)) fields;
+            context& ctx;
+            std::string pending_key;
+            size_t next;  // field expected next
+
+            inline void unknown_key(iterator first, iterator last) const
+                {
+                    if (!ctx.ignore_unknown)
+                        throw failure("unknown key \"" + pending_key + "\"", first, last);
+                }
+        };
+
+          // vector, list, set, flat_set, cleared on open as by parser_list_t
+        template <typename C> class array_frame : public frame
+        {
+         public:
+            typedef typename C::value_type item_type;
+            inline array_frame(C& target, context& c) : m(target), ctx(c) { m.clear(); }
+            virtual inline void key(iterator first, iterator last) { throw failure("unexpected key", first, last); }
+
+            virtual inline void scalar(iterator first, iterator last)
+                {
+                    item_type item{};
+                    match_scalar(parser_value(item, ctx), first, last);
+                    add_item(m, std::move(item));
+                }
+
+            virtual inline std::unique_ptr<frame> open(char bracket)
+                {
+                    C& target = m;
+                    return make_value_frame<item_type>(ctx, bracket, [&target](item_type& item) { add_item(target, std::move(item)); });
+                }
+
+            virtual inline void close() { restore_order(m); }
+
+         private:
+            C& m;
+            context& ctx;
+        };
+
+          // std::array, items are read in place, exactly N of them are expected
+        template <typename T, size_t N> class std_array_frame : public frame
+        {
+         public:
+            inline std_array_frame(std::array<T, N>& target, context& c) : m(target), ctx(c), size(0) {}
+            virtual inline void key(iterator first, iterator last) { throw failure("unexpected key", first, last); }
+            virtual inline void scalar(iterator first, iterator last) { match_scalar(parser_value(next(), ctx), first, last); }
+            virtual inline std::unique_ptr<frame> open(char bracket) { return open_frame(next(), ctx, bracket); }
+
+            virtual inline void close()
+                {
+                    if (size != N)
+                        throw failure(std::to_string(size) + " array elements found, " + std::to_string(N) + " expected");
+                }
+
+         private:
+            std::array<T, N>& m;
+            context& ctx;
+            size_t size;
+
+            inline T& next()
+                {
+                    if (size == N)
+                        throw failure("too many array elements, " + std::to_string(N) + " expected");
+                    return m[size++];
+                }
+        };
+
+        template <typename T> class map_frame : public frame
+        {
+         public:
+            typedef typename T::mapped_type item_type;
+            inline map_frame(T& target, context& c) : m(target), ctx(c) { m.clear(); }
+
+            virtual inline void key(iterator first, iterator last) { pending_key.assign(first, last); }
+
+            virtual inline void scalar(iterator first, iterator last)
+                {
+                    item_type item{};
+                    match_scalar(parser_value(item, ctx), first, last);
+                    add_member(m, std::move(pending_key), std::move(item));
+                }
+
+            virtual inline std::unique_ptr<frame> open(char bracket)
+                {
+                    T& target = m;
+                    return make_value_frame<item_type>(ctx, bracket, [&target, key = std::move(pending_key)](item_type& item) mutable { add_member(target, std::move(key), std::move(item)); });
+                }
+
+            virtual inline void close() { restore_order(m); }
+
+         private:
+            T& m;
+            context& ctx;
+            std::string pending_key;
+        };
+
+          // one array of json::columnar, the first one read adds items, the others must have the same number of them
+        template <typename T, size_t K> class column_frame : public frame
+        {
+         public:
+            inline column_frame(std::vector<T>& target, bool& aSized, context& c) : m(target), sized(aSized), ctx(c), size(0) {}
+            virtual inline void key(iterator first, iterator last) { throw failure("unexpected key", first, last); }
+
+            virtual inline void scalar(iterator first, iterator last)
+                {
+                    auto fields = u::call_json_fields(next(), false);
+                    if (read_column_item(first, last, std::get<2 * K + 1>(fields), ctx) != last)
+                        throw failure("unexpected value", first, last);
+                }
+
+            virtual inline std::unique_ptr<frame> open(char bracket)
+                {
+                    auto fields = u::call_json_fields(next(), false);
+                    return open_field(std::get<2 * K + 1>(fields), ctx, bracket);
+                }
+
+            virtual inline void close()
+                {
+                    if (sized && size != m.size())
+                        throw failure("columns of different sizes");
+                    sized = true;
+                }
+
+         private:
+            std::vector<T>& m;
+            bool& sized;
+            context& ctx;
+            size_t size;
+
+            inline T& next()
+                {
+                    if (!sized) {
+                        m.emplace_back();
+                        return m[size++];
+                    }
+                    if (size == m.size())
+                        throw failure("columns of different sizes");
+                    return m[size++];
+                }
+        };
+
+        template <size_t K, typename T, typename F> inline std::unique_ptr<frame> open_column(const F&, std::vector<T>& items, bool& sized, context& ctx)
+        {
+            return std::make_unique<column_frame<T, K>>(items, sized, ctx);
+        }
+
+        template <size_t K, typename T, typename S, typename P> inline std::unique_ptr<frame> open_column(const _literal_field_t<S, P>&, std::vector<T>&, bool&, context&)
+        {
+            return std::make_unique<skip_frame>();
+        }
+
+          // json::columnar, parsed items are kept in target until the frame of the field moves them to the field
+        template <typename T> class columns_frame : public frame
+        {
+         public:
+            inline columns_frame(columns<T>& target, context& c) : items(target.parsed()), fields(u::call_json_fields(prototype, false)), ctx(c), sized(false), next(0) {}
+
+            virtual inline void key(iterator first, iterator last) { pending_key.assign(first, last); }
+            virtual inline void scalar(iterator, iterator) { throw failure("array expected"); }
+
+            virtual inline std::unique_ptr<frame> open(char bracket)
+                {
+                    std::unique_ptr<frame> result;
+                    if (!u::find_field(fields, pending_key.data(), pending_key.size(), [&](auto index, auto& value) { if (bracket != '[') throw failure("array expected"); result = open_column<decltype(index)::value>(value, items, sized, ctx); next = index + 1; }, next)) {
+                        if (!ctx.ignore_unknown)
+                            throw failure("unknown key \"" + pending_key + "\"");
+                        result = std::make_unique<skip_frame>();
+                    }
+                    return result;
+                }
+
+         private:
+            std::vector<T>& items;
+            T prototype;
+            decltype(u::call_json_fields(std::declval<T&>(), false)) fields;
+            context& ctx;
+            std::string pending_key;
+            bool sized;
+            size_t next;  // field expected next
+        };
+
+          // ----------------------------------------------------------------------
+
+        inline void check_bracket(char bracket, char expected)
+        {
+            if (bracket != expected)
+                throw failure(std::string(expected == '{' ? "object" : "array") + " expected");
+        }
+
+        template <typename T, typename std::enable_if<u::is_object<T>{}>::type*> inline std::unique_ptr<frame> open_frame(T& target, context& ctx, char bracket)
+        {
+            check_bracket(bracket, '{');
+            return std::make_unique<object_frame<T>>(target, ctx);
+        }
+
+        template <typename T, typename std::enable_if<u::is_emplace_back_defined<T>{} && !u::is_object<T>{}>::type*> inline std::unique_ptr<frame> open_frame(T& target, context& ctx, char bracket)
+        {
+            check_bracket(bracket, '[');
+            return std::make_unique<array_frame<T>>(target, ctx);
+        }
+
+        template <typename T, typename std::enable_if<u::is_array<T>{} && !u::is_emplace_back_defined<T>{}>::type*> inline std::unique_ptr<frame> open_frame(T& target, context& ctx, char bracket)
+        {
+            check_bracket(bracket, '[');
+            return std::make_unique<array_frame<T>>(target, ctx);
+        }
+
+        template <typename T, size_t N> inline std::unique_ptr<frame> open_frame(std::array<T, N>& target, context& ctx, char bracket)
+        {
+            check_bracket(bracket, '[');
+            return std::make_unique<std_array_frame<T, N>>(target, ctx);
+        }
+
+        template <typename T, typename std::enable_if<u::is_map<T>{}>::type*> inline std::unique_ptr<frame> open_frame(T& target, context& ctx, char bracket)
+        {
+            check_bracket(bracket, '{');
+            return std::make_unique<map_frame<T>>(target, ctx);
+        }
+
+        template <typename T> inline std::unique_ptr<frame> open_frame(cached<T>& target, context& ctx, char bracket)
+        {
+            return open_frame(target.modify(), ctx, bracket);
+        }
+
+        template <typename T, typename std::enable_if<std::is_arithmetic<T>{}>::type*> inline std::unique_ptr<frame> open_frame(T&, context&, char)
+        {
+            throw failure("number expected");
+        }
+
+        inline std::unique_ptr<frame> open_frame(std::string&, context&, char)
+        {
+            throw failure("string expected");
+        }
+
+        inline std::unique_ptr<frame> open_frame(interned_string&, context&, char)
+        {
+            throw failure("string expected");
+        }
+
+        inline std::unique_ptr<frame> open_frame(raw_string&, context&, char)
+        {
+            throw failure("string expected");
+        }
+
+        inline std::unique_ptr<frame> open_frame(blob&, context&, char)
+        {
+            throw failure("base64 string expected");
+        }
+
+        template <typename T> inline std::unique_ptr<frame> open_frame(columns<T>& target, context& ctx, char bracket)
+        {
+            check_bracket(bracket, '{');
+            return std::make_unique<columns_frame<T>>(target, ctx);
+        }
+
+        template <typename E, typename std::enable_if<u::is_named_enum<E>{}>::type*> inline std::unique_ptr<frame> open_frame(E&, context&, char)
+        {
+            throw failure("enum value name expected");
+        }
+
+          // ----------------------------------------------------------------------
+
+          // splits fed chunks into tokens, incomplete token at the end of a chunk is kept until the next one
+        class push_reader
+        {
+         public:
+            inline push_reader(std::unique_ptr<frame>&& root) : state(state_t::value), escape_pending(false), offset(0) { stack.push_back(std::move(root)); }
+
+            inline bool done() const { return state == state_t::done; }
+
+            inline void feed(const char* data, size_t size)
+                {
+                    iterator i = data;
+                    const iterator end = data + size;
+                    try {
+                        while (i != end)
+                            i = step(i, end);
+                    }
+                    catch (failure& err) {
+                        throw parsing_error(std::string(err.what()) + " at offset " + std::to_string(offset + static_cast<size_t>(i - data)));
+                    }
+                    catch (axe::failure<char>& err) {
+                        throw parsing_error(err.message());
+                    }
+                    offset += size;
+                }
+
+            inline void finish()
+                {
+                    if (state == state_t::literal) { // number or literal at the very end
+                        state = state_t::value;
+                        scalar(token.data(), token.data() + token.size());
+                    }
+                    if (state != state_t::done)
+                        throw parsing_error("unexpected end of input at offset " + std::to_string(offset));
+                }
+
+         private:
+            enum class state_t { value, first_key, key, colon, first_item, value_end, string, key_string, literal, done };
+
+            std::vector<std::unique_ptr<frame>> stack;
+            std::string brackets;      // opening brackets of the frames above root
+            std::string token;         // incomplete token from the previous chunks
+            state_t state;
+            bool escape_pending;       // chunk ended with backslash inside string
+            size_t offset;             // of the current chunk in the input
+
+              // i is inside string, moves it after the closing doublequotes, returns false if chunk ended before
+            inline bool string_end(iterator& i, iterator end)
+                {
+                    if (escape_pending && i != end) {
+                        ++i;
+                        escape_pending = false;
+                    }
+                    for (;;) {
+                        i = u::find_first_of<'"', '\\'>(i, end);
+                        if (i == end)
+                            return false;
+                        if (*i == '"') {
+                            ++i;
+                            return true;
+                        }
+                        if (++i == end) {
+                            escape_pending = true;
+                            return false;
+                        }
+                        ++i;
+                    }
+                }
+
+            inline void value_completed() { state = stack.size() == 1 ? state_t::done : state_t::value_end; }
+
+            inline void scalar(iterator first, iterator last)
+                {
+                    stack.back()->scalar(first, last);
+                    value_completed();
+                }
+
+            inline void key(iterator first, iterator last)
+                {
+                    stack.back()->key(first, last);
+                    state = state_t::colon;
+                }
+
+            inline void close()
+                {
+                    stack.back()->close();
+                    stack.pop_back();
+                    brackets.pop_back();
+                    value_completed();
+                }
+
+              // processes the next token or its part, returns position after it
+            inline iterator step(iterator i, iterator end)
+                {
+                    switch (state) {
+                      case state_t::string:
+                      case state_t::key_string: {
+                          iterator last = i;
+                          const bool complete = string_end(last, end);
+                          token.append(i, last);
+                          if (complete) {
+                              if (state == state_t::string)
+                                  scalar(token.data(), token.data() + token.size());
+                              else
+                                  key(token.data() + 1, token.data() + token.size() - 1);
+                          }
+                          return last;
+                      }
+                      case state_t::literal: {
+                          const iterator last = u::find_first_of<' ', '\t', '\n', '\r', ',', ']', '}'>(i, end);
+                          token.append(i, last);
+                          if (last != end)
+                              scalar(token.data(), token.data() + token.size());
+                          return last;
+                      }
+                      default:
+                          break;
+                    }
+
+                    i = skip_space(i, end);
+                    if (i == end)
+                        return i;
+                    switch (state) {
+                      case state_t::value:
+                          if (*i == '{' || *i == '[') {
+                              stack.push_back(stack.back()->open(*i));
+                              brackets.append(1, *i);
+                              state = *i == '{' ? state_t::first_key : state_t::first_item;
+                              return i + 1;
+                          }
+                          else if (*i == '"') {
+                              iterator last = i + 1;
+                              if (string_end(last, end)) {
+                                  scalar(i, last);
+                              }
+                              else {
+                                  token.assign(i, last);
+                                  state = state_t::string;
+                              }
+                              return last;
+                          }
+                          else {
+                              const iterator last = u::find_first_of<' ', '\t', '\n', '\r', ',', ']', '}'>(i, end);
+                              if (last != end) {
+                                  scalar(i, last);
+                              }
+                              else {
+                                  token.assign(i, last);
+                                  state = state_t::literal;
+                              }
+                              return last;
+                          }
+                      case state_t::first_key:
+                          if (*i == '}') {
+                              close();
+                              return i + 1;
+                          }
+                          state = state_t::key;
+                          return i;
+                      case state_t::key:
+                          if (*i != '"')
+                              throw failure("object key expected", i, end);
+                          else {
+                              iterator last = i + 1;
+                              if (string_end(last, end)) {
+                                  key(i + 1, last - 1);
+                              }
+                              else {
+                                  token.assign(i, last);
+                                  state = state_t::key_string;
+                              }
+                              return last;
+                          }
+                      case state_t::colon:
+                          if (*i != ':')
+                              throw failure("colon expected", i, end);
+                          state = state_t::value;
+                          return i + 1;
+                      case state_t::first_item:
+                          if (*i == ']') {
+                              close();
+                              return i + 1;
+                          }
+                          state = state_t::value;
+                          return i;
+                      case state_t::value_end:
+                          if (*i == ',') {
+                              state = brackets.back() == '{' ? state_t::key : state_t::value;
+                          }
+                          else if (*i == (brackets.back() == '{' ? '}' : ']')) {
+                              close();
+                          }
+                          else {
+                              throw failure(std::string("comma or ") + (brackets.back() == '{' ? "object" : "array") + " end expected", i, end);
+                          }
+                          return i + 1;
+                      case state_t::done:
+                          throw failure("unexpected text after the end of the value", i, end);
+                      default:
+                          throw failure("internal: unexpected push parser state", i, end);
+                    }
+                }
+        };
+    }
+
+      // Document is fed in chunks (e.g. as they are received), each chunk is parsed
+      // right away, just an incomplete token at the end of a chunk is kept.
+      // finish() is called after the last chunk. target is modified during parsing.
+    template <typename T> class push_parser
+    {
+     public:
+        inline push_parser(T& target) : reader(std::make_unique<r::root_frame<T>>(target, ctx)) { ctx.transient_input = true; }
+        inline push_parser(T& target, ignore_unknown_t) : push_parser(target) { ctx.ignore_unknown = true; }
+        inline push_parser(T& target, interning_t interning) : push_parser(target) { ctx.strings = interning.pool; }
+        push_parser(const push_parser&) = delete;
+        push_parser& operator=(const push_parser&) = delete;
+
+        inline void feed(const char* data, size_t size) { reader.feed(data, size); }
+        inline void feed(const std::string& data) { reader.feed(data.data(), data.size()); }
+          // throws parsing_error if document is incomplete
+        inline void finish() { reader.finish(); }
+          // the whole document has been read
+        inline bool done() const { return reader.done(); }
+
+     private:
+        r::context ctx;
+        r::push_reader reader;
+    };
+
+      // ----------------------------------------------------------------------
+      // visiting elements of a top level array one by one
+      // ----------------------------------------------------------------------
+
+    namespace r
+    {
+        inline void set_options(context&) {}
+        inline void set_options(context& ctx, ignore_unknown_t) { ctx.ignore_unknown = true; }
+        inline void set_options(context& ctx, projection_t) { ctx.ignore_unknown = ctx.projection = true; }
+        inline void set_options(context& ctx, interning_t interning) { ctx.strings = interning.pool; }
+
+          // every element is read into the same item (reset before reading as parser_list_t::keep) and passed to callback
+        template <typename T, typename F> inline void for_each_element(iterator first, iterator last, F& callback, context& ctx)
+        {
+            iterator i = skip_space(first, last);
+            try {
+                if (i == last || *i != '[')
+                    throw failure("array expected", i, last);
+                i = skip_space(i + 1, last);
+                if (i != last && *i == ']')
+                    return;
+                T item;
+                for (;;) {
+                    item = T();
+                    const auto match = parser_value(item, ctx)(i, last);
+                    if (!match.matched)
+                        throw failure("cannot parse array element", i, last);
+                    callback(item);
+                    i = skip_space(match.position, last);
+                    if (i != last && *i == ']')
+                        break;
+                    if (i == last || *i != ',')
+                        throw failure("comma or array end expected", i, last);
+                    i = skip_space(i + 1, last);
+                }
+            }
+            catch (failure& err) {
+                throw parsing_error(err.message(first));
+            }
+            catch (axe::failure<char>& err) {
+                throw parsing_error(err.message());
+            }
+        }
+
+          // forwards to the frame of an element, tells owner about its end
+        template <typename Owner> class notify_frame : public frame
+        {
+         public:
+            inline notify_frame(std::unique_ptr<frame>&& aInner, Owner& aOwner) : inner(std::move(aInner)), owner(aOwner) {}
+            virtual inline void key(iterator first, iterator last) { inner->key(first, last); }
+            virtual inline void scalar(iterator first, iterator last) { inner->scalar(first, last); }
+            virtual inline std::unique_ptr<frame> open(char bracket) { return inner->open(bracket); }
+            virtual inline void close() { inner->close(); owner.element_read(); }
+
+         private:
+            std::unique_ptr<frame> inner;
+            Owner& owner;
+        };
+
+          // top level array of the push parser for_each_element
+        template <typename T, typename F> class elements_frame : public frame
+        {
+         public:
+            inline elements_frame(F& aCallback, context& c) : callback(aCallback), ctx(c) {}
+            virtual inline void key(iterator first, iterator last) { throw failure("unexpected key", first, last); }
+
+            virtual inline void scalar(iterator first, iterator last)
+                {
+                    item = T();
+                    match_scalar(parser_value(item, ctx), first, last);
+                    callback(item);
+                }
+
+            virtual inline std::unique_ptr<frame> open(char bracket)
+                {
+                    item = T();
+                    return std::make_unique<notify_frame<elements_frame<T, F>>>(open_frame(item, ctx, bracket), *this);
+                }
+
+            inline void element_read() { callback(item); }
+
+         private:
+            F& callback;
+            context& ctx;
+            T item;
+        };
+
+        template <typename T, typename F> class elements_root : public frame
+        {
+         public:
+            inline elements_root(F& aCallback, context& c) : callback(aCallback), ctx(c) {}
+            virtual inline void key(iterator first, iterator last) { throw failure("unexpected key", first, last); }
+            virtual inline void scalar(iterator first, iterator last) { throw failure("array expected", first, last); }
+
+            virtual inline std::unique_ptr<frame> open(char bracket)
+                {
+                    check_bracket(bracket, '[');
+                    return std::make_unique<elements_frame<T, F>>(callback, ctx);
+                }
+
+         private:
+            F& callback;
+            context& ctx;
+        };
+    }
+
+      // Calls callback(T&) for every element of the top level array in source, elements are
+      // not collected: memory used is one element (plus the source or the input window).
+    template <typename T, typename F, typename... Option> inline void for_each_element(const char* first, const char* last, F callback, Option... option)
+    {
+        r::context ctx;
+        r::set_options(ctx, option...);
+        r::for_each_element<T>(first, last, callback, ctx);
+    }
+
+    template <typename T, typename F, typename... Option> inline void for_each_element(const std::string& source, F callback, Option... option)
+    {
+        for_each_element<T>(source.data(), source.data() + source.size(), callback, option...);
+    }
+
+      // input is read in 64Kb chunks which are passed to the push parser
+    template <typename T, typename F, typename... Option> inline void for_each_element(std::istream& input, F callback, Option... option)
+    {
+        r::context ctx;
+        r::set_options(ctx, option...);
+        ctx.transient_input = true;
+        r::push_reader reader(std::make_unique<r::elements_root<T, F>>(callback, ctx));
+        std::vector<char> window(0x10000);
+        while (input.read(window.data(), static_cast<std::streamsize>(window.size())) || input.gcount() > 0)
+            reader.feed(window.data(), static_cast<size_t>(input.gcount()));
+        reader.finish();
+    }
+
+      // ----------------------------------------------------------------------
+      // validation: syntax, keys and kinds of values are checked, nothing is materialized
+      // ----------------------------------------------------------------------
+
+    namespace r
+    {
+          // i is just after the opening doublequotes, escapes and control characters are checked, returns position after the closing doublequotes
+        inline iterator check_string_rest(iterator i, iterator i2)
+        {
+            const iterator start = i - 1;
+            for (;;) {
+                const iterator special = u::find_first_of<'"', '\\'>(i, i2);
+                if (std::find_if(i, special, [](char c) { return static_cast<unsigned char>(c) < 0x20; }) != special)
+                    throw failure("control character in string", start, i2);
+                if (special == i2)
+                    throw failure("unterminated string", start, i2);
+                if (*special == '"')
+                    return special + 1;
+                i = special + 1;
+                if (i == i2)
+                    throw failure("unterminated string", start, i2);
+                switch (*i) {
+                  case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                      ++i;
+                      break;
+                  case 'u':
+                      if (i2 - i < 5 || !std::all_of(i + 1, i + 5, [](char c) { return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f'); }))
+                          throw failure("invalid \\u escape in string", i - 1, i2);
+                      i += 5;
+                      break;
+                  default:
+                      throw failure("invalid escape in string", i - 1, i2);
+                }
+            }
+        }
+
+          // number as defined by RFC 8259, integral is set to false if it has fraction or exponent, returns position after it
+        inline iterator check_number(iterator i, iterator i2, bool& integral)
+        {
+            const iterator start = i;
+            const auto digits = [&i, i2, start]() {
+                if (i == i2 || *i < '0' || *i > '9')
+                    throw failure("number expected", start, i2);
+                while (i != i2 && *i >= '0' && *i <= '9')
+                    ++i;
+            };
+            if (i != i2 && *i == '-')
+                ++i;
+            if (i != i2 && *i == '0')
+                ++i;
+            else
+                digits();
+            integral = true;
+            if (i != i2 && *i == '.') {
+                ++i;
+                digits();
+                integral = false;
+            }
+            if (i != i2 && (*i == 'e' || *i == 'E')) {
+                ++i;
+                if (i != i2 && (*i == '+' || *i == '-'))
+                    ++i;
+                digits();
+                integral = false;
+            }
+            return i;
+        }
+
+        inline iterator check_literal(iterator i, iterator i2, const char* literal, size_t size)
+        {
+            if (static_cast<size_t>(i2 - i) < size || std::memcmp(i, literal, size) != 0)
+                throw failure(std::string(literal) + " expected", i, i2);
+            return i + size;
+        }
+
+          // [item, item, ...] at i, check(index, i) checks item at i and returns position after it
+        template <typename Check> inline iterator check_items(iterator i, iterator i2, Check check)
+        {
+            i = skip_space(i + 1, i2);
+            if (i != i2 && *i == ']')
+                return i + 1;
+            for (size_t index = 0; ; ++index) {
+                i = skip_space(check(index, i), i2);
+                if (i != i2 && *i == ']')
+                    return i + 1;
+                if (i == i2 || *i != ',')
+                    throw failure("comma or array end expected", i, i2);
+                i = skip_space(i + 1, i2);
+            }
+        }
+
+          // {"key": value, ...} at i, check(key_first, key_last, i) checks value at i and returns position after it
+        template <typename Check> inline iterator check_members(iterator i, iterator i2, Check check)
+        {
+            i = skip_space(i + 1, i2);
+            if (i != i2 && *i == '}')
+                return i + 1;
+            for (;;) {
+                if (i == i2 || *i != '"')
+                    throw failure("key expected", i, i2);
+                const iterator key_first = i + 1;
+                const iterator key_end = check_string_rest(key_first, i2);
+                i = skip_space(key_end, i2);
+                if (i == i2 || *i != ':')
+                    throw failure("colon expected", i, i2);
+                i = skip_space(check(key_first, key_end - 1, skip_space(i + 1, i2)), i2);
+                if (i != i2 && *i == '}')
+                    return i + 1;
+                if (i == i2 || *i != ',')
+                    throw failure("comma or object end expected", i, i2);
+                i = skip_space(i + 1, i2);
+            }
+        }
+
+          // value of any kind at i
+        inline iterator check_any(iterator i, iterator i2)
+        {
+            if (i == i2)
+                throw failure("value expected", i, i2);
+            switch (*i) {
+              case '"':
+                  return check_string_rest(i + 1, i2);
+              case '{':
+                  return check_members(i, i2, [i2](iterator, iterator, iterator value) { return check_any(value, i2); });
+              case '[':
+                  return check_items(i, i2, [i2](size_t, iterator item) { return check_any(item, i2); });
+              case 't':
+                  return check_literal(i, i2, "true", 4);
+              case 'f':
+                  return check_literal(i, i2, "false", 5);
+              case 'n':
+                  return check_literal(i, i2, "null", 4);
+              default: {
+                  bool integral;
+                  return check_number(i, i2, integral);
+              }
+            }
+        }
+
+          // ----------------------------------------------------------------------
+          // value at i that parser_value() would read into T, the second argument selects the kind
+
+        template <typename T, typename std::enable_if<std::is_integral<T>{} && !std::is_same<T, bool>{}>::type* = nullptr> iterator check_value(iterator i, iterator i2, const T*, const context& ctx);
+        template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> iterator check_value(iterator i, iterator i2, const T*, const context& ctx);
+        iterator check_value(iterator i, iterator i2, const bool*, const context& ctx);
+        iterator check_value(iterator i, iterator i2, const std::string*, const context& ctx);
+        iterator check_value(iterator i, iterator i2, const interned_string*, const context& ctx);
+        iterator check_value(iterator i, iterator i2, const raw_string*, const context& ctx);
+        iterator check_value(iterator i, iterator i2, const blob*, const context& ctx);
+        template <typename E, typename std::enable_if<u::is_named_enum<E>{}>::type* = nullptr> iterator check_value(iterator i, iterator i2, const E*, const context& ctx);
+        template <typename T, typename std::enable_if<u::is_array<T>{}>::type* = nullptr> iterator check_value(iterator i, iterator i2, const T*, const context& ctx);
+        template <typename T, size_t N> iterator check_value(iterator i, iterator i2, const std::array<T, N>*, const context& ctx);
+        template <typename M, typename std::enable_if<u::is_map<M>{}>::type* = nullptr> iterator check_value(iterator i, iterator i2, const M*, const context& ctx);
+        template <typename T, typename std::enable_if<u::is_object<T>{}>::type* = nullptr> iterator check_value(iterator i, iterator i2, const T*, const context& ctx);
+        template <typename T> iterator check_value(iterator i, iterator i2, const cached<T>*, const context& ctx);
+        template <typename T> iterator check_value(iterator i, iterator i2, const columns<T>*, const context& ctx);
+
+        template <typename T, typename std::enable_if<std::is_integral<T>{} && !std::is_same<T, bool>{}>::type*> inline iterator check_value(iterator i, iterator i2, const T*, const context&)
+        {
+            bool integral;
+            const iterator end = check_number(i, i2, integral);
+            if (!integral)
+                throw failure("integer expected", i, i2);
+            const bool negative = *i == '-';
+            if (negative && std::is_unsigned<T>{})
+                throw failure("unsigned number expected", i, i2);
+            const uint64_t limit = negative ? static_cast<uint64_t>(-(static_cast<int64_t>(std::numeric_limits<T>::min()) + 1)) + 1 : static_cast<uint64_t>(std::numeric_limits<T>::max());
+            uint64_t value = 0;
+            for (iterator digit = negative ? i + 1 : i; digit != end; ++digit) {
+                const auto d = static_cast<uint64_t>(*digit - '0');
+                if (value > (limit - d) / 10)
+                    throw failure("number out of range", i, i2);
+                value = value * 10 + d;
+            }
+            return end;
+        }
+
+        template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type*> inline iterator check_value(iterator i, iterator i2, const T*, const context&)
+        {
+            if (i != i2 && *i == 'n')
+                return check_literal(i, i2, "null", 4);
+            bool integral;
+            return check_number(i, i2, integral);
+        }
+
+        inline iterator check_value(iterator i, iterator i2, const bool*, const context&)
+        {
+            if (i != i2 && (*i == '1' || *i == '0'))
+                return i + 1;
+            if (i != i2 && *i == 'f')
+                return check_literal(i, i2, "false", 5);
+            if (i == i2 || *i != 't')
+                throw failure("true or 1 or false or 0 expected", i, i2);
+            return check_literal(i, i2, "true", 4);
+        }
+
+        inline iterator check_string(iterator i, iterator i2)
+        {
+            if (i != i2 && *i == 'n')
+                return check_literal(i, i2, "null", 4);
+            if (i == i2 || *i != '"')
+                throw failure("string expected", i, i2);
+            return check_string_rest(i + 1, i2);
+        }
+
+        inline iterator check_value(iterator i, iterator i2, const std::string*, const context&) { return check_string(i, i2); }
+        inline iterator check_value(iterator i, iterator i2, const interned_string*, const context&) { return check_string(i, i2); }
+
+        inline iterator check_value(iterator i, iterator i2, const raw_string*, const context& ctx)
+        {
+            if (ctx.transient_input)
+                throw failure("raw_string cannot be read from the input fed in chunks", i, i2);
+            return check_string(i, i2);
+        }
+
+        inline iterator check_value(iterator i, iterator i2, const blob*, const context&)
+        {
+            const iterator end = check_string(i, i2);
+            if (*i == 'n')
+                return end;
+            const unsigned char* const table = base64::decoding_table();
+            size_t size = static_cast<size_t>(end - i - 2);
+            if (std::memchr(i + 1, '\\', size) == nullptr && base64::decoded_size(i + 1, size) != std::string::npos
+                && std::all_of(i + 1, i + 1 + size, [table](char c) { return table[static_cast<unsigned char>(c)] != base64::not_base64; }))
+                return end;
+            blob decoded; // escaped text, rare
+            if (!decode_base64(i + 1, static_cast<size_t>(end - i - 2), decoded))
+                throw failure("invalid base64 text", i, i2);
+            return end;
+        }
+
+        template <typename E, typename std::enable_if<u::is_named_enum<E>{}>::type*> inline iterator check_value(iterator i, iterator i2, const E*, const context&)
+        {
+            if (i == i2 || *i != '"')
+                throw failure("enum value name expected", i, i2);
+            const iterator end = check_string_rest(i + 1, i2);
+            E value;
+            if (!enum_names<E>::get().value(i + 1, static_cast<size_t>(end - i - 2), value))
+                throw failure("unknown enum value name", i, end);
+            return end;
+        }
+
+        template <typename T, typename std::enable_if<u::is_array<T>{}>::type*> inline iterator check_value(iterator i, iterator i2, const T*, const context& ctx)
+        {
+            if (i == i2 || *i != '[')
+                throw failure("array expected", i, i2);
+            return check_items(i, i2, [i2, &ctx](size_t, iterator item) { return check_value(item, i2, static_cast<const typename T::value_type*>(nullptr), ctx); });
+        }
+
+        template <typename T, size_t N> inline iterator check_value(iterator i, iterator i2, const std::array<T, N>*, const context& ctx)
+        {
+            if (i == i2 || *i != '[')
+                throw failure("array expected", i, i2);
+            size_t size = 0;
+            const iterator end = check_items(i, i2, [i2, &ctx, &size](size_t index, iterator item) {
+                    if (index >= N)
+                        throw failure("too many array elements, " + std::to_string(N) + " expected", item, i2);
+                    size = index + 1;
+                    return check_value(item, i2, static_cast<const T*>(nullptr), ctx);
+                });
+            if (size != N)
+                throw failure(std::to_string(size) + " array elements found, " + std::to_string(N) + " expected", i, i2);
+            return end;
+        }
+
+        template <typename M, typename std::enable_if<u::is_map<M>{}>::type*> inline iterator check_value(iterator i, iterator i2, const M*, const context& ctx)
+        {
+            if (i == i2 || *i != '{')
+                throw failure("object expected", i, i2);
+            return check_members(i, i2, [i2, &ctx](iterator, iterator, iterator value) { return check_value(value, i2, static_cast<const typename M::mapped_type*>(nullptr), ctx); });
+        }
+
+        template <typename T> inline iterator check_field(iterator i, iterator i2, const T*, const context& ctx) { return check_value(i, i2, static_cast<const T*>(nullptr), ctx); }
+        template <typename G, typename S, typename P> inline iterator check_field(iterator i, iterator i2, const field_t<G, S, P>&, const context& ctx) { return check_value(i, i2, static_cast<const typename field_t<G, S, P>::value_type*>(nullptr), ctx); }
+        template <typename S, typename P> inline iterator check_field(iterator i, iterator i2, const _literal_field_t<S, P>&, const context&) { return check_any(i, i2); }
+
+          // keys and kinds of values of T, json_fields() is called once for a default constructed T
+        template <typename T> inline const auto& schema_fields()
+        {
+            static T prototype;
+            static const auto fields = u::call_json_fields(prototype, false);
+            return fields;
+        }
+
+        template <typename T, typename std::enable_if<u::is_object<T>{}>::type*> inline iterator check_value(iterator i, iterator i2, const T*, const context& ctx)
+        {
+            if (i == i2 || *i != '{')
+                throw failure("object expected", i, i2);
+            const auto& fields = schema_fields<T>();
+            size_t next = 0;
+            return check_members(i, i2, [i2, &ctx, &fields, &next](iterator key_first, iterator key_last, iterator value) {
+                    iterator end = value;
+                    const auto check = [i2, &ctx, &next, &end, value](size_t index, const auto& field) { end = check_field(value, i2, field, ctx); next = index + 1; };
+                    if (!u::find_field(fields, key_first, static_cast<size_t>(key_last - key_first), check, next)) {
+                        if (!ctx.ignore_unknown)
+                            throw failure(std::string("unknown key \"") + std::string(key_first, key_last) + "\"", key_first, i2);
+                        end = check_any(value, i2);
+                    }
+                    return end;
+                });
+        }
+
+        template <typename T> inline iterator check_value(iterator i, iterator i2, const cached<T>*, const context& ctx)
+        {
+            return check_value(i, i2, static_cast<const T*>(nullptr), ctx);
+        }
+
+        template <typename F> inline iterator check_column_item(iterator i, iterator i2, const F& field, const context& ctx) { return check_field(i, i2, field, ctx); }
+
+          // null is written for json::no_value
+        template <typename G, typename S, typename P> inline iterator check_column_item(iterator i, iterator i2, const field_t<G, S, P>& field, const context& ctx)
+        {
+            return i != i2 && *i == 'n' ? check_literal(i, i2, "null", 4) : check_field(i, i2, field, ctx);
+        }
+
+          // json::columnar: an array for every field, all of the same size
+        template <typename T> inline iterator check_value(iterator i, iterator i2, const columns<T>*, const context& ctx)
+        {
+            if (i == i2 || *i != '{')
+                throw failure("object expected", i, i2);
+            const auto& fields = schema_fields<T>();
+            size_t next = 0, size = 0;
+            bool sized = false;
+            return check_members(i, i2, [i2, &ctx, &fields, &next, &size, &sized](iterator key_first, iterator key_last, iterator value) {
+                    iterator end = value;
+                    const auto check = [i2, &ctx, &next, &size, &sized, &end, value](size_t index, const auto& field) {
+                        if (value == i2 || *value != '[')
+                            throw failure("array expected", value, i2);
+                        size_t count = 0;
+                        end = check_items(value, i2, [i2, &ctx, &count, &field](size_t, iterator item) { ++count; return check_column_item(item, i2, field, ctx); });
+                        if (sized && count != size)
+                            throw failure("columns of different sizes", value, i2);
+                        size = count;
+                        sized = true;
+                        next = index + 1;
+                    };
+                    if (!u::find_field(fields, key_first, static_cast<size_t>(key_last - key_first), check, next)) {
+                        if (!ctx.ignore_unknown)
+                            throw failure(std::string("unknown key \"") + std::string(key_first, key_last) + "\"", key_first, i2);
+                        end = check_any(value, i2);
+                    }
+                    return end;
+                });
+        }
+
+          // check(i) checks the value at i, just spaces may follow it
+        template <typename Check> inline void validate(iterator first, iterator last, Check check)
+        {
+            try {
+                const iterator end = skip_space(check(skip_space(first, last)), last);
+                if (end != last)
+                    throw failure("unexpected text after the value", end, last);
+            }
+            catch (failure& err) {
+                throw parsing_error(err.message(first));
+            }
+        }
+    }
+
+      // Checks that source is RFC 8259 json that json::parse would read into T: syntax, keys of
+      // objects and kinds of values, without materializing anything (no strings or containers are
+      // allocated). Throws json::parsing_error. Options: json::ignore_unknown, json::projection.
+      // Objects are checked against json_fields() of a default constructed T made once per type.
+      // It is stricter than json::parse, which reads (without failing)
+      //   - numbers with leading zeros, +, .5 or 1. (except + in arrays of integers),
+      //   - integers out of the range of a field that is not in an array of numbers,
+      //   - strings with invalid escapes, unescaped control characters or short \u escapes,
+      //   - text following the value.
+    template <typename T, typename... Option> inline void validate(const char* first, const char* last, Option... option)
+    {
+        r::context ctx;
+        r::set_options(ctx, option...);
+        r::validate(first, last, [last, &ctx](r::iterator i) { return r::check_value(i, last, static_cast<const T*>(nullptr), ctx); });
+    }
+
+    template <typename T, typename... Option> inline void validate(const std::string& source, Option... option)
+    {
+        validate<T>(source.data(), source.data() + source.size(), option...);
+    }
+
+      // checks that source is a well-formed json value (RFC 8259), throws json::parsing_error
+    inline void validate(const char* first, const char* last)
+    {
+        r::validate(first, last, [last](r::iterator i) { return r::check_any(i, last); });
+    }
+
+    inline void validate(const std::string& source)
+    {
+        validate(source.data(), source.data() + source.size());
+    }
+
+      // ----------------------------------------------------------------------
+      // extracting values at json pointers (RFC 6901) without parsing the rest
+      // ----------------------------------------------------------------------
+
+    namespace r
+    {
+          // "" (whole document) or "/token/token...", ~ is followed by 0 (~) or 1 (/)
+        inline void check_pointer(const char* pointer)
+        {
+            if (*pointer != 0 && *pointer != '/')
+                throw std::invalid_argument(std::string("json pointer \"") + pointer + "\" does not start with /");
+            for (const char* c = pointer; *c != 0; ++c) {
+                if (*c == '~' && c[1] != '0' && c[1] != '1')
+                    throw std::invalid_argument(std::string("json pointer \"") + pointer + "\": ~ is not followed by 0 or 1");
+            }
+        }
+
+          // rest is "/token...", returns the end of the token: the next / or the terminating 0
+        inline const char* pointer_token_end(const char* rest)
+        {
+            ++rest;
+            while (*rest != 0 && *rest != '/')
+                ++rest;
+            return rest;
+        }
+
+          // token [first, last) is compared with the key as it is in the source (json escapes are not decoded)
+        inline bool pointer_token_is(const char* first, const char* last, iterator key_first, iterator key_last)
+        {
+            for (; first != last; ++first, ++key_first) {
+                char c = *first;
+                if (c == '~')
+                    c = *++first == '0' ? '~' : '/';
+                if (key_first == key_last || *key_first != c)
+                    return false;
+            }
+            return key_first == key_last;
+        }
+
+          // array index: 0 or digits without leading zero ("-" refers to the element after the last one and is never found)
+        inline bool pointer_index(const char* first, const char* last, size_t& index)
+        {
+            if (first == last || (*first == '0' && last - first > 1))
+                return false;
+            index = 0;
+            for (; first != last; ++first) {
+                if (*first < '0' || *first > '9')
+                    return false;
+                index = index * 10 + static_cast<size_t>(*first - '0');
+            }
+            return true;
+        }
+
+          // Follows all the pointers of targets ("/pointer", &value, ...) in a single pass, values not
+          // on the paths are skipped. Scanning stops as soon as all the values are read.
+        template <typename Targets> class extractor
+        {
+         public:
+            static constexpr size_t N = std::tuple_size<Targets>::value / 2;
+            typedef std::bitset<N> paths;
+            typedef std::array<const char*, N> positions;
+
+            inline extractor(Targets& aTargets, context& c) : targets(aTargets), ctx(c) {}
+
+            paths found;
+
+              // value at i, rest[p] is the part of pointer p not followed yet for the paths in active,
+              // returns position after the value or nullptr if all the values are read
+            inline iterator value(iterator i, iterator i2, const paths& active, const positions& rest)
+                {
+                    paths deeper;
+                    iterator end = nullptr;
+                    for (size_t path = 0; path < N; ++path) {
+                        if (active[path]) {
+                            if (*rest[path] == 0)
+                                end = read(path, i, i2);
+                            else
+                                deeper.set(path);
+                        }
+                    }
+                    if (found.all())
+                        return nullptr;
+                    if (deeper.any() && i != i2 && *i == '{')
+                        return members(i, i2, deeper, rest);
+                    if (deeper.any() && i != i2 && *i == '[')
+                        return items(i, i2, deeper, rest);
+                    return end ? end : skip_value(i, i2); // paths going deeper than a scalar are not found
+                }
+
+         private:
+            Targets& targets;
+            context& ctx;
+
+            inline iterator read(size_t path, iterator i, iterator i2)
+                {
+                    iterator end = i;
+                    u::for_each_field(targets, [this, path, i, i2, &end](size_t index, const char* pointer, auto* target) {
+                            if (index == path) {
+                                const auto match = parser_value(*target, ctx)(i, i2);
+                                if (!match.matched)
+                                    throw failure(std::string("cannot parse value at json pointer \"") + pointer + "\"", i, i2);
+                                end = match.position;
+                            }
+                        });
+                    found.set(path);
+                    return end;
+                }
+
+            inline iterator members(iterator i, iterator i2, const paths& active, const positions& rest)
+                {
+                    i = skip_space(i + 1, i2);
+                    if (i != i2 && *i == '}')
+                        return i + 1;
+                    for (;;) {
+                        if (i == i2 || *i != '"')
+                            throw failure("key expected", i, i2);
+                        const iterator key_first = i + 1;
+                        const iterator key_end = skip_string_rest(key_first, i2);
+                        i = skip_space(key_end, i2);
+                        if (i == i2 || *i != ':')
+                            throw failure("colon expected", i, i2);
+                        i = skip_space(i + 1, i2);
+                        paths member;
+                        positions next = rest;
+                        for (size_t path = 0; path < N; ++path) {
+                            if (active[path]) {
+                                const char* token_end = pointer_token_end(rest[path]);
+                                if (pointer_token_is(rest[path] + 1, token_end, key_first, key_end - 1)) {
+                                    member.set(path);
+                                    next[path] = token_end;
+                                }
+                            }
+                        }
+                        i = member.any() ? value(i, i2, member, next) : skip_value(i, i2);
+                        if (i == nullptr)
+                            return nullptr;
+                        i = skip_space(i, i2);
+                        if (i != i2 && *i == '}')
+                            return i + 1;
+                        if (i == i2 || *i != ',')
+                            throw failure("comma or object end expected", i, i2);
+                        i = skip_space(i + 1, i2);
+                    }
+                }
+
+              // the rest of the array after the last index of the paths is skipped at once
+            inline iterator items(iterator i, iterator i2, const paths& active, const positions& rest)
+                {
+                    positions token_end{};
+                    std::array<size_t, N> indexes{};
+                    paths indexed;
+                    size_t last_index = 0;
+                    for (size_t path = 0; path < N; ++path) {
+                        if (active[path]) {
+                            token_end[path] = pointer_token_end(rest[path]);
+                            if (pointer_index(rest[path] + 1, token_end[path], indexes[path])) {
+                                indexed.set(path);
+                                last_index = std::max(last_index, indexes[path]);
+                            }
+                        }
+                    }
+                    i = skip_space(i + 1, i2);
+                    if (i != i2 && *i == ']')
+                        return i + 1;
+                    for (size_t index = 0; ; ++index) {
+                        if (indexed.none() || index > last_index)
+                            return skip_nested_rest(i, i2, 1);
+                        paths item;
+                        positions next = rest;
+                        for (size_t path = 0; path < N; ++path) {
+                            if (indexed[path] && indexes[path] == index) {
+                                item.set(path);
+                                next[path] = token_end[path];
+                            }
+                        }
+                        i = item.any() ? value(i, i2, item, next) : skip_value(i, i2);
+                        if (i == nullptr)
+                            return nullptr;
+                        i = skip_space(i, i2);
+                        if (i != i2 && *i == ']')
+                            return i + 1;
+                        if (i == i2 || *i != ',')
+                            throw failure("comma or array end expected", i, i2);
+                        i = skip_space(i + 1, i2);
+                    }
+                }
+        };
+
+        template <typename Targets> inline auto extract(iterator first, iterator last, Targets& targets, context& ctx)
+        {
+            extractor<Targets> reader(targets, ctx);
+            typename extractor<Targets>::paths active;
+            typename extractor<Targets>::positions rest;
+            u::for_each_field(targets, [&active, &rest](size_t index, const char* pointer, const auto*) {
+                    check_pointer(pointer);
+                    rest[index] = pointer;
+                    active.set(index);
+                });
+            try {
+                reader.value(skip_space(first, last), last, active, rest);
+            }
+            catch (failure& err) {
+                throw parsing_error(err.message(first));
+            }
+            catch (axe::failure<char>& err) {
+                throw parsing_error(err.message());
+            }
+            return reader.found;
+        }
+    }
+
+      // Reads values at json pointers (RFC 6901) given as std::make_tuple("/header/route/3/id", &id, "/body/size", &size, ...)
+      // in a single pass: values not on the paths are skipped without materializing, scanning stops as soon as all the
+      // values are read. Returns std::bitset of the pointers found, targets of the others are not changed.
+      // Keys are compared as they are in the source (json escapes are not decoded).
+    template <typename Targets, typename... Option, typename std::enable_if<u::is_tuple<Targets>{}>::type* = nullptr> inline auto extract(const char* first, const char* last, Targets targets, Option... option)
+    {
+        r::context ctx;
+        r::set_options(ctx, option...);
+        return r::extract(first, last, targets, ctx);
+    }
+
+    template <typename Targets, typename... Option, typename std::enable_if<u::is_tuple<Targets>{}>::type* = nullptr> inline auto extract(const std::string& source, Targets targets, Option... option)
+    {
+        return extract(source.data(), source.data() + source.size(), targets, option...);
+    }
+
+      // value at json pointer, throws json::parsing_error if there is no such value
+    template <typename T, typename... Option> inline T extract(const char* first, const char* last, const char* pointer, Option... option)
+    {
+        T result{};
+        if (!extract(first, last, std::make_tuple(pointer, &result), option...)[0])
+            throw parsing_error(std::string("json pointer \"") + pointer + "\" not found");
+        return result;
+    }
+
+    template <typename T, typename... Option> inline T extract(const std::string& source, const char* pointer, Option... option)
+    {
+        return extract<T>(source.data(), source.data() + source.size(), pointer, option...);
+    }
+
+      // ----------------------------------------------------------------------
+
+    namespace w
+    {
+          // ---- value_to_string ------------------------------------------------------------------
+
+        template <typename T> inline typename std::enable_if<std::is_floating_point<T>::value, std::string>::type value_to_string(T val)
+        {
+            if (std::isnan(val)) {
+                return "null";
+            }
+            else {
+                std::ostringstream s;
+                for (auto prec = std::numeric_limits<T>::max_digits10; prec > 6; --prec) {
+                    s.str("");
+                    s << std::setprecision(prec) << val;
+                    const auto ss = s.str();
+                    if (ss.find('e') != ss.npos || ss.find('E') != ss.npos || (ss.size() > 5 && ss.substr(ss.size() - 5, 4) != "0000" && ss.substr(ss.size() - 4) != "9999"))
+                        return ss;
+                }
+                return s.str();
+            }
+        }
+
+        template <typename T> inline typename std::enable_if<std::is_integral<T>::value, std::string>::type value_to_string(T val)
+        {
+            return std::to_string(val);
+        }
+
+        inline std::string value_to_string(std::string val)
+        {
+            return '"' + val + '"';
+        }
+
+        inline std::string value_to_string(bool val)
+        {
+            return val ? "true" : "false";
+        }
+
+          // ---- integers ------------------------------------------------------------------
+
+        template <typename T, typename std::enable_if<std::is_signed<T>{}>::type* = nullptr> inline bool is_negative(T val) { return val < 0; }
+        template <typename T, typename std::enable_if<std::is_unsigned<T>{}>::type* = nullptr> inline bool is_negative(T) { return false; }
+
+          // writes decimal representation of val ending just before end, returns its beginning
+        template <typename T> inline char* integer_to_chars(char* end, T val)
+        {
+            typedef typename std::make_unsigned<T>::type U;
+            const bool negative = is_negative(val);
+            U u = negative ? static_cast<U>(U(0) - static_cast<U>(val)) : static_cast<U>(val);
+            do {
+                *--end = static_cast<char>('0' + u % 10);
+                u /= 10;
+            } while (u);
+            if (negative)
+                *--end = '-';
+            return end;
+        }
+
+          // number of chars in decimal representation of val
+        template <typename T> inline size_t integer_size(T val)
+        {
+            typedef typename std::make_unsigned<T>::type U;
+            const bool negative = is_negative(val);
+            U u = negative ? static_cast<U>(U(0) - static_cast<U>(val)) : static_cast<U>(val);
+            size_t size = negative ? 2 : 1;
+            while (u /= 10)
+                ++size;
+            return size;
+        }
+
+          // ---- floating point with json::precision() and json::fixed() ------------------------------------------------------------------
+
+          // enough for sign, 16 digits, point and exponent of any val float_to_chars() writes
+        constexpr size_t max_formatted_float_size = 32;
+
+        inline uint64_t power_of_ten(int exponent)
+        {
+            uint64_t result = 1;
+            while (exponent-- > 0)
+                result *= 10;
+            return result;
+        }
+
+          // val * 10^exponent rounded half away from zero, powers up to 10^22 are exact doubles and then
+          // the rounding error of the product is taken into account when the fraction is close to a half
+        inline uint64_t scale_round(double val, int exponent)
+        {
+            static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            if (exponent > 300) { // denormals: 10^exponent itself is not representable
+                val *= 1e100;
+                exponent -= 100;
+            }
+            const bool exact_power = exponent >= -22 && exponent <= 22;
+            const double power = exact_power ? powers[exponent < 0 ? -exponent : exponent] : std::pow(10.0, exponent < 0 ? -exponent : exponent);
+            const double scaled = exponent >= 0 ? val * power : val / power;
+            const double integral = std::floor(scaled);
+            double fraction = scaled - integral;
+            if (exact_power && std::fabs(fraction - 0.5) <= scaled * 2.3e-16) {
+                if (exponent >= 0)
+                    fraction += std::fma(val, power, -scaled);
+                else
+                    fraction -= std::fma(scaled, power, -val) / power;
+            }
+            return static_cast<uint64_t>(integral) + (fraction >= 0.5 ? 1 : 0);
+        }
+
+          // Writes val with the format (significant or fixed) starting at first, returns the end of the text,
+          // nullptr if val is not finite or if val * 10^decimals for fixed exceeds 2^53 (val is then written as by default).
+          // Digits are produced directly from the scaled value rounded half away from zero, without round-trip search,
+          // the last digit may therefore differ from printf for values within an ulp of a half.
+        inline char* float_to_chars(char* first, double val, const float_format& format)
+        {
+            if (!std::isfinite(val))
+                return nullptr;
+            const int digits = format.digits();
+            const bool negative = std::signbit(val);
+            const double magnitude = std::fabs(val);
+            char text[24];
+            char* const text_end = text + sizeof(text);
+
+            if (format.style() == float_format::fixed) {
+                if (magnitude >= 9007199254740992.0 / static_cast<double>(power_of_ten(digits)))
+                    return nullptr;
+                const uint64_t scaled = scale_round(magnitude, digits);
+                if (negative && scaled != 0)
+                    *first++ = '-';
+                const uint64_t unit = power_of_ten(digits);
+                const char* integral = integer_to_chars(text_end, scaled / unit);
+                first = std::copy(integral, static_cast<const char*>(text_end), first);
+                if (digits > 0) {
+                    *first++ = '.';
+                    char* fraction = integer_to_chars(text_end, scaled % unit);
+                    first = std::fill_n(first, digits - (text_end - fraction), '0');
+                    first = std::copy(static_cast<const char*>(fraction), static_cast<const char*>(text_end), first);
+                }
+                return first;
+            }
+
+            if (negative)
+                *first++ = '-';
+            if (magnitude == 0) {
+                *first++ = '0';
+                return first;
+            }
+              // mantissa of digits digits and decimal exponent, log10 may be off by one near powers of ten
+            int exponent = static_cast<int>(std::floor(std::log10(magnitude)));
+            uint64_t mantissa = scale_round(magnitude, digits - 1 - exponent);
+            if (mantissa >= power_of_ten(digits))
+                mantissa = scale_round(magnitude, digits - 1 - ++exponent);
+            else if (mantissa < power_of_ten(digits - 1))
+                mantissa = scale_round(magnitude, digits - 1 - --exponent);
+            int size = digits;      // trailing zeros are not written, as with %g
+            for (; size > 1 && mantissa % 10 == 0; --size)
+                mantissa /= 10;
+            const char* mantissa_digits = integer_to_chars(text_end, mantissa);
+
+            if (exponent < -4 || exponent >= digits) {
+                *first++ = *mantissa_digits;
+                if (size > 1) {
+                    *first++ = '.';
+                    first = std::copy(mantissa_digits + 1, static_cast<const char*>(text_end), first);
+                }
+                *first++ = 'e';
+                *first++ = exponent < 0 ? '-' : '+';
+                if (exponent > -10 && exponent < 10)
+                    *first++ = '0';
+                return std::copy(static_cast<const char*>(integer_to_chars(text_end, exponent < 0 ? -exponent : exponent)), static_cast<const char*>(text_end), first);
+            }
+            if (exponent < 0) {
+                *first++ = '0';
+                *first++ = '.';
+                first = std::fill_n(first, -exponent - 1, '0');
+                return std::copy(mantissa_digits, static_cast<const char*>(text_end), first);
+            }
+            const int integral = exponent + 1;
+            if (size <= integral) {
+                first = std::copy(mantissa_digits, static_cast<const char*>(text_end), first);
+                return std::fill_n(first, integral - size, '0');
+            }
+            first = std::copy(mantissa_digits, mantissa_digits + integral, first);
+            *first++ = '.';
+            return std::copy(mantissa_digits + integral, static_cast<const char*>(text_end), first);
+        }
+
+          // ---- text_sink ------------------------------------------------------------------
+
+          // output text storage, in measuring mode nothing is stored and just the size is counted
+        class text_sink
+        {
+         public:
+            inline text_sink(bool aMeasureOnly) : mMeasured(0), mMeasureOnly(aMeasureOnly) {}
+
+            inline bool measure_only() const { return mMeasureOnly; }
+            inline void append(size_t n, char c) { if (mMeasureOnly) mMeasured += n; else JSON_STRUCT_TRACK_GROWTH(instrument::writing, typeid(std::string), mText, mText.append(n, c)); }
+            inline void append(const char* s, size_t n) { if (mMeasureOnly) mMeasured += n; else JSON_STRUCT_TRACK_GROWTH(instrument::writing, typeid(std::string), mText, mText.append(s, n)); }
+            inline void append(const char* s) { append(s, std::strlen(s)); }
+            inline void append(const std::string& s) { append(s.data(), s.size()); }
+              // in measuring mode just n is added to the size
+            inline void skip(size_t n) { mMeasured += n; }
+              // n chars to be written via the returned pointer, nullptr in measuring mode
+            inline char* extend(size_t n)
+                {
+                    if (mMeasureOnly) {
+                        mMeasured += n;
+                        return nullptr;
+                    }
+                    const auto pos = mText.size();
+                    JSON_STRUCT_TRACK_GROWTH(instrument::writing, typeid(std::string), mText, mText.resize(pos + n));
+                    return &mText[pos];
+                }
+            inline size_t size() const { return mMeasureOnly ? mMeasured : mText.size(); }
+            inline void erase(size_t pos) { if (mMeasureOnly) mMeasured = pos; else mText.erase(pos); }
+            inline void reserve(size_t n) { if (!mMeasureOnly) mText.reserve(n); }
+            inline const std::string& text() const { return mText; }
+            inline std::string release() { return std::move(mText); }
+
+         private:
+            std::string mText;
+            size_t mMeasured;
+            bool mMeasureOnly;
+        };
+
+          // ---- keys ------------------------------------------------------------------
+
+          // object key to write, either plain text (doublequotes, colon and space are added on writing)
+          // or already quoted "key": text copied to the output as is
+        class key_ref
+        {
+         public:
+            inline key_ref(const char* aText, size_t aSize, bool aQuoted) : text(aText), size(aSize), quoted(aQuoted) {}
+
+            const char* text;
+            size_t size;
+            bool quoted;
+        };
+
+          // "key": texts for the keys of the json_fields() tuple, made once per object type on its first output
+          // (objects of different types may have json_fields() tuples of the same type)
+        template <typename T, typename Fields> class quoted_keys
+        {
+         public:
+            static constexpr size_t number_of_keys = std::tuple_size<Fields>::value / 2;
+
+            inline quoted_keys(const Fields& fields) { make(fields, std::make_index_sequence<number_of_keys>()); }
+
+              // key is normally the same literal that was used to make the table, otherwise it is written as is
+            inline key_ref get(size_t index, const char* key) const
+                {
+                    if (key == source[index])
+                        return key_ref(quoted[index].data(), quoted[index].size(), true);
+                    return key_ref(key, std::strlen(key), false);
+                }
+
+         private:
+            const char* source[number_of_keys == 0 ? 1 : number_of_keys];
+            std::string quoted[number_of_keys == 0 ? 1 : number_of_keys];
+
+            template <size_t... Ns> inline void make(const Fields& fields, std::index_sequence<Ns...>)
+                {
+                    using expand = int[];
+                    (void)expand{0, (make(Ns, std::get<Ns * 2>(fields)), 0)...};
+                }
+
+            inline void make(size_t index, const char* key)
+                {
+                    source[index] = key;
+                    quoted[index].append(1, '"').append(key).append("\": ");
+                }
+        };
+
+          // ----------------------------------------------------------------------
+          // equality of values as they are written, used to make merge patch
+          // ----------------------------------------------------------------------
+
+        template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> inline bool same_value(T a, T b);
+        template <typename T, typename std::enable_if<std::is_integral<T>{}>::type* = nullptr> inline bool same_value(T a, T b);
+        inline bool same_value(const std::string& a, const std::string& b);
+        inline bool same_value(const raw_string& a, const raw_string& b);
+        inline bool same_value(const blob& a, const blob& b);
+        template <typename E, typename std::enable_if<std::is_enum<E>{}>::type* = nullptr> inline bool same_value(E a, E b);
+        template <typename T, typename std::enable_if<u::is_array<T>{}>::type* = nullptr> inline bool same_value(const T& a, const T& b);
+        template <typename M, typename std::enable_if<u::is_sorted_map<M>{}>::type* = nullptr> inline bool same_value(const M& a, const M& b);
+        template <typename T> inline bool same_value(const std::unordered_map<std::string, T>& a, const std::unordered_map<std::string, T>& b);
+        template <typename T, typename std::enable_if<u::is_object<T>{}>::type* = nullptr> inline bool same_value(const T& a, const T& b);
+        template <typename T> inline bool same_value(const cached<T>& a, const cached<T>& b);
+        template <typename T> inline bool same_value(const columns<T>& a, const columns<T>& b);
+
+        template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type*> inline bool same_value(T a, T b)
+        {
+            return a == b || (std::isnan(a) && std::isnan(b)); // both written as null
+        }
+
+        template <typename T, typename std::enable_if<std::is_integral<T>{}>::type*> inline bool same_value(T a, T b)
+        {
+            return a == b;
+        }
+
+        inline bool same_value(const std::string& a, const std::string& b)
+        {
+            return a == b;
+        }
+
+        inline bool same_value(const raw_string& a, const raw_string& b)
+        {
+            return a == b;
+        }
+
+        inline bool same_value(const blob& a, const blob& b)
+        {
+            return a == b;
+        }
+
+        template <typename E, typename std::enable_if<std::is_enum<E>{}>::type*> inline bool same_value(E a, E b)
+        {
+            return a == b;
+        }
+
+        template <typename T, typename std::enable_if<u::is_array<T>{}>::type*> inline bool same_value(const T& a, const T& b)
+        {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const auto& e1, const auto& e2) { return same_value(e1, e2); });
+        }
+
+        template <typename M, typename std::enable_if<u::is_sorted_map<M>{}>::type*> inline bool same_value(const M& a, const M& b)
+        {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const auto& e1, const auto& e2) { return e1.first == e2.first && same_value(e1.second, e2.second); });
+        }
+
+        template <typename T> inline bool same_value(const std::unordered_map<std::string, T>& a, const std::unordered_map<std::string, T>& b)
+        {
+            return a.size() == b.size() && std::all_of(a.begin(), a.end(), [&b](const auto& e1) { const auto e2 = b.find(e1.first); return e2 != b.end() && same_value(e1.second, e2->second); });
+        }
+
+        template <typename T> inline bool same_value(const cached<T>& a, const cached<T>& b)
+        {
+            return same_value(a.get(), b.get());
+        }
+
+        template <typename T> inline bool same_value(const columns<T>& a, const columns<T>& b)
+        {
+            return same_value(a.items(), b.items());
+        }
+
+        template <typename T> inline bool same_field(T* a, T* b)
+        {
+            return same_value(*a, *b);
+        }
+
+        template <typename G, typename S, typename P> inline bool same_field(const field_t<G, S, P>& a, const field_t<G, S, P>& b)
+        {
+            bool a_present = true, b_present = true;
+            typename field_t<G, S, P>::value_type a_value{}, b_value{};
+            try { a_value = a.get(); } catch (no_value&) { a_present = false; }
+            try { b_value = b.get(); } catch (no_value&) { b_present = false; }
+            return a_present == b_present && (!a_present || same_value(a_value, b_value));
+        }
+
+        template <typename S, typename P> inline bool same_field(const _literal_field_t<S, P>& a, const _literal_field_t<S, P>& b)
+        {
+            return a.getter() == b.getter();
+        }
+
+        template <typename T, typename std::enable_if<u::is_object<T>{}>::type*> inline bool same_value(const T& a, const T& b)
+        {
+            bool a_present = true, b_present = true, same = true;
+            try {
+                auto a_fields = u::call_json_fields(const_cast<T&>(a), true);
+                try {
+                    auto b_fields = u::call_json_fields(const_cast<T&>(b), true);
+                    u::for_each_field_pair(a_fields, b_fields, [&same](size_t, const char*, auto& a_value, auto& b_value) { same = same && same_field(a_value, b_value); });
+                }
+                catch (no_value&) {
+                    b_present = false;
+                }
+            }
+            catch (no_value&) { // json_fields thrown no_value, val does not appear in the output
+                a_present = false;
+                try { u::call_json_fields(const_cast<T&>(b), true); } catch (no_value&) { b_present = false; }
+            }
+            return a_present == b_present && same;
+        }
+
+          // ----------------------------------------------------------------------
+
+        class output
+        {
+         protected:
+            text_sink buffer;
+            bool insert_comma;
+            bool sorted_keys;   // unordered maps are written with sorted keys
+            float_format floats; // of the output or of the field being written
+
+            inline void comma(bool ic) { if (insert_comma) add_comma(); insert_comma = ic; }
+            virtual inline void add_comma() { buffer.append(1, ','); }
+            virtual void indent_simple() = 0;
+            virtual void indent_extend() = 0;
+            virtual void indent_reduce() = 0;
+            virtual void no_indent() = 0;
+            virtual bool indent_pending() const = 0;
+            virtual void indent_pending(bool pending) = 0;
+              // indentation unit and current prefix size, text of an object depends on them
+            virtual std::pair<size_t, size_t> layout() const = 0;
+
+              // current position in the output stream
+            inline auto tell() const { return buffer.size(); }
+              // discard everything appended after the position (obtained via tell() earlier)
+            inline void discard_after(std::string::size_type pos) { buffer.erase(pos); }
+
+              // position and separator state to return to, if what is written after turns out to be unnecessary
+            struct mark_t { size_t position; bool insert_comma; bool indent_pending; };
+            inline mark_t mark() const { return {tell(), insert_comma, indent_pending()}; }
+            inline void rewind(const mark_t& aMark) { discard_after(aMark.position); insert_comma = aMark.insert_comma; indent_pending(aMark.indent_pending); }
+
+         public:
+            inline output(bool aMeasureOnly = false) : buffer(aMeasureOnly), insert_comma(false), sorted_keys(false), floats() {}
+            inline output(const output&) = default;
+            inline virtual ~output() = default;
+            inline operator std::string () const { return buffer.text(); }
+
+              // size of the output (counted even in measuring mode)
+            inline size_t size() const { return buffer.size(); }
+            inline void reserve(size_t size) { buffer.reserve(size); }
+              // deterministic output of unordered maps
+            inline void sort_keys() { sorted_keys = true; }
+              // default format of floating point numbers, fields made by json::field(&f, format) use their own
+            inline void set_float_format(const float_format& format) { floats = format; }
+              // moves the output text out, output is unusable afterwards
+            inline std::string release() { return buffer.release(); }
+
+            inline output& open(char c) { comma(false); indent_extend(); buffer.append(1, c); return *this; }
+            inline output& close(char c) { insert_comma = false; comma(true); indent_reduce(); buffer.append(1, c); return *this; }
+
+            inline output& append(const char* val) { buffer.append(1, '"'); buffer.append(val); buffer.append(1, '"'); return *this; }
+
+            template <typename T, typename std::enable_if<std::is_integral<T>{} || std::is_floating_point<T>{}>::type* = nullptr> inline output& append(T val)
+                {
+                    comma(true);
+                    indent_simple();
+                    append_value(val);
+                    return *this;
+                }
+
+            inline output& append(const std::string& val) { return append_string(val.data(), val.size()); }
+            inline output& append(const interned_string& val) { return append_string(val.data(), val.size()); }
+            inline output& append(const raw_string& val) { return append_string(val.data(), val.size()); }
+            template <typename E, typename std::enable_if<u::is_named_enum<E>{}>::type* = nullptr> inline output& append(E val) { size_t size; const char* name = enum_names<E>::get().at(val, size); return append_string(name, size); }
+
+            inline output& append(const blob& val)
+                {
+                    comma(true);
+                    indent_simple();
+                    buffer.append(1, '"');
+                    if (char* out = buffer.extend(base64::encoded_size(val.size())))
+                        base64::encode(val.data(), val.size(), out);
+                    buffer.append(1, '"');
+                    return *this;
+                }
+
+         private:
+            inline output& append_string(const char* val, size_t size)
+                {
+                    comma(true);
+                    indent_simple();
+                    buffer.append(1, '"');
+                    buffer.append(val, size);
+                    buffer.append(1, '"');
+                    return *this;
+                }
+
+            template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> inline void append_value(T val)
+                {
+                    if (floats.style() != float_format::shortest) {
+                        char text[max_formatted_float_size];
+                        if (const char* end = float_to_chars(text, static_cast<double>(val), floats)) {
+                            buffer.append(text, static_cast<size_t>(end - text));
+                            return;
+                        }
+                    }
+                    buffer.append(value_to_string(val));
+                }
+
+            template <typename T, typename std::enable_if<std::is_integral<T>{}>::type* = nullptr> inline void append_value(T val)
+                {
+                    if (buffer.measure_only()) {
+                        buffer.skip(integer_size(val));
+                    }
+                    else {
+                        char text[std::numeric_limits<T>::digits10 + 3];
+                        const char* begin = integer_to_chars(text + sizeof(text), val);
+                        buffer.append(begin, static_cast<size_t>(text + sizeof(text) - begin));
+                    }
+                }
+
+            inline void append_value(bool val)
+                {
+                    if (val)
+                        buffer.append("true", 4);
+                    else
+                        buffer.append("false", 5);
+                }
+
+         public:
+
+            // template <typename T, typename std::enable_if<std::is_integral<T>{} || std::is_floating_point<T>{} || std::is_convertible<T*, std::string*>{} || std::is_convertible<T*, bool*>{}>::type* = nullptr> inline output& append(const T& val)
+            //     {
+            //         return append(static_cast<typename std::remove_reference<T>::type>(val));
+            //     }
+
+            template <typename T> inline output& append(const char* key, const T& val)
+                {
+                    return append(key_ref(key, std::strlen(key), false), val);
+                }
+
+            template <typename T> inline output& append(const key_ref& key, const T& val)
+                {
+                    write_key(key);
+                    append(val);
+                    insert_comma = true;
+                    return *this;
+                }
+
+         private:
+            inline void write_key(const key_ref& key)
+                {
+                    comma(false);
+                    indent_simple();
+                    if (key.quoted) {
+                        buffer.append(key.text, key.size);
+                    }
+                    else {
+                        buffer.append(1, '"');
+                        buffer.append(key.text, key.size);
+                        buffer.append("\": ", 3);
+                    }
+                    no_indent();
+                }
+
+         public:
+
+              // ---- struct ------------------------------------------------------------------
+
+         private:
+            template <typename T> inline void append_field(const key_ref& key, T* val)
+                {
+                    append(key, *val);
+                }
+
+            template <typename G, typename S, typename P> inline void append_field(const key_ref& key, const field_t<G, S, P>& val)
+                {
+                    append(key, val);
+                }
+
+            template <typename T, typename Fields> inline void append_fields(Fields& fields)
+                {
+                    static const quoted_keys<T, Fields> keys(fields);
+                    u::for_each_field(fields, [this](size_t index, const char* key, auto& value) { this->append_field(keys.get(index, key), value); });
+                }
+
+         public:
+
+            template <typename T, typename std::enable_if<u::is_json_fields_defined<T>{} || u::is_json_fields_bool_defined<T>{}>::type* = nullptr> inline output& append(const T& val)
+                {
+                    const auto pos = tell();
+                    const auto comma_state = insert_comma;
+                    JSON_STRUCT_HOOK(object_begin(instrument::writing, typeid(T)));
+                    open('{');
+                    try {
+                        auto fields = u::call_json_fields(const_cast<T&>(val), true);
+                        append_fields<T>(fields);
+                        close('}');
+                    }
+                    catch (no_value&) { // json_fields thrown no_value, it means val should not appear in the output
+                        close('}');     // restore indentation state
+                        discard_after(pos); // discard whatever has been written
+                        insert_comma = comma_state;
+                        JSON_STRUCT_HOOK(skipped(typeid(T)));
+                    }
+                    JSON_STRUCT_HOOK(object_end(instrument::writing, typeid(T), tell() - pos));
+                    return *this;
+                }
+
+              // ---- vector, list, set ------------------------------------------------------------------
+
+         private:
+            template <typename T> class warray
+            {
+             public:
+                inline warray(const T& val) : mValue(val) {}
+                inline output& append_to(output& o)
+                    {
+                        o.open('[');
+                        if (!mValue.empty()) {
+                            for (auto& i: mValue) {
+                                JSON_STRUCT_HOOK(element(instrument::writing));
+                                o.append(i);
+                            }
+                        }
+                        else {
+                            o.no_indent();
+                        }
+                        return o.close(']');
+                    }
+             private:
+                const T& mValue;
+            };
+
+         public:
+            template <typename T> inline output& append(const std::set<T>& val)
+                {
+                    return warray<std::set<T>>(val).append_to(*this);
+                }
+
+            template <typename T> inline output& append(const flat_set<T>& val)
+                {
+                    return warray<flat_set<T>>(val).append_to(*this);
+                }
+
+            template <typename T> inline output& append(const std::vector<T>& val)
+                {
+                    return append_array(val, u::is_number<T>());
+                }
+
+            template <typename T, size_t N> inline output& append(const std::array<T, N>& val)
+                {
+                    return append_array(val, u::is_number<T>());
+                }
+
+            template <typename T> inline output& append(const std::list<T>& val)
+                {
+                    return warray<std::list<T>>(val).append_to(*this);
+                }
+
+              // ---- arrays of numbers ------------------------------------------------------------------
+
+         private:
+            template <typename C> inline output& append_array(const C& val, std::false_type)
+                {
+                    return warray<C>(val).append_to(*this);
+                }
+
+              // separator written before the second item (comma and indentation) is the same for all the
+              // following items, it is copied from the output, and the items are formatted in batches
+            template <typename C> inline output& append_array(const C& val, std::true_type)
+                {
+                    auto item = std::begin(val);
+                    const auto last = std::end(val);
+                    open('[');
+                    if (item == last) {
+                        no_indent();
+                        return close(']');
+                    }
+                    JSON_STRUCT_HOOK(element(instrument::writing));
+                    append(*item);
+                    if (++item != last) {
+                        const auto separator_start = tell();
+                        JSON_STRUCT_HOOK(element(instrument::writing));
+                        append(*item);
+                        const auto separator_size = tell() - separator_start - number_size(*item);
+                        char separator[64];
+                        if (separator_size > sizeof(separator)) { // deeply indented, batching is pointless
+                            for (++item; item != last; ++item) {
+                                JSON_STRUCT_HOOK(element(instrument::writing));
+                                append(*item);
+                            }
+                        }
+                        else {
+                            if (!buffer.measure_only())
+                                std::memcpy(separator, buffer.text().data() + separator_start, separator_size);
+                            append_numbers(++item, last, separator, separator_size);
+                        }
+                    }
+                    return close(']');
+                }
+
+            template <typename T, typename std::enable_if<std::is_integral<T>{}>::type* = nullptr> static inline size_t number_size(T val) { return integer_size(val); }
+            template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> inline size_t number_size(T val) const
+                {
+                    char text[max_formatted_float_size];
+                    if (floats.style() != float_format::shortest) {
+                        if (const char* end = float_to_chars(text, static_cast<double>(val), floats))
+                            return static_cast<size_t>(end - text);
+                    }
+                    return value_to_string(val).size();
+                }
+
+            template <typename I, typename std::enable_if<std::is_integral<typename std::iterator_traits<I>::value_type>{}>::type* = nullptr>
+                inline void append_numbers(I item, I last, const char* separator, size_t separator_size)
+                {
+                    typedef typename std::iterator_traits<I>::value_type T;
+                    constexpr size_t max_size = std::numeric_limits<T>::digits10 + 3;
+                    if (buffer.measure_only()) {
+                        for (; item != last; ++item) {
+                            JSON_STRUCT_HOOK(element(instrument::writing));
+                            buffer.skip(separator_size + integer_size(*item));
+                        }
+                    }
+                    else {
+                        char batch[4096];
+                        char* end = batch;
+                        char text[max_size];
+                        for (; item != last; ++item) {
+                            JSON_STRUCT_HOOK(element(instrument::writing));
+                            if (end + separator_size + max_size > batch + sizeof(batch)) {
+                                buffer.append(batch, static_cast<size_t>(end - batch));
+                                end = batch;
+                            }
+                            std::memcpy(end, separator, separator_size);
+                            end += separator_size;
+                            const char* begin = integer_to_chars(text + sizeof(text), *item);
+                            const auto size = static_cast<size_t>(text + sizeof(text) - begin);
+                            std::memcpy(end, begin, size);
+                            end += size;
+                        }
+                        buffer.append(batch, static_cast<size_t>(end - batch));
+                    }
+                }
+
+            template <typename I, typename std::enable_if<std::is_floating_point<typename std::iterator_traits<I>::value_type>{}>::type* = nullptr>
+                inline void append_numbers(I item, I last, const char* separator, size_t separator_size)
+                {
+                    for (; item != last; ++item) {
+                        JSON_STRUCT_HOOK(element(instrument::writing));
+                        if (buffer.measure_only())
+                            buffer.skip(separator_size);
+                        else
+                            buffer.append(separator, separator_size);
+                        append_value(*item);
+                    }
+                }
+
+         public:
+              // ---- map ------------------------------------------------------------------
+
+         private:
+            template <typename M> class wmap
+            {
+             public:
+                inline wmap(const M& val) : mValue(val) {}
+                inline output& append_to(output& o)
+                    {
+                        o.open('{');
+                        if (!mValue.empty()) {
+                            if (o.sorted_keys && !u::is_sorted_map<M>{}) {
+                                std::vector<const typename M::value_type*> members;
+                                members.reserve(mValue.size());
+                                for (auto& i: mValue)
+                                    members.push_back(&i);
+                                std::sort(members.begin(), members.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+                                for (auto* i: members)
+                                    append_member(o, *i);
+                            }
+                            else {
+                                for (auto& i: mValue)
+                                    append_member(o, i);
+                            }
+                        }
+                        else {
+                            o.no_indent();
+                        }
+                        return o.close('}');
+                    }
+             private:
+                const M& mValue;
+
+                static inline void append_member(output& o, const typename M::value_type& member)
+                    {
+                        JSON_STRUCT_HOOK(element(instrument::writing));
+                        o.append(key_ref(member.first.data(), member.first.size(), false), member.second);
+                    }
+            };
+
+         public:
+            template <typename M, typename std::enable_if<u::is_map<M>{}>::type* = nullptr> inline output& append(const M& val)
+                {
+                    return wmap<M>(val).append_to(*this);
+                }
+
+              // ---- field_t<G, S, P> ------------------------------------------------------------------
+
+         private:
+              // format of floating point numbers set while the value of a field is written
+            class float_scope
+            {
+             public:
+                inline float_scope(output& aOutput, const float_format& format) : mOutput(aOutput), mSaved(aOutput.floats) { mOutput.floats = format; }
+                inline ~float_scope() { mOutput.floats = mSaved; }
+             private:
+                output& mOutput;
+                float_format mSaved;
+            };
+
+            template <typename G, typename S, typename P> inline const float_format& field_float_format(const field_t<G, S, P>&) const { return floats; }
+            template <typename T, typename S, typename P> inline const float_format& field_float_format(const field_t<_float_format_getter<T>, S, P>& val) const { return val.getter().format(); }
+
+         public:
+
+            template <typename G, typename S, typename P> inline output& append(const key_ref& key, const field_t<G, S, P>& val)
+                {
+                    const float_scope scope(*this, field_float_format(val));
+                    try {
+                        return append(key, val.get()); // val.get() may throw no_value
+                    }
+                    catch (no_value&) {
+                        JSON_STRUCT_HOOK(skipped(typeid(typename field_t<G, S, P>::value_type)));
+                        return *this; // avoid writing key/value pair
+                    }
+                }
+
+            template <typename S, typename P> inline output& append(const key_ref& key, const _literal_field_t<S, P>& val)
+                {
+                    write_key(key);
+                    append_string(val.getter().text(), val.getter().size());
+                    insert_comma = true;
+                    return *this;
+                }
+
+              // ---- cached<T> ------------------------------------------------------------------
+
+            template <typename T> inline output& append(const cached<T>& val)
+                {
+                      // kept text may have unordered maps in another order or floats written in another format,
+                      // it is made and used with the default output only
+                    if (sorted_keys || floats.style() != float_format::shortest)
+                        return append(val.get());
+                    const auto current_layout = layout();
+                    if (val.mValid && val.mLayout == current_layout) {
+                        open('{');
+                        if (!val.mFragment.empty()) {
+                            buffer.append(val.mFragment);
+                            insert_comma = true;
+                            indent_pending(true);
+                        }
+                        return close('}');
+                    }
+                    const auto start = mark();
+                    open('{');
+                    const auto content = tell();
+                    try {
+                        auto fields = u::call_json_fields(const_cast<T&>(val.get()), true);
+                        append_fields<T>(fields);
+                    }
+                    catch (no_value&) { // json_fields thrown no_value, nothing is written and kept
+                        close('}');
+                        rewind(start);
+                        return *this;
+                    }
+                    if (!buffer.measure_only()) {
+                        val.mFragment.assign(buffer.text(), content, std::string::npos);
+                        val.mLayout = current_layout;
+                        val.mValid = true;
+                    }
+                    return close('}');
+                }
+
+              // ---- json::columnar ------------------------------------------------------------------
+
+         private:
+              // values of the field number K of the items written (json_fields() of the item does not throw no_value),
+              // range for append_array()
+            template <typename T, size_t K, typename V> class wcolumn
+            {
+             public:
+                class iterator
+                {
+                 public:
+                    typedef std::forward_iterator_tag iterator_category;
+                    typedef V value_type;
+                    typedef std::ptrdiff_t difference_type;
+                    typedef const V* pointer;
+                    typedef const V& reference;
+
+                    inline iterator(const T* aItem, const T* aLast) : mItem(aItem), mLast(aLast) { skip(); }
+                    inline const V& operator*() const { return *std::get<2 * K + 1>(u::call_json_fields(const_cast<T&>(*mItem), true)); }
+                    inline iterator& operator++() { ++mItem; skip(); return *this; }
+                    inline bool operator==(const iterator& other) const { return mItem == other.mItem; }
+                    inline bool operator!=(const iterator& other) const { return mItem != other.mItem; }
+
+                 private:
+                    const T* mItem;
+                    const T* mLast;
+
+                    inline void skip() { while (mItem != mLast && !in_output(*mItem)) ++mItem; }
+                };
+
+                inline wcolumn(const std::vector<T>& items) : mItems(items) {}
+                inline iterator begin() const { return iterator(mItems.data(), mItems.data() + mItems.size()); }
+                inline iterator end() const { return iterator(mItems.data() + mItems.size(), mItems.data() + mItems.size()); }
+                inline bool empty() const { return begin() == end(); }
+
+             private:
+                const std::vector<T>& mItems;
+            };
+
+            template <size_t K, typename T, typename V> inline void append_column(const key_ref& key, V*, const std::vector<T>& items)
+                {
+                    write_key(key);
+                    append_array(wcolumn<T, K, V>(items), u::is_number<V>());
+                    insert_comma = true;
+                }
+
+              // null is written for no_value thrown by the getter
+            template <size_t K, typename T, typename G, typename S, typename P> inline void append_column(const key_ref& key, const field_t<G, S, P>& field, const std::vector<T>& items)
+                {
+                    const float_scope scope(*this, field_float_format(field));
+                    write_key(key);
+                    open('[');
+                    bool empty = true;
+                    for (const auto& item: items) {
+                        if (!in_output(item))
+                            continue;
+                        JSON_STRUCT_HOOK(element(instrument::writing));
+                        empty = false;
+                        auto fields = u::call_json_fields(const_cast<T&>(item), true);
+                        try {
+                            append(std::get<2 * K + 1>(fields).get());
+                        }
+                        catch (no_value&) {
+                            comma(true);
+                            indent_simple();
+                            buffer.append("null", 4);
+                        }
+                    }
+                    if (empty)
+                        no_indent();
+                    close(']');
+                    insert_comma = true;
+                }
+
+            template <size_t K, typename T, typename S, typename P> inline void append_column(const key_ref&, const _literal_field_t<S, P>&, const std::vector<T>&) {}
+
+         public:
+              // every field of T is written, even if there are no items, keys are taken from a default constructed T
+            template <typename T> inline output& append(const columns<T>& val)
+                {
+                    T prototype{};
+                    auto fields = u::call_json_fields(prototype, false);
+                    static const quoted_keys<T, decltype(fields)> keys(fields);
+                    const auto& items = val.items();
+                    open('{');
+                    u::for_each_field(fields, [this, &items](auto index, const char* key, auto& field) { this->append_column<decltype(index)::value>(keys.get(index, key), field, items); });
+                    return close('}');
+                }
+
+              // ---- merge patch (RFC 7386) ------------------------------------------------------------------
+
+              // patch turning old_val into new_val: just changed members of objects and maps, whole value for anything else
+            template <typename T, typename std::enable_if<u::is_object<T>{} || u::is_map<T>{}>::type* = nullptr> inline output& append_diff(const T& old_val, const T& new_val)
+                {
+                    const auto start = mark();
+                    open('{');
+                    try {
+                        if (!diff_members(old_val, new_val))
+                            no_indent();
+                        close('}');
+                    }
+                    catch (no_value&) { // json_fields thrown no_value, patch is the whole new value
+                        close('}');
+                        rewind(start);
+                        append(new_val);
+                    }
+                    return *this;
+                }
+
+            template <typename T, typename std::enable_if<!u::is_object<T>{} && !u::is_map<T>{}>::type* = nullptr> inline output& append_diff(const T&, const T& new_val)
+                {
+                    return append(new_val);
+                }
+
+         private:
+            inline void append_null(const key_ref& key)
+                {
+                    write_key(key);
+                    comma(true);
+                    indent_simple();
+                    buffer.append("null", 4);
+                    insert_comma = true;
+                }
+
+            template <typename M, typename std::enable_if<u::is_map<M>{}>::type* = nullptr> static inline bool in_output(const M&) { return true; }
+
+            template <typename T, typename std::enable_if<u::is_object<T>{}>::type* = nullptr> static inline bool in_output(const T& val)
+                {
+                    try {
+                        u::call_json_fields(const_cast<T&>(val), true);
+                        return true;
+                    }
+                    catch (no_value&) {
+                        return false;
+                    }
+                }
+
+              // null removes map entry, i.e. NaN (written as null) cannot be passed as the new value of an entry
+            template <typename T, typename std::enable_if<!std::is_floating_point<T>{}>::type* = nullptr> static inline void check_entry(const std::string&, const T&) {}
+            template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> static inline void check_entry(const std::string& key, T value)
+                {
+                    if (std::isnan(value))
+                        throw std::invalid_argument("json::dump_diff: new value of map entry \"" + key + "\" is NaN, the patch would remove the entry");
+                }
+
+              // writes key and patch of the value if the value changed, returns if anything was written
+            template <typename T, typename std::enable_if<!u::is_object<T>{} && !u::is_map<T>{}>::type* = nullptr> inline bool diff_value(const key_ref& key, const T& old_val, const T& new_val)
+                {
+                    if (same_value(old_val, new_val))
+                        return false;
+                    append(key, new_val);
+                    return true;
+                }
+
+            template <typename T, typename std::enable_if<u::is_object<T>{} || u::is_map<T>{}>::type* = nullptr> inline bool diff_value(const key_ref& key, const T& old_val, const T& new_val)
+                {
+                    const auto start = mark();
+                    write_key(key);
+                    open('{');
+                    bool changed = false, present = true;
+                    try {
+                        changed = diff_members(old_val, new_val);
+                    }
+                    catch (no_value&) {
+                        present = false;
+                    }
+                    close('}');
+                    if (!changed)       // nothing inside, key is not written either
+                        rewind(start);
+                    if (present)
+                        return changed;
+                      // json_fields thrown no_value: object appears in or disappears from the output
+                    if (in_output(new_val)) {
+                        append(key, new_val);
+                        return true;
+                    }
+                    if (in_output(old_val)) {
+                        append_null(key);
+                        return true;
+                    }
+                    return false;
+                }
+
+            template <typename T> inline bool diff_value(const key_ref& key, const cached<T>& old_val, const cached<T>& new_val)
+                {
+                    return diff_value(key, old_val.get(), new_val.get());
+                }
+
+            template <typename T> inline bool diff_field(const key_ref& key, T* old_val, T* new_val)
+                {
+                    return diff_value(key, *old_val, *new_val);
+                }
+
+            template <typename G, typename S, typename P> inline bool diff_field(const key_ref& key, const field_t<G, S, P>& old_val, const field_t<G, S, P>& new_val)
+                {
+                    const float_scope scope(*this, field_float_format(new_val));
+                    bool old_present = true, new_present = true;
+                    typename field_t<G, S, P>::value_type old_value{}, new_value{};
+                    try { old_value = old_val.get(); } catch (no_value&) { old_present = false; }
+                    try { new_value = new_val.get(); } catch (no_value&) { new_present = false; }
+                    if (old_present && new_present)
+                        return diff_value(key, old_value, new_value);
+                    if (new_present)
+                        append(key, new_value);
+                    else if (old_present)
+                        append_null(key);
+                    return old_present || new_present;
+                }
+
+            template <typename S, typename P> inline bool diff_field(const key_ref& key, const _literal_field_t<S, P>& old_val, const _literal_field_t<S, P>& new_val)
+                {
+                    if (old_val.getter() == new_val.getter())
+                        return false;
+                    append(key, new_val);
+                    return true;
+                }
+
+              // may throw no_value before writing anything
+            template <typename T, typename std::enable_if<u::is_object<T>{}>::type* = nullptr> inline bool diff_members(const T& old_val, const T& new_val)
+                {
+                    auto old_fields = u::call_json_fields(const_cast<T&>(old_val), true);
+                    auto new_fields = u::call_json_fields(const_cast<T&>(new_val), true);
+                    static const quoted_keys<T, decltype(new_fields)> keys(new_fields);
+                    bool changed = false;
+                    u::for_each_field_pair(old_fields, new_fields, [this, &changed](size_t index, const char* key, auto& old_value, auto& new_value) {
+                            if (this->diff_field(keys.get(index, key), old_value, new_value))
+                                changed = true;
+                        });
+                    return changed;
+                }
+
+              // both maps are sorted by key, removed entries are written as null
+            template <typename M, typename std::enable_if<u::is_sorted_map<M>{}>::type* = nullptr> inline bool diff_members(const M& old_val, const M& new_val)
+                {
+                    bool changed = false;
+                    auto old_entry = old_val.begin();
+                    auto new_entry = new_val.begin();
+                    while (old_entry != old_val.end() || new_entry != new_val.end()) {
+                        if (new_entry == new_val.end() || (old_entry != old_val.end() && old_entry->first < new_entry->first)) {
+                            append_null(key_ref(old_entry->first.data(), old_entry->first.size(), false));
+                            changed = true;
+                            ++old_entry;
+                        }
+                        else if (old_entry == old_val.end() || new_entry->first < old_entry->first) {
+                            check_entry(new_entry->first, new_entry->second);
+                            append(key_ref(new_entry->first.data(), new_entry->first.size(), false), new_entry->second);
+                            changed = true;
+                            ++new_entry;
+                        }
+                        else {
+                            if (diff_value(key_ref(new_entry->first.data(), new_entry->first.size(), false), old_entry->second, new_entry->second)) {
+                                check_entry(new_entry->first, new_entry->second);
+                                changed = true;
+                            }
+                            ++old_entry;
+                            ++new_entry;
+                        }
+                    }
+                    return changed;
+                }
+
+              // removed entries are written as null first, then added and changed ones
+            template <typename T> inline bool diff_members(const std::unordered_map<std::string, T>& old_val, const std::unordered_map<std::string, T>& new_val)
+                {
+                    bool changed = false;
+                    for (const auto& old_entry: old_val) {
+                        if (new_val.find(old_entry.first) == new_val.end()) {
+                            append_null(key_ref(old_entry.first.data(), old_entry.first.size(), false));
+                            changed = true;
+                        }
+                    }
+                    for (const auto& new_entry: new_val) {
+                        const key_ref key(new_entry.first.data(), new_entry.first.size(), false);
+                        const auto old_entry = old_val.find(new_entry.first);
+                        if (old_entry == old_val.end()) {
+                            check_entry(new_entry.first, new_entry.second);
+                            append(key, new_entry.second);
+                            changed = true;
+                        }
+                        else if (diff_value(key, old_entry->second, new_entry.second)) {
+                            check_entry(new_entry.first, new_entry.second);
+                            changed = true;
+                        }
+                    }
+                    return changed;
+                }
+        };
+
+          // ----------------------------------------------------------------------
+
+        class output_compact : public output
+        {
+         public:
+            inline output_compact(bool aMeasureOnly = false) : output(aMeasureOnly), insert_space(false) {}
+
+         protected:
+            bool insert_space;
+
+            virtual inline void indent_simple() { if (insert_space) buffer.append(1, ' '); insert_space = true; }
+            virtual inline void indent_extend() { insert_space = false; }
+            virtual inline void indent_reduce() { insert_space = true; }
+            virtual inline void no_indent() { insert_space = false; }
+            virtual inline bool indent_pending() const { return insert_space; }
+            virtual inline void indent_pending(bool pending) { insert_space = pending; }
+            virtual inline std::pair<size_t, size_t> layout() const { return {0, 0}; }
+        };
+
+          // ----------------------------------------------------------------------
+
+        class output_pretty : public output
+        {
+         public:
+            inline output_pretty(size_t aIndent, bool aMeasureOnly = false) : output(aMeasureOnly), indent(aIndent), prefix(1, '\n'), insert_prefix(false) {}
+
+         protected:
+            virtual inline void indent_simple() { if (insert_prefix) buffer.append(prefix); insert_prefix = true; }
+            virtual inline void indent_extend() { indent_simple(); prefix.append(indent, ' '); }
+            virtual inline void indent_reduce() { prefix.erase(prefix.size() - indent); indent_simple(); }
+            virtual inline void no_indent() { insert_prefix = false; }
+            virtual inline bool indent_pending() const { return insert_prefix; }
+            virtual inline void indent_pending(bool pending) { insert_prefix = pending; }
+            virtual inline std::pair<size_t, size_t> layout() const { return {indent, prefix.size()}; }
+
+         private:
+            size_t indent;
+            std::string prefix;
+            bool insert_prefix;
+        };
+    }
+
+      // ----------------------------------------------------------------------
+
+    namespace w
+    {
+        template <typename T> inline std::string dump_document(output& o, const T& a)
+        {
+            JSON_STRUCT_PROBE(document_start, instrument::writing, 0);
+            JSON_STRUCT_HOOK(document_begin(instrument::writing, typeid(T)));
+            auto result = o.append(a).release();
+            JSON_STRUCT_HOOK(document_end(instrument::writing, typeid(T), result.size()));
+            JSON_STRUCT_PROBE(document_end, instrument::writing, result.size());
+            return result;
+        }
+
+        inline void set_option(output& o, sorted_keys_t) { o.sort_keys(); }
+        inline void set_option(output& o, const float_format& format) { o.set_float_format(format); }
+        inline void set_option(output&, exact_size_t) {} // see json::dump
+
+        template <typename... Option> inline void set_options(output& o, Option... option)
+        {
+            using expand = int[];
+            (void)expand{0, (set_option(o, option), 0)...};
+        }
+    }
+
+      // exact size of json::dump(a, indent, option...) output, nothing is stored
+    template <typename T, typename... Option> inline size_t dumped_size(const T& a, int indent = 0, Option... option)
+    {
+        if (indent <= 0) {
+            auto o = json::w::output_compact(true);
+            w::set_options(o, option...);
+            return o.append(a).size();
+        }
+        else {
+            auto o = json::w::output_pretty(static_cast<size_t>(indent), true);
+            w::set_options(o, option...);
+            return o.append(a).size();
+        }
+    }
+
+      // Options (can be combined):
+      //   json::exact_size: output is measured first and then written into the buffer allocated exactly once,
+      //   json::sorted_keys: unordered maps are written with sorted keys, i.e. output does not depend on hashing,
+      //   json::precision(n), json::fixed(n): floating point numbers are written so unless a field has its own format.
+    template <typename T, typename... Option> inline std::string dump(const T& a, int indent = 0, Option... option)
+    {
+        const size_t size = u::any_of({false, std::is_same<Option, exact_size_t>{}...}) ? dumped_size(a, indent, option...) : 0;
+        if (indent <= 0) {
+            auto o = json::w::output_compact();
+            w::set_options(o, option...);
+            o.reserve(size);
+            return w::dump_document(o, a);
+        }
+        else {
+            auto o = json::w::output_pretty(static_cast<size_t>(indent));
+            w::set_options(o, option...);
+            o.reserve(size);
+            return w::dump_document(o, a);
+        }
+    }
+
+      // RFC 7386 merge patch turning old_val into new_val: just changed fields and map entries are written,
+      // removed map entries and fields that are no longer output are null (see json::apply_patch),
+      // throws std::invalid_argument if a map entry becomes NaN (null would remove it)
+    template <typename T> inline std::string dump_diff(const T& old_val, const T& new_val, int indent = 0)
+    {
+        if (indent <= 0) {
+            auto o = json::w::output_compact();
+            return o.append_diff(old_val, new_val).release();
+        }
+        else {
+            auto o = json::w::output_pretty(static_cast<size_t>(indent));
+            return o.append_diff(old_val, new_val).release();
+        }
+    }
+
+      // ----------------------------------------------------------------------
+      // binary formats: CBOR (RFC 7049) and MessagePack
+      // ----------------------------------------------------------------------
+
+    namespace b
+    {
+        enum class container { array, map };
+
+        inline void write_be(char* at, uint64_t val, size_t bytes)
+        {
+            for (size_t i = bytes; i > 0; --i) {
+                at[i - 1] = static_cast<char>(val & 0xFF);
+                val >>= 8;
+            }
+        }
+
+        inline void append_be(std::string& out, uint64_t val, size_t bytes)
+        {
+            char data[8];
+            write_be(data, val, bytes);
+            out.append(data, bytes);
+        }
+
+        template <typename To, typename From> inline To bit_cast(From val)
+        {
+            static_assert(sizeof(To) == sizeof(From), "bit_cast: sizes differ");
+            To result;
+            std::memcpy(&result, &val, sizeof(result));
+            return result;
+        }
+
+          // ----------------------------------------------------------------------
+
+        class source
+        {
+         public:
+            inline source(const char* first, const char* last) : begin(reinterpret_cast<const unsigned char*>(first)), p(begin), end(reinterpret_cast<const unsigned char*>(last)) {}
+
+            [[noreturn]] inline void fail(std::string msg) const { throw parsing_error(msg + " at offset " + std::to_string(p - begin)); }
+            inline size_t remaining() const { return static_cast<size_t>(end - p); }
+            inline void need(size_t size) const { if (remaining() < size) fail("unexpected end of data"); }
+            inline unsigned peek() const { need(1); return *p; }
+            inline unsigned byte() { need(1); return *p++; }
+            inline uint64_t be(size_t bytes) { need(bytes); uint64_t result = 0; for (; bytes > 0; --bytes) result = (result << 8) | *p++; return result; }
+            inline const char* take(size_t size) { need(size); const auto result = reinterpret_cast<const char*>(p); p += size; return result; }
+
+         private:
+            const unsigned char* begin;
+            const unsigned char* p;
+            const unsigned char* end;
+        };
+
+          // integer read from binary data is -1 - value if negative (as cbor stores it),
+          // values out of the range of T fail as in json::parse
+        template <typename T> inline void store_integer(source& src, uint64_t value, bool negative, T& target)
+        {
+            if (negative) {
+                if (std::is_unsigned<T>{})
+                    src.fail("unsigned number expected");
+                if (value > static_cast<uint64_t>(-(static_cast<int64_t>(std::numeric_limits<T>::min()) + 1)))
+                    src.fail("number out of range");
+                target = static_cast<T>(-1 - static_cast<int64_t>(value));
+            }
+            else {
+                if (value > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+                    src.fail("number out of range");
+                target = static_cast<T>(value);
+            }
+        }
+
+        template <typename T> inline void store_integer(source& src, int64_t value, T& target)
+        {
+            if (value < 0)
+                store_integer(src, static_cast<uint64_t>(-1 - value), true, target);
+            else
+                store_integer(src, static_cast<uint64_t>(value), false, target);
+        }
+
+          // ----------------------------------------------------------------------
+
+        class cbor
+        {
+         public:
+            enum major_type : unsigned { unsigned_integer = 0, negative_integer = 1, byte_string = 2, text_string = 3, array = 4, map = 5 };
+
+            static inline void put_head(std::string& out, major_type major, uint64_t val)
+                {
+                    const auto type = static_cast<char>(major << 5);
+                    if (val < 24) {
+                        out.append(1, static_cast<char>(type | static_cast<char>(val)));
+                    }
+                    else {
+                        const size_t bytes = val <= 0xFF ? 1 : (val <= 0xFFFF ? 2 : (val <= 0xFFFFFFFF ? 4 : 8));
+                        out.append(1, static_cast<char>(type | additional(bytes + 1)));
+                        append_be(out, val, bytes);
+                    }
+                }
+
+            template <typename T, typename std::enable_if<std::is_signed<T>{}>::type* = nullptr> static inline void put_integer(std::string& out, T val)
+                {
+                    if (val < 0)
+                        put_head(out, negative_integer, static_cast<uint64_t>(-(static_cast<int64_t>(val) + 1)));
+                    else
+                        put_head(out, unsigned_integer, static_cast<uint64_t>(val));
+                }
+
+            template <typename T, typename std::enable_if<std::is_unsigned<T>{}>::type* = nullptr> static inline void put_integer(std::string& out, T val)
+                {
+                    put_head(out, unsigned_integer, val);
+                }
+
+            static inline void put_float(std::string& out, float val) { out.append(1, '\xFA'); append_be(out, bit_cast<uint32_t>(val), 4); }
+            static inline void put_double(std::string& out, double val) { out.append(1, '\xFB'); append_be(out, bit_cast<uint64_t>(val), 8); }
+            static inline void put_bool(std::string& out, bool val) { out.append(1, val ? '\xF5' : '\xF4'); }
+            static inline void put_null(std::string& out) { out.append(1, '\xF6'); }
+            static inline void put_string(std::string& out, const char* val, size_t size) { put_head(out, text_string, size); out.append(val, size); }
+            static inline void put_bytes(std::string& out, const unsigned char* val, size_t size) { put_head(out, byte_string, size); out.append(reinterpret_cast<const char*>(val), size); }
+
+              // containers are written with the header wide enough for max_count items
+              // and the actual number of items is put there when they are written
+            static inline size_t header_size(size_t max_count) { return max_count < 24 ? 1 : (max_count <= 0xFF ? 2 : (max_count <= 0xFFFF ? 3 : (max_count <= 0xFFFFFFFF ? 5 : 9))); }
+
+            static inline void write_header(char* at, container kind, size_t count, size_t header_size)
+                {
+                    const auto type = static_cast<char>((kind == container::array ? array : map) << 5);
+                    if (header_size == 1) {
+                        at[0] = static_cast<char>(type | static_cast<char>(count));
+                    }
+                    else {
+                        at[0] = static_cast<char>(type | additional(header_size));
+                        write_be(at + 1, count, header_size - 1);
+                    }
+                }
+
+            static inline uint64_t read_head(source& src, major_type major)
+                {
+                    const auto initial = src.peek();
+                    if ((initial >> 5) != major)
+                        src.fail("unexpected cbor major type " + std::to_string(initial >> 5) + ", expected " + std::to_string(major));
+                    src.byte();
+                    const auto info = initial & 0x1F;
+                    switch (info) {
+                      case 24: return src.be(1);
+                      case 25: return src.be(2);
+                      case 26: return src.be(4);
+                      case 27: return src.be(8);
+                      default:
+                          if (info > 27)
+                              src.fail("cbor indefinite length items are not supported");
+                          return info;
+                    }
+                }
+
+            static inline bool read_null(source& src)
+                {
+                    if (src.peek() != 0xF6)
+                        return false;
+                    src.byte();
+                    return true;
+                }
+
+            template <typename T> static inline void read_integer(source& src, T& target)
+                {
+                    if ((src.peek() >> 5) == negative_integer)
+                        store_integer(src, read_head(src, negative_integer), true, target);
+                    else
+                        store_integer(src, read_head(src, unsigned_integer), false, target);
+                }
+
+            template <typename T> static inline void read_integer_as_float(source& src, T& target)
+                {
+                    if ((src.peek() >> 5) == negative_integer)
+                        target = -1 - static_cast<T>(read_head(src, negative_integer));
+                    else
+                        target = static_cast<T>(read_head(src, unsigned_integer));
+                }
+
+            template <typename T> static inline void read_float(source& src, T& target)
+                {
+                    switch (src.peek()) {
+                      case 0xFA:
+                          src.byte();
+                          target = static_cast<T>(bit_cast<float>(static_cast<uint32_t>(src.be(4))));
+                          break;
+                      case 0xFB:
+                          src.byte();
+                          target = static_cast<T>(bit_cast<double>(src.be(8)));
+                          break;
+                      case 0xF6:
+                          src.byte();
+                          target = std::numeric_limits<T>::quiet_NaN();
+                          break;
+                      default:
+                          read_integer_as_float(src, target);
+                          break;
+                    }
+                }
+
+            static inline bool read_bool(source& src)
+                {
+                    switch (src.peek()) {
+                      case 0xF5: src.byte(); return true;
+                      case 0xF4: src.byte(); return false;
+                      default: src.fail("cbor bool expected");
+                    }
+                }
+
+            static inline std::pair<const char*, size_t> read_string(source& src)
+                {
+                    const auto size = static_cast<size_t>(read_head(src, text_string));
+                    return {src.take(size), size};
+                }
+
+            static inline std::pair<const char*, size_t> read_bytes(source& src)
+                {
+                    const auto size = static_cast<size_t>(read_head(src, byte_string));
+                    return {src.take(size), size};
+                }
+
+            static inline size_t read_header(source& src, container kind)
+                {
+                    return static_cast<size_t>(read_head(src, kind == container::array ? array : map));
+                }
+
+         private:
+              // additional information value of the initial byte for the head of header_size bytes
+            static inline char additional(size_t header_size) { return static_cast<char>(header_size == 2 ? 24 : (header_size == 3 ? 25 : (header_size == 5 ? 26 : 27))); }
+        };
+
+          // ----------------------------------------------------------------------
+
+        class msgpack
+        {
+         public:
+            template <typename T, typename std::enable_if<std::is_signed<T>{}>::type* = nullptr> static inline void put_integer(std::string& out, T val)
+                {
+                    if (val >= 0)
+                        put_unsigned(out, static_cast<uint64_t>(val));
+                    else if (val >= -32)
+                        out.append(1, static_cast<char>(val));
+                    else if (val >= std::numeric_limits<int8_t>::min())
+                        put_typed(out, '\xD0', static_cast<uint64_t>(val), 1);
+                    else if (val >= std::numeric_limits<int16_t>::min())
+                        put_typed(out, '\xD1', static_cast<uint64_t>(val), 2);
+                    else if (val >= std::numeric_limits<int32_t>::min())
+                        put_typed(out, '\xD2', static_cast<uint64_t>(val), 4);
+                    else
+                        put_typed(out, '\xD3', static_cast<uint64_t>(val), 8);
+                }
+
+            template <typename T, typename std::enable_if<std::is_unsigned<T>{}>::type* = nullptr> static inline void put_integer(std::string& out, T val)
+                {
+                    put_unsigned(out, val);
+                }
+
+            static inline void put_float(std::string& out, float val) { put_typed(out, '\xCA', bit_cast<uint32_t>(val), 4); }
+            static inline void put_double(std::string& out, double val) { put_typed(out, '\xCB', bit_cast<uint64_t>(val), 8); }
+            static inline void put_bool(std::string& out, bool val) { out.append(1, val ? '\xC3' : '\xC2'); }
+            static inline void put_null(std::string& out) { out.append(1, '\xC0'); }
+
+            static inline void put_string(std::string& out, const char* val, size_t size)
+                {
+                    if (size < 32)
+                        out.append(1, static_cast<char>(0xA0 | size));
+                    else if (size <= 0xFF)
+                        put_typed(out, '\xD9', size, 1);
+                    else if (size <= 0xFFFF)
+                        put_typed(out, '\xDA', size, 2);
+                    else
+                        put_typed(out, '\xDB', size, 4);
+                    out.append(val, size);
+                }
+
+            static inline void put_bytes(std::string& out, const unsigned char* val, size_t size)
+                {
+                    if (size <= 0xFF)
+                        put_typed(out, '\xC4', size, 1);
+                    else if (size <= 0xFFFF)
+                        put_typed(out, '\xC5', size, 2);
+                    else
+                        put_typed(out, '\xC6', size, 4);
+                    out.append(reinterpret_cast<const char*>(val), size);
+                }
+
+              // containers are written with the header wide enough for max_count items
+              // and the actual number of items is put there when they are written
+            static inline size_t header_size(size_t max_count) { return max_count <= 15 ? 1 : (max_count <= 0xFFFF ? 3 : 5); }
+
+            static inline void write_header(char* at, container kind, size_t count, size_t header_size)
+                {
+                    const bool array = kind == container::array;
+                    switch (header_size) {
+                      case 1:
+                          at[0] = static_cast<char>((array ? 0x90 : 0x80) | count);
+                          break;
+                      case 3:
+                          at[0] = array ? '\xDC' : '\xDE';
+                          write_be(at + 1, count, 2);
+                          break;
+                      default:
+                          at[0] = array ? '\xDD' : '\xDF';
+                          write_be(at + 1, count, 4);
+                          break;
+                    }
+                }
+
+            static inline bool read_null(source& src)
+                {
+                    if (src.peek() != 0xC0)
+                        return false;
+                    src.byte();
+                    return true;
+                }
+
+            template <typename T> static inline void read_integer(source& src, T& target)
+                {
+                    const auto type = src.peek();
+                    if (type < 0x80 || type >= 0xE0) {
+                        store_integer(src, static_cast<int64_t>(static_cast<int8_t>(src.byte())), target);
+                        return;
+                    }
+                    switch (type) {
+                      case 0xCC: src.byte(); store_integer(src, src.be(1), false, target); break;
+                      case 0xCD: src.byte(); store_integer(src, src.be(2), false, target); break;
+                      case 0xCE: src.byte(); store_integer(src, src.be(4), false, target); break;
+                      case 0xCF: src.byte(); store_integer(src, src.be(8), false, target); break;
+                      case 0xD0: src.byte(); store_integer(src, static_cast<int64_t>(static_cast<int8_t>(src.be(1))), target); break;
+                      case 0xD1: src.byte(); store_integer(src, static_cast<int64_t>(static_cast<int16_t>(src.be(2))), target); break;
+                      case 0xD2: src.byte(); store_integer(src, static_cast<int64_t>(static_cast<int32_t>(src.be(4))), target); break;
+                      case 0xD3: src.byte(); store_integer(src, static_cast<int64_t>(src.be(8)), target); break;
+                      default: src.fail("msgpack integer expected");
+                    }
+                }
+
+            template <typename T> static inline void read_integer_as_float(source& src, T& target)
+                {
+                    if (src.peek() == 0xCF) {
+                        src.byte();
+                        target = static_cast<T>(src.be(8));
+                    }
+                    else {
+                        int64_t val;
+                        read_integer(src, val);
+                        target = static_cast<T>(val);
+                    }
+                }
+
+            template <typename T> static inline void read_float(source& src, T& target)
+                {
+                    switch (src.peek()) {
+                      case 0xCA:
+                          src.byte();
+                          target = static_cast<T>(bit_cast<float>(static_cast<uint32_t>(src.be(4))));
+                          break;
+                      case 0xCB:
+                          src.byte();
+                          target = static_cast<T>(bit_cast<double>(src.be(8)));
+                          break;
+                      case 0xC0:
+                          src.byte();
+                          target = std::numeric_limits<T>::quiet_NaN();
+                          break;
+                      default:
+                          read_integer_as_float(src, target);
+                          break;
+                    }
+                }
+
+            static inline bool read_bool(source& src)
+                {
+                    switch (src.peek()) {
+                      case 0xC3: src.byte(); return true;
+                      case 0xC2: src.byte(); return false;
+                      default: src.fail("msgpack bool expected");
+                    }
+                }
+
+            static inline std::pair<const char*, size_t> read_string(source& src)
+                {
+                    const auto type = src.peek();
+                    size_t size;
+                    if ((type & 0xE0) == 0xA0) {
+                        src.byte();
+                        size = type & 0x1F;
+                    }
+                    else {
+                        switch (type) {
+                          case 0xD9: src.byte(); size = static_cast<size_t>(src.be(1)); break;
+                          case 0xDA: src.byte(); size = static_cast<size_t>(src.be(2)); break;
+                          case 0xDB: src.byte(); size = static_cast<size_t>(src.be(4)); break;
+                          default: src.fail("msgpack string expected");
+                        }
+                    }
+                    return {src.take(size), size};
+                }
+
+            static inline std::pair<const char*, size_t> read_bytes(source& src)
+                {
+                    size_t size;
+                    switch (src.peek()) {
+                      case 0xC4: src.byte(); size = static_cast<size_t>(src.be(1)); break;
+                      case 0xC5: src.byte(); size = static_cast<size_t>(src.be(2)); break;
+                      case 0xC6: src.byte(); size = static_cast<size_t>(src.be(4)); break;
+                      default: src.fail("msgpack bin expected");
+                    }
+                    return {src.take(size), size};
+                }
+
+            static inline size_t read_header(source& src, container kind)
+                {
+                    const bool array = kind == container::array;
+                    const auto type = src.peek();
+                    if ((type & 0xF0) == (array ? 0x90u : 0x80u)) {
+                        src.byte();
+                        return type & 0x0F;
+                    }
+                    if (type == (array ? 0xDCu : 0xDEu)) {
+                        src.byte();
+                        return static_cast<size_t>(src.be(2));
+                    }
+                    if (type == (array ? 0xDDu : 0xDFu)) {
+                        src.byte();
+                        return static_cast<size_t>(src.be(4));
+                    }
+                    src.fail(array ? "msgpack array expected" : "msgpack map expected");
+                }
+
+         private:
+            static inline void put_unsigned(std::string& out, uint64_t val)
+                {
+                    if (val < 0x80)
+                        out.append(1, static_cast<char>(val));
+                    else if (val <= 0xFF)
+                        put_typed(out, '\xCC', val, 1);
+                    else if (val <= 0xFFFF)
+                        put_typed(out, '\xCD', val, 2);
+                    else if (val <= 0xFFFFFFFF)
+                        put_typed(out, '\xCE', val, 4);
+                    else
+                        put_typed(out, '\xCF', val, 8);
+                }
+
+            static inline void put_typed(std::string& out, char type, uint64_t val, size_t bytes)
+                {
+                    out.append(1, type);
+                    append_be(out, val, bytes);
+                }
+        };
+
+          // ----------------------------------------------------------------------
+          // writer, Format is cbor or msgpack
+          // ----------------------------------------------------------------------
+
+        template <typename Format> class writer
+        {
+         public:
+            inline std::string release() { return std::move(buffer); }
+
+              // all append functions return false if nothing has been written (json_fields() threw json::no_value)
+
+            template <typename T, typename std::enable_if<std::is_integral<T>{}>::type* = nullptr> inline bool append(T val) { Format::put_integer(buffer, val); return true; }
+            inline bool append(bool val) { Format::put_bool(buffer, val); return true; }
+            inline bool append(float val) { Format::put_float(buffer, val); return true; }
+            inline bool append(double val) { Format::put_double(buffer, val); return true; }
+            inline bool append(long double val) { Format::put_double(buffer, static_cast<double>(val)); return true; }
+            inline bool append(const std::string& val) { Format::put_string(buffer, val.data(), val.size()); return true; }
+            inline bool append(const interned_string& val) { Format::put_string(buffer, val.data(), val.size()); return true; }
+            inline bool append(const raw_string& val) { Format::put_string(buffer, val.data(), val.size()); return true; }
+            inline bool append(const blob& val) { Format::put_bytes(buffer, val.data(), val.size()); return true; }
+            template <typename E, typename std::enable_if<u::is_named_enum<E>{}>::type* = nullptr> inline bool append(E val) { size_t size; const char* name = enum_names<E>::get().at(val, size); Format::put_string(buffer, name, size); return true; }
+
+            template <typename T, typename std::enable_if<u::is_json_fields_defined<T>{} || u::is_json_fields_bool_defined<T>{}>::type* = nullptr> inline bool append(const T& val)
+                {
+                    const auto pos = buffer.size();
+                    try {
+                        auto fields = u::call_json_fields(const_cast<T&>(val), true);
+                        const auto header_size = Format::header_size(std::tuple_size<decltype(fields)>::value / 2);
+                        buffer.append(header_size, '\0');
+                        size_t count = 0;
+                        u::for_each_field(fields, [this, &count](size_t, const char* key, auto& value) { count += this->append_field(key, value); });
+                        Format::write_header(&buffer[pos], container::map, count, header_size);
+                        return true;
+                    }
+                    catch (no_value&) { // json_fields thrown no_value, it means val should not appear in the output
+                        buffer.erase(pos);
+                        return false;
+                    }
+                }
+
+            template <typename T> inline bool append(const cached<T>& val) { return append(val.get()); }
+
+            template <typename T> inline bool append(const std::vector<T>& val) { return append_array(val); }
+            template <typename T> inline bool append(const std::list<T>& val) { return append_array(val); }
+            template <typename T> inline bool append(const std::set<T>& val) { return append_array(val); }
+            template <typename T> inline bool append(const flat_set<T>& val) { return append_array(val); }
+            template <typename T, size_t N> inline bool append(const std::array<T, N>& val) { return append_array(val); }
+
+            template <typename M, typename std::enable_if<u::is_map<M>{}>::type* = nullptr> inline bool append(const M& val)
+                {
+                    const auto header_size = Format::header_size(val.size());
+                    const auto pos = buffer.size();
+                    buffer.append(header_size, '\0');
+                    size_t count = 0;
+                    for (const auto& item: val)
+                        count += append_key_value(item.first.data(), item.first.size(), item.second);
+                    Format::write_header(&buffer[pos], container::map, count, header_size);
+                    return true;
+                }
+
+              // json::columnar, map of arrays
+            template <typename T> inline bool append(const columns<T>& val)
+                {
+                    T prototype{};
+                    auto fields = u::call_json_fields(prototype, false);
+                    const auto header_size = Format::header_size(std::tuple_size<decltype(fields)>::value / 2);
+                    const auto pos = buffer.size();
+                    buffer.append(header_size, '\0');
+                    size_t count = 0;
+                    const auto& items = val.items();
+                    u::for_each_field(fields, [this, &count, &items](auto index, const char* key, auto& field) { count += this->append_column<decltype(index)::value>(key, field, items); });
+                    Format::write_header(&buffer[pos], container::map, count, header_size);
+                    return true;
+                }
+
+         private:
+            std::string buffer;
+
+            template <typename T> static inline bool in_output(const T& val)
+                {
+                    try {
+                        u::call_json_fields(const_cast<T&>(val), true);
+                        return true;
+                    }
+                    catch (no_value&) {
+                        return false;
+                    }
+                }
+
+            template <size_t K, typename T, typename F> inline bool append_column(const char* key, const F&, const std::vector<T>& items)
+                {
+                    Format::put_string(buffer, key, std::strlen(key));
+                    const auto header_size = Format::header_size(items.size());
+                    const auto pos = buffer.size();
+                    buffer.append(header_size, '\0');
+                    size_t count = 0;
+                    for (const auto& item: items) {
+                        if (!in_output(item))
+                            continue;
+                        auto fields = u::call_json_fields(const_cast<T&>(item), true);
+                        count += append_column_item(std::get<2 * K + 1>(fields));
+                    }
+                    Format::write_header(&buffer[pos], container::array, count, header_size);
+                    return true;
+                }
+
+            template <size_t K, typename T, typename S, typename P> inline bool append_column(const char*, const _literal_field_t<S, P>&, const std::vector<T>&) { return false; }
+
+            template <typename V> inline bool append_column_item(V* val) { return append(*val); }
+
+              // null is written for no_value thrown by the getter
+            template <typename G, typename S, typename P> inline bool append_column_item(const field_t<G, S, P>& val)
+                {
+                    try {
+                        return append(val.get());
+                    }
+                    catch (no_value&) {
+                        Format::put_null(buffer);
+                        return true;
+                    }
+                }
+
+            template <typename C> inline bool append_array(const C& val)
+                {
+                    const auto header_size = Format::header_size(val.size());
+                    const auto pos = buffer.size();
+                    buffer.append(header_size, '\0');
+                    size_t count = 0;
+                    for (const auto& item: val)
+                        count += append(item);
+                    Format::write_header(&buffer[pos], container::array, count, header_size);
+                    return true;
+                }
+
+            template <typename T> inline bool append_key_value(const char* key, size_t key_size, const T& val)
+                {
+                    const auto pos = buffer.size();
+                    Format::put_string(buffer, key, key_size);
+                    if (append(val))
+                        return true;
+                    buffer.erase(pos);
+                    return false;
+                }
+
+            template <typename T> inline bool append_field(const char* key, T* val)
+                {
+                    return append_key_value(key, std::strlen(key), *val);
+                }
+
+            template <typename G, typename S, typename P> inline bool append_field(const char* key, const field_t<G, S, P>& val)
+                {
+                    try {
+                        return append_key_value(key, std::strlen(key), val.get()); // val.get() may throw no_value
+                    }
+                    catch (no_value&) {
+                        return false; // avoid writing key/value pair
+                    }
+                }
+
+            template <typename S, typename P> inline bool append_field(const char* key, const _literal_field_t<S, P>& val)
+                {
+                    Format::put_string(buffer, key, std::strlen(key));
+                    Format::put_string(buffer, val.getter().text(), val.getter().size());
+                    return true;
+                }
+        };
+
+          // ----------------------------------------------------------------------
+          // reader, Format is cbor or msgpack
+          // ----------------------------------------------------------------------
+
+        template <typename Format> class reader
+        {
+         public:
+            inline reader(const char* first, const char* last, string_pool* aStrings = nullptr) : src(first, last), strings(aStrings) {}
+
+            template <typename T, typename std::enable_if<std::is_integral<T>{}>::type* = nullptr> inline void read(T& target) { Format::read_integer(src, target); }
+            template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> inline void read(T& target) { Format::read_float(src, target); }
+            inline void read(bool& target) { target = Format::read_bool(src); }
+
+            inline void read(std::string& target)
+                {
+                    if (Format::read_null(src)) {
+                        target.clear();
+                    }
+                    else {
+                        const auto val = Format::read_string(src);
+                        target.assign(val.first, val.second);
+                    }
+                }
+
+              // points into the source buffer
+            inline void read(raw_string& target)
+                {
+                    if (Format::read_null(src)) {
+                        target = raw_string();
+                    }
+                    else {
+                        const auto val = Format::read_string(src);
+                        target = raw_string(val.first, val.second);
+                    }
+                }
+
+            inline void read(blob& target)
+                {
+                    if (Format::read_null(src)) {
+                        target.clear();
+                    }
+                    else {
+                        const auto val = Format::read_bytes(src);
+                        target.assign(val.first, val.second);
+                    }
+                }
+
+            template <typename E, typename std::enable_if<u::is_named_enum<E>{}>::type* = nullptr> inline void read(E& target)
+                {
+                    const auto val = Format::read_string(src);
+                    if (!enum_names<E>::get().value(val.first, val.second, target))
+                        src.fail("unknown enum value name \"" + std::string(val.first, val.second) + "\"");
+                }
+
+              // values are added to the pool given by json::interning(pool)
+            inline void read(interned_string& target)
+                {
+                    if (Format::read_null(src)) {
+                        target = interned_string();
+                    }
+                    else {
+                        const auto val = Format::read_string(src);
+                        if (val.second == 0)
+                            target = interned_string();
+                        else if (strings)
+                            target = strings->intern(val.first, val.second);
+                        else
+                            src.fail("interned_string value needs json::interning(pool)");
+                    }
+                }
+
+            template <typename T, typename std::enable_if<u::is_json_fields_defined<T>{} || u::is_json_fields_bool_defined<T>{}>::type* = nullptr> inline void read(T& target)
+                {
+                    auto fields = u::call_json_fields(target, false);
+                    size_t next = 0; // fields are written in the json_fields() order
+                    for (auto count = Format::read_header(src, container::map); count > 0; --count) {
+                        const auto key = Format::read_string(src);
+                        if (!u::find_field(fields, key.first, key.second, [this, &next](size_t index, auto& value) { this->read_field(value); next = index + 1; }, next))
+                            src.fail("unknown key \"" + std::string(key.first, key.second) + "\"");
+                    }
+                }
+
+              // Note use method for arrays only if there is no json_fields(T&) defined
+            template <typename T, typename std::enable_if<u::is_emplace_back_defined<T>{} && !u::is_json_fields_defined<T>{} && !u::is_json_fields_bool_defined<T>{}>::type* = nullptr> inline void read(T& target)
+                {
+                    const auto count = Format::read_header(src, container::array);
+                    target.clear();
+                    u::reserve(target, std::min(count, src.remaining())); // every item takes at least one byte
+                    for (size_t no = 0; no < count; ++no) {
+                        target.emplace_back();
+                        read(target.back());
+                    }
+                }
+
+            template <typename T> inline void read(cached<T>& target)
+                {
+                    read(target.modify());
+                }
+
+              // json::columnar, the first array read adds items
+            template <typename T> inline void read(columns<T>& target)
+                {
+                    std::vector<T>& items = target.parsed();
+                    T prototype{};
+                    auto fields = u::call_json_fields(prototype, false);
+                    bool sized = false;
+                    size_t next = 0;
+                    for (auto count = Format::read_header(src, container::map); count > 0; --count) {
+                        const auto key = Format::read_string(src);
+                        if (!u::find_field(fields, key.first, key.second, [this, &items, &sized, &next](auto index, auto&) { this->read_column<decltype(index)::value>(items, sized); next = index + 1; }, next))
+                            src.fail("unknown key \"" + std::string(key.first, key.second) + "\"");
+                    }
+                }
+
+            template <typename T> inline void read(std::set<T>& target) { read_set(target); }
+            template <typename T> inline void read(flat_set<T>& target) { read_set(target); }
+
+            template <typename T, size_t N> inline void read(std::array<T, N>& target)
+                {
+                    const auto count = Format::read_header(src, container::array);
+                    if (count != N)
+                        src.fail(std::to_string(count) + " array elements found, " + std::to_string(N) + " expected");
+                    for (auto& item: target)
+                        read(item);
+                }
+
+            template <typename M, typename std::enable_if<u::is_map<M>{}>::type* = nullptr> inline void read(M& target)
+                {
+                    target.clear();
+                    auto count = Format::read_header(src, container::map);
+                    u::reserve(target, std::min(count, src.remaining() / 2)); // key and value take at least one byte each
+                    for (; count > 0; --count) {
+                        const auto key = Format::read_string(src);
+                        typename M::mapped_type item;
+                        read(item);
+                        target.emplace_hint(target.end(), std::string(key.first, key.second), std::move(item));
+                    }
+                }
+
+         private:
+            source src;
+            string_pool* strings;  // for interned_string values
+
+            template <typename C> inline void read_set(C& target)
+                {
+                    target.clear();
+                    auto count = Format::read_header(src, container::array);
+                    u::reserve(target, std::min(count, src.remaining()));
+                    for (; count > 0; --count) {
+                        typename C::value_type item;
+                        read(item);
+                        target.insert(target.end(), std::move(item));
+                    }
+                }
+
+            template <typename T> inline void read_field(T* target)
+                {
+                    read(*target);
+                }
+
+            template <typename G, typename S, typename P> inline void read_field(field_t<G, S, P>& target)
+                {
+                    typename field_t<G, S, P>::value_type value;
+                    read(value);
+                    target.setter()(std::move(value));
+                }
+
+            template <size_t K, typename T> inline void read_column(std::vector<T>& items, bool& sized)
+                {
+                    const auto count = Format::read_header(src, container::array);
+                    if (sized && count != items.size())
+                        src.fail("columns of different sizes");
+                    if (!sized)
+                        items.reserve(std::min(count, src.remaining())); // every item takes at least one byte
+                    for (size_t no = 0; no < count; ++no) {
+                        if (!sized)
+                            items.emplace_back();
+                        auto fields = u::call_json_fields(items[no], false);
+                        read_column_item(std::get<2 * K + 1>(fields));
+                    }
+                    sized = true;
+                }
+
+            template <typename V> inline void read_column_item(V* target) { read(*target); }
+
+              // null is written for json::no_value, the setter is not called
+            template <typename G, typename S, typename P> inline void read_column_item(field_t<G, S, P>& target)
+                {
+                    if (!Format::read_null(src))
+                        read_field(target);
+                }
+        };
+    }
+
+      // ----------------------------------------------------------------------
+
+    template <typename T> inline std::string dump_cbor(const T& a)
+    {
+        b::writer<b::cbor> writer;
+        writer.append(a);
+        return writer.release();
+    }
+
+    template <typename T> inline void parse_cbor(const char* first, const char* last, T& target)
+    {
+        b::reader<b::cbor>(first, last).read(target);
+    }
+
+      // interned_string values are added to the given pool
+    template <typename T> inline void parse_cbor(const char* first, const char* last, T& target, interning_t interning)
+    {
+        b::reader<b::cbor>(first, last, interning.pool).read(target);
+    }
+
+    template <typename T, typename... Option> inline void parse_cbor(const std::string& source, T& target, Option... option)
+    {
+        parse_cbor(source.data(), source.data() + source.size(), target, option...);
+    }
+
+    template <typename T> inline std::string dump_msgpack(const T& a)
+    {
+        b::writer<b::msgpack> writer;
+        writer.append(a);
+        return writer.release();
+    }
+
+    template <typename T> inline void parse_msgpack(const char* first, const char* last, T& target)
+    {
+        b::reader<b::msgpack>(first, last).read(target);
+    }
+
+    template <typename T> inline void parse_msgpack(const char* first, const char* last, T& target, interning_t interning)
+    {
+        b::reader<b::msgpack>(first, last, interning.pool).read(target);
+    }
+
+    template <typename T, typename... Option> inline void parse_msgpack(const std::string& source, T& target, Option... option)
+    {
+        parse_msgpack(source.data(), source.data() + source.size(), target, option...);
+    }
+
+      // ----------------------------------------------------------------------
+      // snapshot: offset based binary layout read in place (e.g. from a memory mapped file)
+      // ----------------------------------------------------------------------
+      //
+      // Header: "jssnap01", kind of the root value, slot of the root value.
+      // Every value is referenced by 8 bytes slot holding either the value itself (numbers, bools)
+      // or the offset of its record. Records are 8 bytes aligned:
+      //   string:             size, chars, '\0'
+      //   array of numbers:   count, items (of their own type, contiguous)
+      //   array of others:    count, slots
+      //   map:                count, (offset of key string, slot of value) pairs sorted by key
+      //   object:             offset of shape, presence bits, slots in the order of the shape fields
+      //   shape:              number of fields, (offset of key string, kind) pairs, one per type
+      // Data is in the native byte order, snapshot is to be read on the same architecture.
+
+    namespace snapshot
+    {
+        enum class kind : uint64_t { signed_integer = 1, unsigned_integer, floating, boolean, string, array, map, object };
+
+        constexpr const char magic[] = "jssnap01";
+        constexpr size_t header_size = 24;
+
+        using u::is_array;
+        using u::is_map;
+        using u::is_object;
+
+        template <typename T, typename std::enable_if<std::is_same<T, bool>{}>::type* = nullptr> constexpr kind kind_of() { return kind::boolean; }
+        template <typename T, typename std::enable_if<std::is_integral<T>{} && std::is_signed<T>{}>::type* = nullptr> constexpr kind kind_of() { return kind::signed_integer; }
+        template <typename T, typename std::enable_if<std::is_integral<T>{} && std::is_unsigned<T>{} && !std::is_same<T, bool>{}>::type* = nullptr> constexpr kind kind_of() { return kind::unsigned_integer; }
+        template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> constexpr kind kind_of() { return kind::floating; }
+        template <typename T, typename std::enable_if<std::is_same<T, std::string>{} || std::is_same<T, interned_string>{} || std::is_same<T, raw_string>{} || std::is_same<T, blob>{} || u::is_named_enum<T>{}>::type* = nullptr> constexpr kind kind_of() { return kind::string; }
+        template <typename T, typename std::enable_if<is_array<T>{} || u::is_columns<T>{}>::type* = nullptr> constexpr kind kind_of() { return kind::array; }
+        template <typename T, typename std::enable_if<is_map<T>{}>::type* = nullptr> constexpr kind kind_of() { return kind::map; }
+        template <typename T, typename std::enable_if<is_object<T>{}>::type* = nullptr> constexpr kind kind_of() { return kind::object; }
+
+        inline uint64_t to_slot(bool val) { return val ? 1 : 0; }
+        template <typename T, typename std::enable_if<std::is_integral<T>{} && std::is_signed<T>{}>::type* = nullptr> inline uint64_t to_slot(T val) { return static_cast<uint64_t>(static_cast<int64_t>(val)); }
+        template <typename T, typename std::enable_if<std::is_integral<T>{} && std::is_unsigned<T>{}>::type* = nullptr> inline uint64_t to_slot(T val) { return static_cast<uint64_t>(val); }
+        template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> inline uint64_t to_slot(T val) { return b::bit_cast<uint64_t>(static_cast<double>(val)); }
+
+        template <typename T, typename std::enable_if<std::is_same<T, bool>{}>::type* = nullptr> inline T from_slot(uint64_t slot) { return slot != 0; }
+        template <typename T, typename std::enable_if<std::is_integral<T>{} && std::is_signed<T>{}>::type* = nullptr> inline T from_slot(uint64_t slot) { return static_cast<T>(static_cast<int64_t>(slot)); }
+        template <typename T, typename std::enable_if<std::is_integral<T>{} && std::is_unsigned<T>{} && !std::is_same<T, bool>{}>::type* = nullptr> inline T from_slot(uint64_t slot) { return static_cast<T>(slot); }
+        template <typename T, typename std::enable_if<std::is_floating_point<T>{}>::type* = nullptr> inline T from_slot(uint64_t slot) { return static_cast<T>(b::bit_cast<double>(slot)); }
+
+        template <typename T> inline const void* address_of(T* field) { return field; }
+        template <typename G, typename S, typename P> inline const void* address_of(const field_t<G, S, P>&) { return nullptr; }
+
+        template <typename T> constexpr kind field_kind(T*) { return kind_of<T>(); }
+        template <typename G, typename S, typename P> constexpr kind field_kind(const field_t<G, S, P>&) { return kind_of<typename field_t<G, S, P>::value_type>(); }
+
+          // ----------------------------------------------------------------------
+
+        class writer
+        {
+         public:
+            inline writer() : buffer(header_size, '\0') { std::memcpy(&buffer[0], magic, 8); }
+
+            template <typename T> inline std::string dump(const T& val)
+                {
+                    uint64_t root = 0;
+                    slot(val, root);
+                    patch(8, static_cast<uint64_t>(kind_of<T>()));
+                    patch(16, root);
+                    return std::move(buffer);
+                }
+
+         private:
+            std::string buffer;
+            std::unordered_map<std::type_index, uint64_t> shapes;
+
+            inline void align() { buffer.append((8 - buffer.size() % 8) % 8, '\0'); }
+            inline void append_word(uint64_t val) { buffer.append(reinterpret_cast<const char*>(&val), sizeof(val)); }
+            inline void patch(size_t pos, uint64_t val) { std::memcpy(&buffer[pos], &val, sizeof(val)); }
+            inline uint64_t word(size_t pos) const { uint64_t val; std::memcpy(&val, &buffer[pos], sizeof(val)); return val; }
+
+            inline uint64_t string_record(const char* val, size_t size)
+                {
+                    align();
+                    const auto offset = buffer.size();
+                    append_word(size);
+                    buffer.append(val, size);
+                    buffer.append(1, '\0');
+                    return offset;
+                }
+
+              // all slot functions return false if value is not written (json_fields() threw json::no_value)
+
+            template <typename T, typename std::enable_if<std::is_arithmetic<T>{}>::type* = nullptr> inline bool slot(T val, uint64_t& result)
+                {
+                    result = to_slot(val);
+                    return true;
+                }
+
+            inline bool slot(const std::string& val, uint64_t& result)
+                {
+                    result = string_record(val.data(), val.size());
+                    return true;
+                }
+
+            inline bool slot(const interned_string& val, uint64_t& result)
+                {
+                    result = string_record(val.data(), val.size());
+                    return true;
+                }
+
+            inline bool slot(const raw_string& val, uint64_t& result)
+                {
+                    result = string_record(val.data(), val.size());
+                    return true;
+                }
+
+            inline bool slot(const blob& val, uint64_t& result)
+                {
+                    result = string_record(reinterpret_cast<const char*>(val.data()), val.size());
+                    return true;
+                }
+
+            template <typename E, typename std::enable_if<u::is_named_enum<E>{}>::type* = nullptr> inline bool slot(E val, uint64_t& result)
+                {
+                    size_t size;
+                    const char* name = enum_names<E>::get().at(val, size);
+                    result = string_record(name, size);
+                    return true;
+                }
+
+            template <typename T, typename std::enable_if<is_array<T>{} && std::is_arithmetic<typename T::value_type>{}>::type* = nullptr> inline bool slot(const T& val, uint64_t& result)
+                {
+                    align();
+                    result = buffer.size();
+                    append_word(val.size());
+                    append_items(val);
+                    return true;
+                }
+
+            template <typename T, typename std::enable_if<std::is_arithmetic<T>{} && !std::is_same<T, bool>{}>::type* = nullptr> inline void append_items(const std::vector<T>& val)
+                {
+                    buffer.append(reinterpret_cast<const char*>(val.data()), val.size() * sizeof(T));
+                }
+
+            template <typename T, size_t N, typename std::enable_if<std::is_arithmetic<T>{} && !std::is_same<T, bool>{}>::type* = nullptr> inline void append_items(const std::array<T, N>& val)
+                {
+                    buffer.append(reinterpret_cast<const char*>(val.data()), N * sizeof(T));
+                }
+
+            template <typename C> inline void append_items(const C& val)
+                {
+                    for (typename C::value_type item: val)
+                        buffer.append(reinterpret_cast<const char*>(&item), sizeof(item));
+                }
+
+            template <typename T, typename std::enable_if<is_array<T>{} && !std::is_arithmetic<typename T::value_type>{}>::type* = nullptr> inline bool slot(const T& val, uint64_t& result)
+                {
+                    align();
+                    const auto offset = buffer.size();
+                    append_word(0);
+                    buffer.append(val.size() * 8, '\0');
+                    size_t count = 0;
+                    for (const auto& item: val) {
+                        uint64_t item_slot;
+                        if (slot(item, item_slot))
+                            patch(offset + 8 + 8 * count++, item_slot);
+                    }
+                    patch(offset, count);
+                    result = offset;
+                    return true;
+                }
+
+              // json::columnar is stored as the array of objects, views and field access are the same
+            template <typename T> inline bool slot(const columns<T>& val, uint64_t& result)
+                {
+                    return slot(val.items(), result);
+                }
+
+            template <typename M, typename std::enable_if<u::is_sorted_map<M>{}>::type* = nullptr> inline bool slot(const M& val, uint64_t& result)
+                {
+                    return members_slot(val, result);
+                }
+
+              // keys are looked up by binary search, they are stored sorted
+            template <typename T> inline bool slot(const std::unordered_map<std::string, T>& val, uint64_t& result)
+                {
+                    std::vector<const typename std::unordered_map<std::string, T>::value_type*> members;
+                    members.reserve(val.size());
+                    for (const auto& item: val)
+                        members.push_back(&item);
+                    std::sort(members.begin(), members.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+                    return members_slot(members, result);
+                }
+
+            template <typename V> static inline const V& member(const V& item) { return item; }
+            template <typename V> static inline const V& member(const V* item) { return *item; }
+
+              // members: sorted map or vector of pointers to its entries
+            template <typename Members> inline bool members_slot(const Members& members, uint64_t& result)
+                {
+                    align();
+                    const auto offset = buffer.size();
+                    append_word(0);
+                    buffer.append(members.size() * 16, '\0');
+                    size_t count = 0;
+                    for (const auto& entry: members) {
+                        const auto& item = member(entry);
+                        uint64_t item_slot;
+                        if (slot(item.second, item_slot)) {
+                            patch(offset + 8 + 16 * count, string_record(item.first.data(), item.first.size()));
+                            patch(offset + 16 + 16 * count, item_slot);
+                            ++count;
+                        }
+                    }
+                    patch(offset, count);
+                    result = offset;
+                    return true;
+                }
+
+            template <typename T, typename std::enable_if<is_object<T>{}>::type* = nullptr> inline bool slot(const T& val, uint64_t& result)
+                {
+                    const auto pos = buffer.size();
+                    try {
+                        auto fields = u::call_json_fields(const_cast<T&>(val), true);
+                        constexpr size_t number_of_fields = std::tuple_size<decltype(fields)>::value / 2;
+                        constexpr size_t presence_words = (number_of_fields + 63) / 64;
+                        const auto shape = shape_of<T>(fields);
+                        align();
+                        const auto offset = buffer.size();
+                        append_word(shape);
+                        buffer.append((presence_words + number_of_fields) * 8, '\0');
+                        u::for_each_field(fields, [this, offset](size_t index, const char*, auto& value) {
+                                uint64_t field_slot;
+                                if (this->field_slot(value, field_slot)) {
+                                    const auto presence = offset + 8 + 8 * (index / 64);
+                                    this->patch(presence, this->word(presence) | (uint64_t(1) << (index % 64)));
+                                    this->patch(offset + 8 * (1 + presence_words + index), field_slot);
+                                }
+                            });
+                        result = offset;
+                        return true;
+                    }
+                    catch (no_value&) { // json_fields thrown no_value, it means val should not appear in the output
+                        buffer.erase(pos);
+                        return false;
+                    }
+                }
+
+            template <typename T> inline bool field_slot(T* val, uint64_t& result)
+                {
+                    return slot(*val, result);
+                }
+
+            template <typename G, typename S, typename P> inline bool field_slot(const field_t<G, S, P>& val, uint64_t& result)
+                {
+                    try {
+                        return slot(val.get(), result); // val.get() may throw no_value
+                    }
+                    catch (no_value&) {
+                        return false;
+                    }
+                }
+
+            template <typename T, typename Fields> inline uint64_t shape_of(Fields& fields)
+                {
+                    const auto found = shapes.find(std::type_index(typeid(T)));
+                    if (found != shapes.end())
+                        return found->second;
+                    std::vector<uint64_t> keys;
+                    u::for_each_field(fields, [this, &keys](size_t, const char* key, auto&) { keys.push_back(this->string_record(key, std::strlen(key))); });
+                    align();
+                    const auto offset = buffer.size();
+                    append_word(keys.size());
+                    u::for_each_field(fields, [this, &keys](size_t index, const char*, auto& value) {
+                            this->append_word(keys[index]);
+                            this->append_word(static_cast<uint64_t>(field_kind(value)));
+                        });
+                    shapes.emplace(std::type_index(typeid(T)), offset);
+                    return offset;
+                }
+        };
+
+          // ----------------------------------------------------------------------
+          // views of the snapshot data, nothing is copied until materialize() is called
+          // ----------------------------------------------------------------------
+
+        template <typename T, typename = void> class view;
+
+        class node
+        {
+         public:
+            inline node(const char* aBase, size_t aSize, uint64_t aSlot) : mBase(aBase), mSize(aSize), mSlot(aSlot) {}
+
+         protected:
+            const char* mBase;
+            size_t mSize;
+            uint64_t mSlot;
+
+            inline const char* at(uint64_t offset, uint64_t bytes) const
+                {
+                    if (offset > mSize || bytes > mSize - offset)
+                        throw parsing_error("snapshot: offset " + std::to_string(offset) + " is out of range");
+                    return mBase + offset;
+                }
+
+              // count items of item_size bytes at offset, the count is checked before multiplying, i.e. it cannot wrap around
+            inline const char* at(uint64_t offset, uint64_t count, uint64_t item_size) const
+                {
+                    if (offset > mSize || count > (mSize - offset) / item_size)
+                        throw parsing_error("snapshot: " + std::to_string(count) + " items at offset " + std::to_string(offset) + " are out of range");
+                    return mBase + offset;
+                }
+
+            inline uint64_t word(uint64_t offset) const { uint64_t val; std::memcpy(&val, at(offset, 8), 8); return val; }
+              // number of items of item_size bytes following the count at mSlot, all of them within the data
+            inline size_t count_of(uint64_t item_size) const
+                {
+                    const auto count = word(mSlot);
+                    at(mSlot + 8, count, item_size);
+                    return static_cast<size_t>(count);
+                }
+            inline void check_index(size_t index, size_t count) const
+                {
+                    if (index >= count)
+                        throw parsing_error("snapshot: index " + std::to_string(index) + " is out of range, " + std::to_string(count) + " items");
+                }
+            template <typename V> inline view<V> make(uint64_t slot) const { return view<V>(mBase, mSize, slot); }
+        };
+
+          // ---- number, bool ------------------------------------------------------------------
+
+        template <typename T> class view<T, typename std::enable_if<std::is_arithmetic<T>{}>::type> : public node
         {
          public:
-            inline parser_array_t(T& v) : parser_list_t<T>(v) {}
-            virtual inline void add() const { this->m.push_back(this->keep); }
+            using node::node;
+
+            inline T value() const { return from_slot<T>(mSlot); }
+            inline operator T() const { return value(); }
+            inline void materialize(T& target, string_pool* = nullptr) const { target = value(); }
+            inline T materialize(string_pool* = nullptr) const { return value(); }
         };
 
-          // Note use method for arrays only if there is no json_fields(T&) defined
-        template <typename T, typename std::enable_if<u::is_emplace_back_defined<T>{} && !u::is_json_fields_defined<T>{} && !u::is_json_fields_bool_defined<T>{}>::type*> parser_array_t<T> parser_value(T& value)
+          // ---- string ------------------------------------------------------------------
+
+        template <> class view<std::string, void> : public node
         {
-            return parser_array_t<T>(value);
-        }
+         public:
+            using node::node;
 
-          // ----------------------------------------------------------------------
-          // object -> map<string, T>
-          // ----------------------------------------------------------------------
+            inline size_t size() const { return count_of(1); }
+              // '\0' terminated
+            inline const char* data() const
+                {
+                    const auto count = size();
+                    at(mSlot + 8 + count, 1); // terminator
+                    return mBase + mSlot + 8;
+                }
+            inline std::string str() const { return std::string(data(), size()); }
+            inline operator std::string() const { return str(); }
+            inline void materialize(std::string& target, string_pool* = nullptr) const { target.assign(data(), size()); }
+            inline std::string materialize(string_pool* = nullptr) const { return str(); }
 
-        template <typename T> inline auto parser_map_item(std::string& key, T& value)
-        {
-            return doublequotes >= (string_content >> key) >= doublequotes >= colon >= parser_value(value);
-        }
+            inline int compare(const char* text, size_t text_size) const
+                {
+                    const auto my_size = size();
+                    const auto result = std::memcmp(data(), text, std::min(my_size, text_size));
+                    return result != 0 ? result : (my_size < text_size ? -1 : (my_size > text_size ? 1 : 0));
+                }
+        };
 
-        template <typename T> class parser_map_t AXE_RULE
+          // materialized values are added to the pool given to materialize() or json::parse_snapshot()
+        template <> class view<interned_string, void> : public view<std::string>
         {
-          public:
-            typedef typename T::mapped_type item_type;
-            inline parser_map_t(T& v) : m(v) {}
-            inline axe::result<iterator> operator()(iterator i1, iterator i2) const
-            {
-                auto clear_target = axe::e_ref([this](auto, auto) { m.clear(); });
-                auto insert_item = axe::e_ref([this](auto, auto) { return m.insert(std::make_pair(keep_key, keep_value)); });
-                auto clear_item = axe::e_ref([this](auto, auto) { this->keep_value = item_type(); });
-                auto item = (axe::r_empty() >> clear_item) & (parser_map_item(keep_key, keep_value) >> insert_item);
-                return ((object_begin >> clear_target) >= ~( item & *(comma >= item) ) >= object_end)(i1, i2);
-            }
-          private:
-            T& m;
-            mutable std::string keep_key;
-            mutable item_type keep_value;
+         public:
+            inline view(const char* aBase, size_t aSize, uint64_t aSlot) : view<std::string>(aBase, aSize, aSlot) {}
+
+            inline void materialize(interned_string& target, string_pool* pool = nullptr) const { target = materialize(pool); }
+            inline interned_string materialize(string_pool* pool = nullptr) const
+                {
+                    if (size() == 0)
+                        return interned_string();
+                    if (!pool)
+                        throw parsing_error("snapshot: interned_string value needs json::interning(pool)");
+                    return pool->intern(data(), size());
+                }
         };
 
-        template <typename T> auto parser_value(std::map<std::string, T>& value)
+          // materialized values point into the snapshot data
+        template <> class view<raw_string, void> : public view<std::string>
         {
-            return parser_map_t<std::map<std::string, T>>(value);
-        }
-    }
-
-          // ----------------------------------------------------------------------
+         public:
+            inline view(const char* aBase, size_t aSize, uint64_t aSlot) : view<std::string>(aBase, aSize, aSlot) {}
 
-    template <typename T> inline void parse(std::string source, T& target)
-    {
-        auto parser = r::parser_value(target);
-        try {
-            parser(std::begin(source), std::end(source));
-        }
-        catch (r::failure& err) {
-            throw parsing_error(err.message(std::begin(source)));
-        }
-        catch (axe::failure<char>& err) {
-            throw parsing_error(err.message());
-        }
-    }
+            inline void materialize(raw_string& target, string_pool* = nullptr) const { target = raw_string(data(), size()); }
+            inline raw_string materialize(string_pool* = nullptr) const { return raw_string(data(), size()); }
+        };
 
-      // ----------------------------------------------------------------------
+          // bytes are stored as they are
+        template <> class view<blob, void> : public view<std::string>
+        {
+         public:
+            inline view(const char* aBase, size_t aSize, uint64_t aSlot) : view<std::string>(aBase, aSize, aSlot) {}
 
-    namespace w
-    {
-          // ---- value_to_string ------------------------------------------------------------------
+            inline const unsigned char* bytes() const { return reinterpret_cast<const unsigned char*>(data()); }
+            inline void materialize(blob& target, string_pool* = nullptr) const { target.assign(data(), size()); }
+            inline blob materialize(string_pool* = nullptr) const { return blob(data(), size()); }
+        };
 
-        template <typename T> inline typename std::enable_if<std::is_floating_point<T>::value, std::string>::type value_to_string(T val)
+          // enum value is stored as its name
+        template <typename E> class view<E, typename std::enable_if<u::is_named_enum<E>{}>::type> : public view<std::string>
         {
-            if (std::isnan(val)) {
-                return "null";
-            }
-            else {
-                std::ostringstream s;
-                for (auto prec = std::numeric_limits<T>::max_digits10; prec > 6; --prec) {
-                    s.str("");
-                    s << std::setprecision(prec) << val;
-                    const auto ss = s.str();
-                    if (ss.find('e') != ss.npos || ss.find('E') != ss.npos || (ss.size() > 5 && ss.substr(ss.size() - 5, 4) != "0000" && ss.substr(ss.size() - 4) != "9999"))
-                        return ss;
+         public:
+            inline view(const char* aBase, size_t aSize, uint64_t aSlot) : view<std::string>(aBase, aSize, aSlot) {}
+
+            inline E value() const
+                {
+                    E result;
+                    if (!enum_names<E>::get().value(data(), size(), result))
+                        throw parsing_error("snapshot: unknown enum value name \"" + str() + "\"");
+                    return result;
                 }
-                return s.str();
-            }
-        }
+            inline operator E() const { return value(); }
+            inline void materialize(E& target, string_pool* = nullptr) const { target = value(); }
+            inline E materialize(string_pool* = nullptr) const { return value(); }
+        };
 
-        template <typename T> inline typename std::enable_if<std::is_integral<T>::value, std::string>::type value_to_string(T val)
-        {
-            return std::to_string(val);
-        }
+          // ---- array of numbers ------------------------------------------------------------------
 
-        inline std::string value_to_string(std::string val)
+          // std::array is filled in place, the number of items in the snapshot must match its size
+        template <typename C> inline void prepare_items(C& target, size_t count) { target.clear(); u::reserve(target, count); }
+        template <typename T, size_t N> inline void prepare_items(std::array<T, N>&, size_t count)
         {
-            return '"' + val + '"';
+            if (count != N)
+                throw parsing_error("snapshot: " + std::to_string(count) + " array elements found, " + std::to_string(N) + " expected");
         }
 
-        inline std::string value_to_string(bool val)
+        template <typename C, typename I> inline void assign_items(C& target, I first, I last) { target = C(first, last); }
+        template <typename T, size_t N, typename I> inline void assign_items(std::array<T, N>& target, I first, I last)
         {
-            return val ? "true" : "false";
+            prepare_items(target, static_cast<size_t>(last - first));
+            std::copy(first, last, target.begin());
         }
 
-          // ----------------------------------------------------------------------
+        template <typename C, typename V> inline void store_item(C& target, size_t, V&& item) { target.insert(target.end(), std::forward<V>(item)); }
+        template <typename T, size_t N, typename V> inline void store_item(std::array<T, N>& target, size_t index, V&& item) { target[index] = std::forward<V>(item); }
 
-        class output
+        template <typename T> class view<T, typename std::enable_if<is_array<T>{} && std::is_arithmetic<typename T::value_type>{}>::type> : public node
         {
-         protected:
-            std::string buffer;
-            bool insert_comma;
+         public:
+            typedef typename T::value_type item_type;
+            using node::node;
 
-            inline void comma(bool ic) { if (insert_comma) add_comma(); insert_comma = ic; }
-            virtual inline void add_comma() { buffer.append(1, ','); }
-            virtual void indent_simple() = 0;
-            virtual void indent_extend() = 0;
-            virtual void indent_reduce() = 0;
-            virtual void no_indent() = 0;
+            inline size_t size() const { return count_of(sizeof(item_type)); }
+            inline bool empty() const { return size() == 0; }
+              // items are stored contiguously and can be used in place
+            inline const item_type* data() const
+                {
+                    size();
+                    if (mSlot % alignof(item_type))
+                        throw parsing_error("snapshot: array at offset " + std::to_string(mSlot) + " is not aligned");
+                    return reinterpret_cast<const item_type*>(mBase + mSlot + 8);
+                }
+            inline const item_type* begin() const { return data(); }
+            inline const item_type* end() const { return data() + size(); }
+            inline item_type operator[](size_t index) const { check_index(index, size()); return data()[index]; }
+            inline void materialize(T& target, string_pool* = nullptr) const { assign_items(target, begin(), end()); }
 
-              // current position in the output stream
-            inline auto tell() const { return buffer.size(); }
-              // discard everything appended after the position (obtained via tell() earlier)
-            inline void discard_after(std::string::size_type pos) { buffer.erase(pos); }
+            inline T materialize(string_pool* pool = nullptr) const { T result; materialize(result, pool); return result; }
+        };
 
-         public:
-            inline output() : insert_comma(false) {}
-            inline output(const output&) = default;
-            inline virtual ~output() = default;
-            inline operator std::string () const { return buffer; }
+          // ---- array of strings, arrays, maps, objects ------------------------------------------------------------------
 
-            inline output& open(char c) { comma(false); indent_extend(); buffer.append(1, c); return *this; }
-            inline output& close(char c) { insert_comma = false; comma(true); indent_reduce(); buffer.append(1, c); return *this; }
+        template <typename T> class view<T, typename std::enable_if<is_array<T>{} && !std::is_arithmetic<typename T::value_type>{}>::type> : public node
+        {
+         public:
+            typedef typename T::value_type item_type;
+            using node::node;
 
-            inline output& append(const char* val) { buffer.append(1, '"'); buffer.append(val); buffer.append(1, '"'); return *this; }
+            inline size_t size() const { return count_of(8); }
+            inline bool empty() const { return size() == 0; }
+            inline view<item_type> operator[](size_t index) const { check_index(index, size()); return make<item_type>(word(mSlot + 8 * (index + 1))); }
 
-            template <typename T, typename std::enable_if<std::is_integral<T>{} || std::is_floating_point<T>{} || std::is_convertible<T*, std::string*>{} || std::is_convertible<T*, bool*>{}>::type* = nullptr> inline output& append(T val)
+            inline void materialize(T& target, string_pool* pool = nullptr) const
                 {
-                    comma(true);
-                    indent_simple();
-                    buffer.append(value_to_string(val));
-                    return *this;
+                    const auto count = size();
+                    prepare_items(target, count);
+                    for (size_t index = 0; index < count; ++index) {
+                        item_type item;
+                        (*this)[index].materialize(item, pool);
+                        store_item(target, index, std::move(item));
+                    }
                 }
 
-            // template <typename T, typename std::enable_if<std::is_integral<T>{} || std::is_floating_point<T>{} || std::is_convertible<T*, std::string*>{} || std::is_convertible<T*, bool*>{}>::type* = nullptr> inline output& append(const T& val)
-            //     {
-            //         return append(static_cast<typename std::remove_reference<T>::type>(val));
-            //     }
+            inline T materialize(string_pool* pool = nullptr) const { T result; materialize(result, pool); return result; }
+        };
 
-            template <typename T> inline output& append(const char* key, const T& val)
-                {
-                    comma(false);
-                    indent_simple();
-                    append(key);
-                    buffer.append(": ");
-                    no_indent();
-                    append(val);
-                    insert_comma = true;
-                    return *this;
-                }
+        template <typename T> class view<columns<T>, void> : public view<std::vector<T>>
+        {
+         public:
+            inline view(const char* aBase, size_t aSize, uint64_t aSlot) : view<std::vector<T>>(aBase, aSize, aSlot) {}
 
-              // ---- struct ------------------------------------------------------------------
+            using view<std::vector<T>>::materialize;
+            inline void materialize(columns<T>& target, string_pool* pool = nullptr) const { view<std::vector<T>>::materialize(target.parsed(), pool); }
+        };
 
-            template <typename T> inline output& append(std::tuple<const char*, T*>&& val)
-                {
-                    return append(std::get<0>(val), *std::get<1>(val));
-                }
+          // ---- map ------------------------------------------------------------------
+
+        template <typename T> class view<T, typename std::enable_if<is_map<T>{}>::type> : public node
+        {
+         public:
+            typedef typename T::mapped_type item_type;
+            using node::node;
+
+            inline size_t size() const { return count_of(16); }
+            inline bool empty() const { return size() == 0; }
+            inline view<std::string> key(size_t index) const { check_index(index, size()); return make<std::string>(word(mSlot + 8 + 16 * index)); }
+            inline view<item_type> value(size_t index) const { check_index(index, size()); return make<item_type>(word(mSlot + 16 + 16 * index)); }
 
-            template <typename G, typename S, typename P> inline output& append(std::tuple<const char*, field_t<G, S, P>>&& val)
+              // binary search, keys are sorted, returns size() if not found
+            inline size_t find(const std::string& look_for) const
                 {
-                    return append(std::get<0>(val), std::get<1>(val));
+                    size_t first = 0, last = size();
+                    while (first < last) {
+                        const auto middle = first + (last - first) / 2;
+                        const auto cmp = key(middle).compare(look_for.data(), look_for.size());
+                        if (cmp == 0)
+                            return middle;
+                        if (cmp < 0)
+                            first = middle + 1;
+                        else
+                            last = middle;
+                    }
+                    return size();
                 }
 
-            template <typename... Ts> inline output& append(std::tuple<Ts...>&& val)
+            inline view<item_type> operator[](const std::string& look_for) const
                 {
-                    append(std::make_tuple(std::get<0>(val), std::get<1>(val)));
-                    return append(u::tuple_tail<2u>(val));
+                    const auto index = find(look_for);
+                    if (index == size())
+                        throw parsing_error("snapshot: no key \"" + look_for + "\" in the map");
+                    return value(index);
                 }
 
-            template <typename T, typename std::enable_if<u::is_json_fields_defined<T>{} || u::is_json_fields_bool_defined<T>{}>::type* = nullptr> inline output& append(const T& val)
+            inline void materialize(T& target, string_pool* pool = nullptr) const
                 {
-                    const auto pos = tell();
-                    const auto comma_state = insert_comma;
-                    open('{');
-                    try {
-                        append(u::call_json_fields(const_cast<T&>(val), true));
-                        close('}');
-                    }
-                    catch (no_value&) { // json_fields thrown no_value, it means val should not appear in the output
-                        close('}');     // restore indentation state
-                        discard_after(pos); // discard whatever has been written
-                        insert_comma = comma_state;
+                    target.clear();
+                    const auto count = size();
+                    u::reserve(target, count);
+                    for (size_t index = 0; index < count; ++index) {
+                        item_type item;
+                        value(index).materialize(item, pool);
+                        target.emplace_hint(target.end(), key(index).str(), std::move(item));
                     }
-                    return *this;
                 }
 
-              // ---- vector, list, set ------------------------------------------------------------------
+            inline T materialize(string_pool* pool = nullptr) const { T result; materialize(result, pool); return result; }
+        };
 
-         private:
-            template <typename T> class warray
-            {
-             public:
-                inline warray(const T& val) : mValue(val) {}
-                inline output& append_to(output& o)
-                    {
-                        o.open('[');
-                        if (!mValue.empty()) {
-                            for (auto& i: mValue) {
-                                o.append(i);
-                            }
-                        }
-                        else {
-                            o.no_indent();
-                        }
-                        return o.close(']');
-                    }
-             private:
-                const T& mValue;
-            };
+          // ---- object ------------------------------------------------------------------
 
+        template <typename T> class view<T, typename std::enable_if<is_object<T>{}>::type> : public node
+        {
          public:
-            template <typename T> inline output& append(const std::set<T>& val)
+            using node::node;
+
+            inline bool has(const char* key) const { uint64_t slot; return find_slot(key, 0, nullptr, slot); }
+
+              // field by key, F is the type of the field value
+            template <typename F> inline view<F> field(const char* key) const
                 {
-                    return warray<std::set<T>>(val).append_to(*this);
+                    uint64_t slot;
+                    const auto expected = kind_of<F>();
+                    if (!find_slot(key, 0, &expected, slot))
+                        throw parsing_error(std::string("snapshot: no field \"") + key + "\"");
+                    return make<F>(slot);
                 }
 
-            template <typename T> inline output& append(const std::vector<T>& val)
+              // field by pointer to the member listed in json_fields(), e.g. view.field(&A::name)
+            template <typename F> inline view<F> field(F T::* member) const
                 {
-                    return warray<std::vector<T>>(val).append_to(*this);
+                    size_t index = 0;
+                    const char* key = key_of(member, index);
+                    uint64_t slot;
+                    const auto expected = kind_of<F>();
+                    if (!find_slot(key, index, &expected, slot))
+                        throw parsing_error(std::string("snapshot: no field \"") + key + "\"");
+                    return make<F>(slot);
                 }
 
-            template <typename T> inline output& append(const std::list<T>& val)
+            inline void materialize(T& target, string_pool* pool = nullptr) const
                 {
-                    return warray<std::list<T>>(val).append_to(*this);
+                    auto fields = u::call_json_fields(target, false);
+                    u::for_each_field(fields, [this, pool](size_t index, const char* key, auto& value) {
+                            uint64_t slot;
+                            const auto expected = field_kind(value);
+                            if (this->find_slot(key, index, &expected, slot))
+                                this->materialize_field(slot, value, pool);
+                        });
                 }
 
-              // ---- map ------------------------------------------------------------------
+            inline T materialize(string_pool* pool = nullptr) const { T result; materialize(result, pool); return result; }
 
          private:
-            template <typename T> class wmap
-            {
-             public:
-                inline wmap(const std::map<std::string, T>& val) : mValue(val) {}
-                inline output& append_to(output& o)
-                    {
-                        o.open('{');
-                        if (!mValue.empty()) {
-                            for (auto& i: mValue) {
-                                o.append(i.first.c_str(), i.second);
-                            }
-                        }
-                        else {
-                            o.no_indent();
+              // looks for the key in the shape starting with index, returns false if field is absent
+            inline bool find_slot(const char* key, size_t index, const kind* expected, uint64_t& slot) const
+                {
+                    const auto shape = word(mSlot);
+                    const auto number_of_fields = static_cast<size_t>(word(shape));
+                    at(shape + 8, number_of_fields, 16);
+                    at(mSlot + 8, (number_of_fields + 63) / 64 + number_of_fields, 8); // presence bits and slots
+                    const auto key_size = std::strlen(key);
+                    for (size_t no = 0; no < number_of_fields; ++no, ++index) {
+                        if (index >= number_of_fields)
+                            index = 0;
+                        if (make<std::string>(word(shape + 8 + 16 * index)).compare(key, key_size) == 0) {
+                            if (expected && static_cast<kind>(word(shape + 16 + 16 * index)) != *expected)
+                                throw parsing_error(std::string("snapshot: unexpected kind of field \"") + key + "\"");
+                            if (!(word(mSlot + 8 + 8 * (index / 64)) & (uint64_t(1) << (index % 64))))
+                                return false;
+                            slot = word(mSlot + 8 * (1 + (number_of_fields + 63) / 64 + index));
+                            return true;
                         }
-                        return o.close('}');
                     }
-             private:
-                const std::map<std::string, T>& mValue;
-            };
+                    return false;
+                }
 
-         public:
-            template <typename T> inline output& append(const std::map<std::string, T>& val)
+            template <typename F> inline void materialize_field(uint64_t slot, F* target, string_pool* pool) const
                 {
-                    return wmap<T>(val).append_to(*this);
+                    make<F>(slot).materialize(*target, pool);
                 }
 
-              // ---- field_t<G, S, P> ------------------------------------------------------------------
+            template <typename G, typename S, typename P> inline void materialize_field(uint64_t slot, field_t<G, S, P>& target, string_pool* pool) const
+                {
+                    typename field_t<G, S, P>::value_type value;
+                    make<decltype(value)>(slot).materialize(value, pool);
+                    target.setter()(std::move(value));
+                }
 
-            template <typename G, typename S, typename P> inline output& append(const char* key, const field_t<G, S, P>& val)
+            template <typename F> static inline const char* key_of(F T::* member, size_t& index)
                 {
-                    try {
-                        return append(key, val.get()); // val.get() may throw no_value
-                    }
-                    catch (no_value&) {
-                        return *this; // avoid writing key/value pair
-                    }
+                    static T dummy;
+                    auto fields = u::call_json_fields(dummy, false);
+                    const char* result = nullptr;
+                    const void* address = &(dummy.*member);
+                    u::for_each_field(fields, [&](size_t field_index, const char* key, auto& value) {
+                            if (address_of(value) == address) {
+                                result = key;
+                                index = field_index;
+                            }
+                        });
+                    if (!result)
+                        throw parsing_error("snapshot: member is not listed in json_fields()");
+                    return result;
                 }
         };
 
           // ----------------------------------------------------------------------
 
-        class output_compact : public output
+          // view of the root value of the snapshot in [data, data + size), data must be 8 bytes aligned
+        template <typename T> inline view<T> root_view(const char* data, size_t size)
+        {
+            if (size < header_size || std::memcmp(data, magic, 8) != 0)
+                throw parsing_error("snapshot: invalid header");
+            if (reinterpret_cast<uintptr_t>(data) % 8)
+                throw parsing_error("snapshot: data is not 8 bytes aligned");
+            uint64_t root_kind, root;
+            std::memcpy(&root_kind, data + 8, 8);
+            std::memcpy(&root, data + 16, 8);
+            if (static_cast<kind>(root_kind) != kind_of<T>())
+                throw parsing_error("snapshot: unexpected kind of the root value");
+            return view<T>(data, size, root);
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+
+        class mapped_file
         {
          public:
-            inline output_compact() : output(), insert_space(false) {}
+            inline mapped_file(const char* filename) : mData(nullptr), mSize(0)
+                {
+                    const int fd = ::open(filename, O_RDONLY);
+                    if (fd < 0)
+                        throw std::runtime_error(std::string("cannot open ") + filename + ": " + std::strerror(errno));
+                    struct stat st;
+                    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                        mSize = static_cast<size_t>(st.st_size);
+                        void* data = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+                        if (data != MAP_FAILED)
+                            mData = static_cast<const char*>(data);
+                    }
+                    const auto error = errno;
+                    ::close(fd);
+                    if (!mData)
+                        throw std::runtime_error(std::string("cannot map ") + filename + ": " + std::strerror(error));
+                }
 
-         protected:
-            bool insert_space;
+            inline mapped_file(mapped_file&& other) noexcept : mData(other.mData), mSize(other.mSize) { other.mData = nullptr; other.mSize = 0; }
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+            inline ~mapped_file() { if (mData) ::munmap(const_cast<char*>(mData), mSize); }
 
-            virtual inline void indent_simple() { if (insert_space) buffer.append(1, ' '); insert_space = true; }
-            virtual inline void indent_extend() { insert_space = false; }
-            virtual inline void indent_reduce() { insert_space = true; }
-            virtual inline void no_indent() { insert_space = false; }
-        };
+            inline const char* data() const { return mData; }
+            inline size_t size() const { return mSize; }
 
-          // ----------------------------------------------------------------------
+         private:
+            const char* mData;
+            size_t mSize;
+        };
 
-        class output_pretty : public output
+          // memory mapped snapshot file, nothing is read until accessed via root()
+        template <typename T> class file
         {
          public:
-            inline output_pretty(size_t aIndent) : output(), indent(aIndent), prefix(1, '\n'), insert_prefix(false) {}
+            inline file(const char* filename) : mFile(filename), mRoot(root_view<T>(mFile.data(), mFile.size())) {}
 
-         protected:
-            virtual inline void indent_simple() { if (insert_prefix) buffer.append(prefix); insert_prefix = true; }
-            virtual inline void indent_extend() { indent_simple(); prefix.append(indent, ' '); }
-            virtual inline void indent_reduce() { prefix.erase(prefix.size() - indent); indent_simple(); }
-            virtual inline void no_indent() { insert_prefix = false; }
+            inline const view<T>& root() const { return mRoot; }
+            inline T materialize(string_pool* pool = nullptr) const { return mRoot.materialize(pool); }
 
          private:
-            size_t indent;
-            std::string prefix;
-            bool insert_prefix;
+            mapped_file mFile;
+            view<T> mRoot;
         };
+
+#endif
     }
 
       // ----------------------------------------------------------------------
 
-    template <typename T> inline std::string dump(const T& a, int indent = 0)
+    template <typename T> inline std::string dump_snapshot(const T& a)
     {
-        if (indent <= 0) {
-            auto o = json::w::output_compact();
-            return o.append(a);
-        }
-        else {
-            auto o = json::w::output_pretty(static_cast<size_t>(indent));
-            return o.append(a);
-        }
+        return snapshot::writer().dump(a);
+    }
+
+    template <typename T> inline void parse_snapshot(const char* data, size_t size, T& target)
+    {
+        snapshot::root_view<T>(data, size).materialize(target);
+    }
+
+      // interned_string values are added to the given pool
+    template <typename T> inline void parse_snapshot(const char* data, size_t size, T& target, interning_t interning)
+    {
+        snapshot::root_view<T>(data, size).materialize(target, interning.pool);
+    }
+
+    template <typename T, typename... Option> inline void parse_snapshot(const std::string& source, T& target, Option... option)
+    {
+        parse_snapshot(source.data(), source.size(), target, option...);
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+
+      // parses memory mapped file in place, the returned handle keeps the mapping,
+      // raw_string values of target point into it
+    template <typename T, typename... Option> inline std::shared_ptr<const snapshot::mapped_file> parse_file(const char* filename, T& target, Option... option)
+    {
+        auto file = std::make_shared<const snapshot::mapped_file>(filename);
+        parse(file->data(), file->data() + file->size(), target, option...);
+        return file;
     }
+
+#endif
 }
 
 // ----------------------------------------------------------------------
@@ -0,0 +1,267 @@
+// Counts heap allocations made by parse and dump, fails if a scenario allocates more than its budget
+
+#include <new>
+#include <cstdlib>
+
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static size_t sAllocations = 0, sAllocated = 0;
+
+  // the replacements below pair malloc with free, gcc does not see it through inlining at -O2
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size)
+{
+    ++sAllocations;
+    sAllocated += size;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+// ----------------------------------------------------------------------
+
+class Scalars
+{
+ public:
+    inline Scalars() : count(1234), flag(true), id(-98765), size(42) {}
+
+    int count;
+    bool flag;
+    long id;
+    size_t size;
+
+    friend inline auto json_fields(Scalars& a)
+        {
+            return std::make_tuple("count", &a.count, "flag", &a.flag, "id", &a.id, "size", &a.size);
+        }
+};
+
+class Reals
+{
+ public:
+    inline Reals() : x(0.5), y(-1.25e-7), z(3.14159) {}
+
+    double x, y, z;
+
+    friend inline auto json_fields(Reals& a)
+        {
+            return std::make_tuple("x", &a.x, "y", &a.y, "z", &a.z);
+        }
+};
+
+class Named
+{
+ public:
+    inline Named() : id(7), name("name"), note("") {}
+
+    int id;
+    std::string name;
+    std::string note;
+
+    friend inline auto json_fields(Named& a)
+        {
+            return std::make_tuple("id", &a.id, "name", &a.name, "note", json::field(&a.note, json::output_if_not_empty), "?", json::comment("a comment longer than the small string buffer"));
+        }
+};
+
+class Accessed
+{
+ public:
+    inline Accessed() : value(3) {}
+
+    inline int get_value() const { return value; }
+    inline void set_value(int aValue) { value = aValue; }
+
+    friend inline auto json_fields(Accessed& a)
+        {
+            return std::make_tuple("value", json::field(&a, &Accessed::get_value, &Accessed::set_value),
+                                   "?", json::comment("comment is written for every element of the array"));
+        }
+
+ private:
+    int value;
+};
+
+  // field descriptors returned by json_fields() just hold pointers
+typedef decltype(json_fields(std::declval<Accessed&>())) accessed_fields;
+static_assert(std::is_trivially_copyable<std::tuple_element<1, accessed_fields>::type>::value, "getter/setter field is not trivially copyable");
+static_assert(std::is_trivially_copyable<std::tuple_element<3, accessed_fields>::type>::value, "comment field is not trivially copyable");
+
+  // getters return const reference, setters take rvalue, i.e. values are not copied
+class Guarded
+{
+ public:
+    inline const std::vector<int>& get_values() const { return values; }
+    inline void set_values(std::vector<int>&& aValues) { values = std::move(aValues); }
+    std::string name;
+
+    friend inline auto json_fields(Guarded& a)
+        {
+            return std::make_tuple("values", json::field(&a, &Guarded::get_values, &Guarded::set_values),
+                                   "name", json::field(&a, [](const Guarded* g) -> const std::string& { return g->name; }, [](Guarded* g, std::string&& aName) { g->name = std::move(aName); }));
+        }
+
+ private:
+    std::vector<int> values;
+};
+
+class Container
+{
+ public:
+    std::vector<int> numbers;
+    std::vector<Scalars> items;
+
+    friend inline auto json_fields(Container& a)
+        {
+            return std::make_tuple("numbers", &a.numbers, "items", &a.items);
+        }
+};
+
+  // the same items written by columns
+class Columnar
+{
+ public:
+    std::vector<Scalars> items;
+
+    friend inline auto json_fields(Columnar& a)
+        {
+            return std::make_tuple("items", json::field(&a.items, json::columnar));
+        }
+};
+
+enum class Level { low, medium, high };
+
+inline auto json_enum_names(Level)
+{
+    return json::enum_names<Level>{{Level::low, "low"}, {Level::medium, "medium"}, {Level::high, "high"}};
+}
+
+// ----------------------------------------------------------------------
+
+class Scenario
+{
+ public:
+    inline Scenario(const char* aName, size_t aBudget) : name(aName), budget(aBudget), start(sAllocations), start_bytes(sAllocated) {}
+
+    inline ~Scenario()
+        {
+            const auto allocations = sAllocations - start;
+            const auto bytes = sAllocated - start_bytes;
+            std::cout << std::setw(40) << std::left << name << std::setw(8) << std::right << allocations << " allocations (budget " << budget << ") " << bytes << " bytes" << std::endl;
+            if (allocations > budget) {
+                std::cerr << "ERROR: " << name << ": " << allocations << " allocations exceed budget " << budget << std::endl;
+                std::exit(1);
+            }
+        }
+
+ private:
+    const char* name;
+    size_t budget;
+    size_t start, start_bytes;
+};
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    const Scalars scalars;
+    const Reals reals;
+    const Named named;
+    Container container;
+    container.numbers.resize(1000, 12345);
+    container.items.resize(100);
+    std::vector<Accessed> accessed(1000);
+    Guarded guarded;
+    guarded.set_values(std::vector<int>(100000, 7));
+    guarded.name = "a name longer than the small string buffer";
+
+    const auto scalars_text = json::dump(scalars);
+    const auto reals_text = json::dump(reals);
+    const auto named_text = json::dump(named);
+    const auto container_text = json::dump(container);
+    Columnar columnar;
+    columnar.items = container.items;
+    const auto columnar_text = json::dump(columnar);
+    const auto accessed_text = json::dump(accessed);
+    const auto guarded_text = json::dump(guarded);
+    std::array<double, 1000> fixed;
+    fixed.fill(0.125);
+    const auto fixed_text = json::dump(fixed);
+    std::vector<std::string> hosts;
+    for (int i = 0; i < 1000; ++i)
+        hosts.push_back("host-" + std::to_string(i % 10) + ".a-domain-name-longer-than-the-small-string-buffer.com");
+    const auto hosts_text = json::dump(hosts);
+    std::array<Level, 1000> levels;
+    for (size_t i = 0; i < levels.size(); ++i)
+        levels[i] = static_cast<Level>(i % 3);
+    const auto levels_text = json::dump(levels); // name tables are made on the first use
+    const json::blob bytes(std::vector<unsigned char>(100000, 0xA5));
+    const auto bytes_text = json::dump(bytes);
+
+      // output buffer is the only allocation of dump, it grows geometrically unless exact_size is used
+    { Scenario scenario("dump scalars, exact size", 1); json::dump(scalars, 0, json::exact_size); }
+    { Scenario scenario("dump scalars", 2); json::dump(scalars); }
+    { Scenario scenario("dump scalars, indent", 3); json::dump(scalars, 2); }
+    { Scenario scenario("dump reals", 7); json::dump(reals); }
+    { Scenario scenario("dump strings and comment", 3); json::dump(named); }
+    { Scenario scenario("dump container", 10); json::dump(container); }
+    { Scenario scenario("dump container, exact size", 1); json::dump(container, 0, json::exact_size); }
+    { Scenario scenario("dumped_size container", 0); json::dumped_size(container); }
+    { Scenario scenario("dump columnar, exact size", 1); json::dump(columnar, 0, json::exact_size); }
+    { Scenario scenario("dump getters and comments, exact size", 1); json::dump(accessed, 0, json::exact_size); }
+    { Scenario scenario("dump getters returning reference", 1); json::dump(guarded, 0, json::exact_size); }
+    { Scenario scenario("dump enum names, exact size", 1); json::dump(levels, 0, json::exact_size); }
+    { Scenario scenario("dump blob, exact size", 1); json::dump(bytes, 0, json::exact_size); }
+
+      // parsing budgets include allocations made by axe rules
+    Scalars scalars_target;
+    Reals reals_target;
+    Named named_target;
+    Container container_target;
+    std::vector<Accessed> accessed_target(accessed.size());
+    Guarded guarded_target;
+    { Scenario scenario("parse scalars", 2); json::parse(scalars_text, scalars_target); }
+    { Scenario scenario("parse reals", 2); json::parse(reals_text, reals_target); }
+    { Scenario scenario("parse strings", 0); json::parse(named_text, named_target); }
+    { Scenario scenario("parse container", 115); json::parse(container_text, container_target); }
+    { Scenario scenario("parse container again", 105); json::parse(container_text, container_target); } // vectors keep their capacity
+    Columnar columnar_target;
+    { Scenario scenario("parse columnar", 101); json::parse(columnar_text, columnar_target); } // items are sized once by the first array, 100 flags read by the axe rule
+    { Scenario scenario("parse setters and comments", 0); json::parse(accessed_text, accessed_target); }
+    { Scenario scenario("parse into setters taking rvalue", 2); json::parse(guarded_text, guarded_target); } // reserved vector and string, no copies
+    { Scenario scenario("parse std::array of numbers", 0); json::parse(fixed_text, fixed); }
+    json::string_pool pool;
+    std::vector<json::interned_string> interned;
+    { Scenario scenario("parse interned strings", 25); json::parse(hosts_text, interned, json::interning(pool)); } // vector growth and 10 strings
+    { Scenario scenario("parse interned strings again", 0); json::parse(hosts_text, interned, json::interning(pool)); }
+    std::vector<json::raw_string> raw(hosts.size());
+    { Scenario scenario("parse raw strings", 0); json::parse(hosts_text, raw); } // point into hosts_text
+    { Scenario scenario("parse enum names", 0); json::parse(levels_text, levels); }
+    json::blob bytes_target;
+    { Scenario scenario("parse blob", 1); json::parse(bytes_text, bytes_target); } // decoded into the vector of the exact size
+    { Scenario scenario("parse blob again", 0); json::parse(bytes_text, bytes_target); }
+    { Scenario scenario("validate container", 0); json::validate<Container>(container_text); }
+    { Scenario scenario("validate without schema", 0); json::validate(container_text); }
+    assert(guarded_target.get_values() == guarded.get_values() && guarded_target.name == guarded.name);
+    assert(bytes_target == bytes);
+
+    return 0;
+}
+
+// ----------------------------------------------------------------------
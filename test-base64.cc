@@ -0,0 +1,177 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_codec();
+static void test_fields();
+static void test_errors();
+
+// ----------------------------------------------------------------------
+
+class Attachment
+{
+ public:
+    inline Attachment() : id(0) {}
+
+    int id;
+    std::string mime;
+    json::blob thumbnail;
+    json::blob payload;
+
+    friend inline auto json_fields(Attachment& a)
+        {
+            return std::make_tuple("id", &a.id, "mime", &a.mime, "thumbnail", &a.thumbnail, "payload", &a.payload);
+        }
+};
+
+static inline std::vector<unsigned char> make_bytes(size_t size, unsigned seed)
+{
+    std::vector<unsigned char> result(size);
+    for (auto& byte: result) {
+        seed = seed * 1103515245 + 12345;
+        byte = static_cast<unsigned char>(seed >> 16);
+    }
+    return result;
+}
+
+static inline Attachment make_attachment(int id, size_t thumbnail_size)
+{
+    Attachment attachment;
+    attachment.id = id;
+    attachment.mime = "image/png";
+    attachment.thumbnail = make_bytes(thumbnail_size, static_cast<unsigned>(id));
+    attachment.payload = make_bytes(static_cast<size_t>(id) % 50, static_cast<unsigned>(id) + 7);
+    return attachment;
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_codec();
+    test_fields();
+    test_errors();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_codec()
+{
+      // RFC 4648 test vectors
+    const char* vectors[][2] = {{"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"}, {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"}};
+    for (const auto& vector: vectors) {
+        const json::blob data(vector[0], std::strlen(vector[0]));
+        assert(json::dump(data) == std::string("\"") + vector[1] + "\"");
+        json::blob parsed;
+        json::parse(std::string("\"") + vector[1] + "\"", parsed);
+        assert(parsed == data);
+    }
+
+      // every size around the 12 and 16 byte steps, every byte value
+    for (size_t size = 0; size < 100; ++size) {
+        const json::blob data(make_bytes(size, static_cast<unsigned>(size)));
+        const auto text = json::dump(data);
+        assert(text.size() == json::base64::encoded_size(size) + 2 && json::dumped_size(data) == text.size());
+        json::blob parsed(make_bytes(3, 0));
+        json::parse(text, parsed);
+        assert(parsed == data);
+    }
+    std::vector<unsigned char> all(256);
+    for (size_t byte = 0; byte < all.size(); ++byte)
+        all[byte] = static_cast<unsigned char>(byte);
+    const auto text = json::dump(json::blob(all));
+    assert(text.find_first_not_of("\"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/=") == std::string::npos);
+    json::blob parsed;
+    json::parse(text, parsed);
+    assert(parsed.bytes() == all);
+
+      // without padding, with escaped slashes, null
+    json::parse(R"("Zm9vYg")", parsed);
+    assert(parsed == json::blob("foob", 4));
+    json::parse(R"("Zm9vYmE")", parsed);
+    assert(parsed == json::blob("fooba", 5));
+    json::parse(R"("\/\/8=")", parsed);
+    assert(parsed.size() == 2 && parsed.data()[0] == 0xFF && parsed.data()[1] == 0xFF);
+    json::parse("null", parsed);
+    assert(parsed.empty());
+
+} // test_codec
+
+// ----------------------------------------------------------------------
+
+void test_fields()
+{
+    std::vector<Attachment> attachments;
+    for (int id = 0; id < 40; ++id)
+        attachments.push_back(make_attachment(id, static_cast<size_t>(id) * 7));
+    const auto text = json::dump(attachments, 2);
+    std::vector<Attachment> parsed;
+    json::parse(text, parsed);
+    assert(json::dump(parsed, 2) == text);
+    assert(parsed[10].thumbnail == attachments[10].thumbnail && parsed[10].payload.size() == 10);
+    assert(json::dumped_size(attachments, 2) == text.size());
+
+    json::validate<std::vector<Attachment>>(text);
+    assert(json::extract<json::blob>(text, "/5/thumbnail") == attachments[5].thumbnail);
+
+    Attachment pushed;
+    const auto one = json::dump(attachments[33]);
+    json::push_parser<Attachment> parser(pushed);
+    for (size_t pos = 0; pos < one.size(); pos += 5)
+        parser.feed(one.data() + pos, std::min(size_t(5), one.size() - pos));
+    parser.finish();
+    assert(json::dump(pushed) == one);
+
+    Attachment changed = attachments[20];
+    changed.payload = json::blob("new", 3);
+    assert(json::dump_diff(attachments[20], changed) == R"({"payload": "bmV3"})");
+    Attachment patched = attachments[20];
+    json::apply_patch(patched, json::dump_diff(attachments[20], changed));
+    assert(patched.payload == changed.payload && patched.thumbnail == changed.thumbnail);
+
+} // test_fields
+
+// ----------------------------------------------------------------------
+
+void test_errors()
+{
+    auto expect_error = [](const char* source) {
+        try {
+            Attachment target;
+            json::parse(source, target);
+            std::cerr << "no error for " << source << std::endl;
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+        try {
+            json::validate<Attachment>(source);
+            std::cerr << "validated " << source << std::endl;
+            assert(false);
+        }
+        catch (json::parsing_error&) {
+        }
+    };
+    expect_error(R"({"payload": "Zm9v!mFy"})");
+    expect_error(R"({"payload": "Zm9vY"})");
+    expect_error(R"({"payload": "Zm9=vYmFy"})");
+    expect_error(R"({"payload": "Zg==="})");
+    expect_error(R"({"payload": "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdef ghijklmnopqrstuvwxyz"})");
+    expect_error(R"({"payload": "Zm9v\n"})");
+    expect_error(R"({"payload": [1, 2]})");
+    expect_error(R"({"payload": 12})");
+
+    try {
+        json::blob target;
+        json::parse_cbor(json::dump_cbor(std::string("Zm9v")), target);
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+} // test_errors
+
+// ----------------------------------------------------------------------
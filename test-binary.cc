@@ -0,0 +1,488 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+template <typename T> static void test_roundtrip(const char* name, const T& source);
+static void test_ranges();
+static void test_containers();
+static void test_interning();
+static void test_raw_strings();
+static void test_enums();
+static void test_blobs();
+static void test_columnar();
+
+// ----------------------------------------------------------------------
+
+class A
+{
+ public:
+    inline A() : i(0), u(0), l(0), f(0), fl(0), b(false) {}
+
+    int i;
+    unsigned u;
+    long long l;
+    double f;
+    float fl;
+    bool b;
+    std::string s;
+    std::vector<int> vi;
+    std::list<double> ld;
+    std::set<std::string> ss;
+    std::map<std::string, int> msi;
+    std::vector<int> vi_if_not_empty;
+
+    friend inline auto json_fields(A& a)
+        {
+            return std::make_tuple("i", &a.i, "u", &a.u, "l", &a.l, "f", &a.f, "fl", &a.fl, "b", &a.b, "s", &a.s,
+                                   "vi", &a.vi, "ld", &a.ld, "ss", &a.ss, "msi", &a.msi,
+                                   "vi_if_not_empty", json::field(&a.vi_if_not_empty, json::output_if_not_empty),
+                                   "?", json::comment("comment field"));
+        }
+};
+
+// ----------------------------------------------------------------------
+
+class E
+{
+ public:
+    inline E() : i(1) {}
+    inline E(int aI) : i(aI) {}
+
+    int i;
+
+    friend inline auto json_fields(E& e, bool for_output)
+        {
+            if (for_output && e.i % 2)
+                throw json::no_value();
+            return std::make_tuple("i", &e.i);
+        }
+};
+
+class D
+{
+ public:
+    inline D() : year(2000), month(1) {}
+
+    int year, month;
+
+    inline std::string display() const { return std::to_string(year) + "-" + std::to_string(month); }
+    inline void parse(std::string text) { const auto dash = text.find('-'); year = std::stoi(text.substr(0, dash)); month = std::stoi(text.substr(dash + 1)); }
+};
+
+class B
+{
+ public:
+    std::vector<A> va;
+    std::vector<E> ve;
+    std::map<std::string, A> msa;
+    D date;
+    double nan;
+
+    inline B() : nan(std::numeric_limits<double>::quiet_NaN()) {}
+
+    friend inline auto json_fields(B& b)
+        {
+            return std::make_tuple("va", &b.va, "ve", &b.ve, "msa", &b.msa, "date", json::field(&b.date, &D::display, &D::parse), "nan", &b.nan);
+        }
+};
+
+class Visit
+{
+ public:
+    inline Visit() : id(0) {}
+
+    int id;
+    json::interned_string country;
+    std::vector<json::interned_string> tags;
+
+    friend inline auto json_fields(Visit& a)
+        {
+            return std::make_tuple("id", &a.id, "country", &a.country, "tags", &a.tags);
+        }
+};
+
+class Event
+{
+ public:
+    inline Event() : id(0) {}
+
+    int id;
+    json::raw_string message;
+    std::vector<json::raw_string> labels;
+
+    friend inline auto json_fields(Event& a)
+        {
+            return std::make_tuple("id", &a.id, "message", &a.message, "labels", &a.labels);
+        }
+};
+
+static inline bool inside(const json::raw_string& value, const std::string& data)
+{
+    return value.data() >= data.data() && value.data() + value.size() <= data.data() + data.size();
+}
+
+// ----------------------------------------------------------------------
+
+class Attachment
+{
+ public:
+    inline Attachment() : id(0) {}
+
+    int id;
+    json::blob thumbnail;
+
+    friend inline auto json_fields(Attachment& a)
+        {
+            return std::make_tuple("id", &a.id, "thumbnail", &a.thumbnail);
+        }
+};
+
+static inline std::vector<Attachment> make_attachments()
+{
+    std::vector<Attachment> attachments(31);
+    for (size_t no = 0; no < attachments.size(); ++no) {
+        std::vector<unsigned char> bytes(no < 30 ? no * 11 : 70000); // 32 bit sizes for the last one
+        for (size_t i = 0; i < bytes.size(); ++i)
+            bytes[i] = static_cast<unsigned char>(i * 7 + no);
+        attachments[no].id = static_cast<int>(no);
+        attachments[no].thumbnail = bytes;
+    }
+    return attachments;
+}
+
+// ----------------------------------------------------------------------
+
+class Point
+{
+ public:
+    int id = 0;
+    double x = 0;
+    std::string label;
+
+    friend inline auto json_fields(Point& a)
+        {
+            return std::make_tuple("id", &a.id, "x", &a.x, "label", &a.label);
+        }
+};
+
+class Points
+{
+ public:
+    std::vector<Point> items;
+
+    friend inline auto json_fields(Points& a)
+        {
+            return std::make_tuple("items", json::field(&a.items, json::columnar));
+        }
+};
+
+static inline Points make_points()
+{
+    Points points;
+    points.items.resize(40);
+    for (size_t no = 0; no < points.items.size(); ++no) {
+        points.items[no].id = static_cast<int>(no);
+        points.items[no].x = static_cast<double>(no) / 4;
+        points.items[no].label = no % 2 ? "odd" : "even";
+    }
+    return points;
+}
+
+// ----------------------------------------------------------------------
+
+namespace events
+{
+    enum class Severity { debug, info, warning, error, fatal };
+
+    inline auto json_enum_names(Severity)
+    {
+        return json::enum_names<Severity>{{Severity::debug, "debug"}, {Severity::info, "info"}, {Severity::warning, "warning"}, {Severity::error, "error"}, {Severity::fatal, "fatal"}};
+    }
+
+    class Log
+    {
+     public:
+        inline Log() : level(Severity::info) {}
+
+        Severity level;
+        std::vector<Severity> history;
+        std::map<std::string, Severity> sources;
+
+        friend inline auto json_fields(Log& a)
+            {
+                return std::make_tuple("level", &a.level, "history", &a.history, "sources", &a.sources);
+            }
+    };
+
+    static inline Log make_log()
+    {
+        Log log;
+        log.level = Severity::warning;
+        for (int no = 0; no < 12; ++no)
+            log.history.push_back(static_cast<Severity>(no % 5));
+        log.sources = {{"db", Severity::error}, {"cache", Severity::debug}};
+        return log;
+    }
+
+} // namespace events
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    B b;
+    for (int no = 0; no < 40; ++no) {
+        A a;
+        a.i = -no * 1000;
+        a.u = static_cast<unsigned>(no) * 100000U;
+        a.l = no % 2 ? -(1LL << (no + 20)) : (1LL << (no + 20));
+        a.f = no / 7.0;
+        a.fl = static_cast<float>(no) / 3.0F;
+        a.b = no % 3 == 0;
+        a.s = std::string(static_cast<size_t>(no * 10), 'x');
+        for (int e = 0; e < no; ++e)
+            a.vi.push_back(e * e - 300);
+        a.ld.push_back(-1e300);
+        a.ss.insert("s" + std::to_string(no));
+        a.msi["k" + std::to_string(no)] = no;
+        if (no % 2)
+            a.vi_if_not_empty.push_back(no);
+        b.va.push_back(a);
+        b.msa["a" + std::to_string(no)] = a;
+    }
+    for (int no = 1; no <= 10; ++no)
+        b.ve.emplace_back(no);
+    b.date.year = 2016;
+    b.date.month = 6;
+
+    test_roundtrip("cbor", b);
+    test_roundtrip("msgpack", b);
+
+    B b1;
+    try {
+        json::parse_cbor(std::string("\xA1\x61x\x01", 4), b1);
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+    test_ranges();
+    test_containers();
+    test_interning();
+    test_raw_strings();
+    test_enums();
+    test_blobs();
+    test_columnar();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+  // integers out of the range of the target fail as in json::parse
+void test_ranges()
+{
+    auto expect_error = [](const std::string& data, bool cbor, auto target) {
+        try {
+            if (cbor)
+                json::parse_cbor(data, target);
+            else
+                json::parse_msgpack(data, target);
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+    };
+
+    const std::vector<long long> values{300, -1, -129, 4294967296LL, -2147483648LL, std::numeric_limits<long long>::min()};
+    for (bool cbor: {true, false}) {
+        const auto data = cbor ? json::dump_cbor(values) : json::dump_msgpack(values);
+        std::vector<long long> same;
+        cbor ? json::parse_cbor(data, same) : json::parse_msgpack(data, same);
+        assert(same == values);
+        std::vector<double> floats;
+        cbor ? json::parse_cbor(data, floats) : json::parse_msgpack(data, floats);
+        assert(floats[3] == 4294967296.0 && floats[5] == -9223372036854775808.0);
+        expect_error(data, cbor, std::vector<unsigned char>());
+        expect_error(data, cbor, std::vector<unsigned>());
+        expect_error(data, cbor, std::vector<signed char>());
+        expect_error(data, cbor, std::vector<int>());
+
+        const std::vector<uint64_t> big{std::numeric_limits<uint64_t>::max()};
+        const auto big_data = cbor ? json::dump_cbor(big) : json::dump_msgpack(big);
+        std::vector<uint64_t> big_same;
+        cbor ? json::parse_cbor(big_data, big_same) : json::parse_msgpack(big_data, big_same);
+        assert(big_same == big);
+        expect_error(big_data, cbor, std::vector<long long>());
+    }
+
+    std::vector<unsigned char> bytes;
+    json::parse_cbor(json::dump_cbor(std::vector<int>{0, 255}), bytes);
+    assert(bytes == (std::vector<unsigned char>{0, 255}));
+    json::parse_msgpack(json::dump_msgpack(std::vector<int>{0, 255}), bytes);
+    assert(bytes == (std::vector<unsigned char>{0, 255}));
+
+      // cbor negative integer -1 - (2^64 - 1) is below the range of any target
+    expect_error(std::string("\x81\x3B\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF", 10), true, std::vector<long long>());
+
+} // test_ranges
+
+// ----------------------------------------------------------------------
+
+  // unordered and flat containers are read from maps and arrays written from any other container
+void test_containers()
+{
+    std::unordered_map<std::string, int> hash;
+    std::set<std::string> tags;
+    for (int no = 0; no < 30; ++no) {
+        hash.emplace("key-" + std::to_string(no * 7919 % 10007), no);
+        tags.insert("tag-" + std::to_string(no % 17));
+    }
+    const auto text = json::dump(hash, 0, json::sorted_keys);
+
+    json::flat_map<int> flat;
+    json::parse_cbor(json::dump_cbor(hash), flat);
+    assert(json::dump(flat) == text);
+    std::unordered_map<std::string, int> hash2;
+    json::parse_msgpack(json::dump_msgpack(flat), hash2);
+    assert(hash2 == hash);
+    json::parse_cbor(json::dump_cbor(flat), hash2);
+    assert(hash2 == hash);
+
+    json::flat_set<std::string> flat_tags;
+    json::parse_msgpack(json::dump_msgpack(tags), flat_tags);
+    assert(json::dump(flat_tags) == json::dump(tags));
+    std::set<std::string> tags2;
+    json::parse_cbor(json::dump_cbor(flat_tags), tags2);
+    assert(tags2 == tags);
+
+} // test_containers
+
+// ----------------------------------------------------------------------
+
+  // interned strings are added to the pool given with json::interning, without a pool parsing fails
+void test_interning()
+{
+    const char* const countries[] = {"DE", "FR", "NL", "US", "JP"};
+    json::string_pool pool;
+    std::vector<Visit> visits(50);
+    for (size_t no = 0; no < visits.size(); ++no) {
+        visits[no].id = static_cast<int>(no);
+        visits[no].country = pool.intern(countries[no % 5]);
+        visits[no].tags = {pool.intern("tag-" + std::to_string(no % 3)), pool.intern("shared")};
+    }
+    const auto text = json::dump(visits);
+
+    for (bool cbor: {true, false}) {
+        const auto data = cbor ? json::dump_cbor(visits) : json::dump_msgpack(visits);
+        json::string_pool binary_pool;
+        std::vector<Visit> binary;
+        cbor ? json::parse_cbor(data, binary, json::interning(binary_pool)) : json::parse_msgpack(data, binary, json::interning(binary_pool));
+        assert(json::dump(binary) == text);
+        assert(binary[3].country.data() == binary[8].country.data() && binary[1].tags[1].data() == binary[2].tags[1].data());
+        assert(binary_pool.size() == pool.size());
+        try {
+            cbor ? json::parse_cbor(data, binary) : json::parse_msgpack(data, binary);
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+    }
+
+} // test_interning
+
+// ----------------------------------------------------------------------
+
+  // raw strings read from binary data point into it
+void test_raw_strings()
+{
+    const std::vector<std::string> messages{"plain", "with \"quotes\" and \\ escapes", std::string(100, 'x'), ""};
+    std::vector<Event> events(messages.size());
+    for (size_t no = 0; no < events.size(); ++no) {
+        events[no].id = static_cast<int>(no);
+        events[no].message = json::raw_string(messages[no].data(), messages[no].size());
+        events[no].labels = {json::raw_string(messages[0].data(), messages[0].size()), events[no].message};
+    }
+    const auto text = json::dump(events);
+
+    for (bool cbor: {true, false}) {
+        const auto data = cbor ? json::dump_cbor(events) : json::dump_msgpack(events);
+        std::vector<Event> binary;
+        cbor ? json::parse_cbor(data, binary) : json::parse_msgpack(data, binary);
+        assert(json::dump(binary) == text && inside(binary[1].message, data) && inside(binary[2].labels[1], data));
+    }
+
+} // test_raw_strings
+
+// ----------------------------------------------------------------------
+
+  // enums with json_enum_names() are written as their names
+void test_enums()
+{
+    const auto log = events::make_log();
+    const auto text = json::dump(log);
+    events::Log binary;
+    json::parse_cbor(json::dump_cbor(log), binary);
+    assert(json::dump(binary) == text);
+    binary = events::Log();
+    json::parse_msgpack(json::dump_msgpack(log), binary);
+    assert(json::dump(binary) == text);
+    assert(json::dump_cbor(events::Severity::fatal) == "\x65" "fatal");
+
+} // test_enums
+
+// ----------------------------------------------------------------------
+
+  // blobs are written as bytes, not as base64 text
+void test_blobs()
+{
+    const auto attachments = make_attachments();
+    const auto text = json::dump(attachments);
+    for (bool cbor: {true, false}) {
+        const auto data = cbor ? json::dump_cbor(attachments) : json::dump_msgpack(attachments);
+        std::vector<Attachment> binary;
+        cbor ? json::parse_cbor(data, binary) : json::parse_msgpack(data, binary);
+        assert(json::dump(binary) == text);
+        assert(data.size() < text.size() * 4 / 5);
+    }
+
+} // test_blobs
+
+// ----------------------------------------------------------------------
+
+  // json::columnar fields are written as a map of arrays, keys are not repeated for every item
+void test_columnar()
+{
+    const auto points = make_points();
+    const auto text = json::dump(points);
+    for (bool cbor: {true, false}) {
+        const auto data = cbor ? json::dump_cbor(points) : json::dump_msgpack(points);
+        Points binary;
+        cbor ? json::parse_cbor(data, binary) : json::parse_msgpack(data, binary);
+        assert(json::dump(binary) == text);
+        assert(data.size() < (cbor ? json::dump_cbor(points.items) : json::dump_msgpack(points.items)).size());
+    }
+
+} // test_columnar
+
+// ----------------------------------------------------------------------
+
+template <typename T> void test_roundtrip(const char* name, const T& source)
+{
+    const std::string text = json::dump(source);
+    const std::string binary = std::string(name) == "cbor" ? json::dump_cbor(source) : json::dump_msgpack(source);
+    T target;
+    if (std::string(name) == "cbor")
+        json::parse_cbor(binary, target);
+    else
+        json::parse_msgpack(binary, target);
+    std::cout << name << ": json " << text.size() << " bytes, " << name << " " << binary.size() << " bytes" << std::endl;
+    assert(target.ve.size() == 5); // odd elements are not written
+    T from_text;
+    json::parse(text, from_text);
+    assert(json::dump(target) == json::dump(from_text));
+}
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,175 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_output();
+static void test_layout();
+static void test_parse();
+
+// ----------------------------------------------------------------------
+
+class Item
+{
+ public:
+    inline Item() : id(0), weight(0) {}
+
+    int id;
+    double weight;
+    std::string name;
+    std::vector<int> values;
+    std::string note;
+
+    friend inline auto json_fields(Item& a)
+        {
+            return std::make_tuple("id", &a.id, "weight", &a.weight, "name", &a.name, "values", &a.values, "note", json::field(&a.note, json::output_if_not_empty));
+        }
+};
+
+class Group
+{
+ public:
+    json::cached<Item> head;
+    std::vector<json::cached<Item>> items;
+
+    friend inline auto json_fields(Group& a)
+        {
+            return std::make_tuple("head", &a.head, "items", &a.items);
+        }
+};
+
+// the same as Group, but without caching
+class PlainGroup
+{
+ public:
+    Item head;
+    std::vector<Item> items;
+
+    friend inline auto json_fields(PlainGroup& a)
+        {
+            return std::make_tuple("head", &a.head, "items", &a.items);
+        }
+};
+
+static inline Item make_item(size_t no)
+{
+    Item item;
+    item.id = static_cast<int>(no);
+    item.weight = no / 8.0;
+    item.name = "item-" + std::to_string(no);
+    for (size_t i = 0; i < 20; ++i)
+        item.values.push_back(static_cast<int>(no * i));
+    return item;
+}
+
+static inline void make_groups(size_t items, Group& group, PlainGroup& plain)
+{
+    group.head = plain.head = make_item(0);
+    for (size_t no = 1; no <= items; ++no) {
+        plain.items.push_back(make_item(no));
+        group.items.emplace_back(plain.items.back());
+    }
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_output();
+    test_layout();
+    test_parse();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_output()
+{
+    Group group;
+    PlainGroup plain;
+    make_groups(10, group, plain);
+
+    for (int indent: {0, 1, 2, 0}) {
+        assert(json::dump(group, indent) == json::dump(plain, indent));
+        assert(json::dump(group, indent) == json::dump(plain, indent)); // with kept text
+        assert(json::dumped_size(group, indent) == json::dump(plain, indent).size());
+    }
+
+    group.items[3].modify().note = "modified";
+    plain.items[3].note = "modified";
+    assert(json::dump(group) == json::dump(plain));
+    group.items[3] = Item();
+    plain.items[3] = Item();
+    assert(json::dump(group, 3) == json::dump(plain, 3));
+
+    Item empty;
+    json::cached<Item> cached_empty(empty);
+    assert(json::dump(cached_empty) == json::dump(empty));
+    assert(json::dump(cached_empty) == json::dump(empty));
+    assert(json::dump(cached_empty, 2) == json::dump(empty, 2));
+
+      // kept text is written with the default float format only
+    Group floats;
+    PlainGroup plain_floats;
+    make_groups(5, floats, plain_floats);
+    const auto shortest = json::dump(floats);
+    assert(json::dump(floats, 0, json::precision(1)) == json::dump(plain_floats, 0, json::precision(1)));
+    assert(json::dump(floats, 0, json::precision(1)) != shortest);
+    Group formatted_first;
+    PlainGroup plain_formatted;
+    make_groups(5, formatted_first, plain_formatted);
+    assert(json::dump(formatted_first, 2, json::fixed(3)) == json::dump(plain_formatted, 2, json::fixed(3)));
+    assert(json::dump(formatted_first) == shortest);
+    assert(json::dumped_size(formatted_first, 0, json::fixed(3)) == json::dump(plain_formatted, 0, json::fixed(3)).size());
+
+} // test_output
+
+// ----------------------------------------------------------------------
+
+// the same object written at different nesting depth
+void test_layout()
+{
+    Group group;
+    PlainGroup plain;
+    make_groups(2, group, plain);
+
+    const auto nested = json::dump(group, 2);
+    std::cout << nested << std::endl;
+    assert(nested == json::dump(plain, 2));
+    assert(json::dump(group.items[0], 2) == json::dump(plain.items[0], 2));
+    assert(json::dump(group, 2) == nested);
+
+    std::map<std::string, std::vector<json::cached<Item>>> deeper{{"group", group.items}};
+    std::map<std::string, std::vector<Item>> plain_deeper{{"group", plain.items}};
+    assert(json::dump(deeper, 4) == json::dump(plain_deeper, 4));
+    assert(json::dump(deeper, 4) == json::dump(plain_deeper, 4));
+
+} // test_layout
+
+// ----------------------------------------------------------------------
+
+void test_parse()
+{
+    Group group;
+    PlainGroup plain;
+    make_groups(5, group, plain);
+    const auto text = json::dump(group);
+
+    Group parsed;
+    parsed.head = make_item(99);
+    json::dump(parsed);
+    json::parse(text, parsed);
+    assert(json::dump(parsed) == text);
+    assert(json::dump(parsed, 1) == json::dump(plain, 1));
+
+    Group binary;
+    json::parse_cbor(json::dump_cbor(group), binary);
+    assert(json::dump(binary) == text);
+
+    Group patched = group;
+    json::apply_patch(patched, R"({"head": {"name": "patched"}})");
+    assert(patched.head->name == "patched");
+    assert(json::dump_diff(group, patched) == R"({"head": {"name": "patched"}})");
+
+} // test_parse
+
+// ----------------------------------------------------------------------
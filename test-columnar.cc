@@ -0,0 +1,221 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_layout();
+static void test_fields();
+static void test_errors();
+
+// ----------------------------------------------------------------------
+
+enum class Side { buy, sell };
+
+inline auto json_enum_names(Side)
+{
+    return json::enum_names<Side>{{Side::buy, "buy"}, {Side::sell, "sell"}};
+}
+
+class Venue
+{
+ public:
+    std::string code;
+    int zone = 0;
+
+    friend inline auto json_fields(Venue& a)
+        {
+            return std::make_tuple("code", &a.code, "zone", &a.zone);
+        }
+};
+
+class Tick
+{
+ public:
+    inline Tick() : id(0), price(0), side(Side::buy), volume(-1) {}
+
+    int id;
+    double price;
+    std::string symbol;
+    Side side;
+    std::vector<int> lots;
+    Venue venue;
+    long volume;                // -1: not known, not written
+
+    long get_volume() const { if (volume < 0) throw json::no_value(); return volume; }
+    void set_volume(long aVolume) { volume = aVolume; }
+
+    friend inline auto json_fields(Tick& a)
+        {
+            return std::make_tuple("id", &a.id, "price", &a.price, "symbol", &a.symbol, "side", &a.side, "lots", &a.lots, "venue", &a.venue,
+                                   "volume", json::field(&a, &Tick::get_volume, &Tick::set_volume));
+        }
+};
+
+class Series
+{
+ public:
+    std::string name;
+    std::vector<Tick> ticks;
+
+    friend inline auto json_fields(Series& a)
+        {
+            return std::make_tuple("name", &a.name, "ticks", json::field(&a.ticks, json::columnar));
+        }
+};
+
+static inline Tick make_tick(int id)
+{
+    Tick tick;
+    tick.id = id;
+    tick.price = 100 + id / 4.0;
+    tick.symbol = id % 2 ? "ABC" : "XYZ";
+    tick.side = id % 3 ? Side::buy : Side::sell;
+    tick.lots.assign(static_cast<size_t>(id % 3), id);
+    tick.venue.code = "V" + std::to_string(id % 4);
+    tick.venue.zone = id % 4;
+    if (id % 5)
+        tick.volume = id * 100L;
+    return tick;
+}
+
+static inline Series make_series(int number)
+{
+    Series series;
+    series.name = "series";
+    for (int id = 0; id < number; ++id)
+        series.ticks.push_back(make_tick(id));
+    return series;
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_layout();
+    test_fields();
+    test_errors();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_layout()
+{
+    const auto series = make_series(3);
+    const auto text = json::dump(series);
+    assert(text == R"({"name": "series", "ticks": {"id": [0, 1, 2], "price": [100, 100.25, 100.5], "symbol": ["XYZ", "ABC", "XYZ"], "side": ["sell", "buy", "buy"],)"
+                   R"( "lots": [[],[1],[2, 2]], "venue": [{"code": "V0", "zone": 0},{"code": "V1", "zone": 1},{"code": "V2", "zone": 2}], "volume": [null, 100, 200]}})");
+    assert(json::dumped_size(series) == text.size());
+
+    Series parsed = make_series(10);
+    json::parse(text, parsed);
+    assert(parsed.ticks.size() == 3 && json::dump(parsed.ticks) == json::dump(series.ticks));
+    assert(parsed.ticks[0].volume == -1 && parsed.ticks[2].volume == 200);
+
+    const auto indented = json::dump(series, 2);
+    json::parse(indented, parsed);
+    assert(json::dump(parsed, 2) == indented);
+
+      // every key is written for no items, {} is read as no items as well
+    const auto empty = json::dump(Series());
+    assert(empty == R"({"name": "", "ticks": {"id": [], "price": [], "symbol": [], "side": [], "lots": [], "venue": [], "volume": []}})");
+    json::parse(empty, parsed);
+    assert(parsed.ticks.empty());
+    parsed = series;
+    json::parse(R"({"ticks": {}})", parsed);
+    assert(parsed.ticks.empty());
+
+      // keys in any order, missing keys leave default values
+    json::parse(R"({"ticks": {"symbol": ["A", "B"], "id": [7, 8]}})", parsed);
+    assert(parsed.ticks.size() == 2 && parsed.ticks[1].id == 8 && parsed.ticks[1].symbol == "B" && parsed.ticks[1].price == 0 && parsed.ticks[1].volume == -1);
+
+} // test_layout
+
+// ----------------------------------------------------------------------
+
+void test_fields()
+{
+    const auto series = make_series(50);
+    const auto text = json::dump(series, 1);
+
+    json::validate<Series>(text);
+
+    Series pushed;
+    json::push_parser<Series> parser(pushed);
+    for (size_t pos = 0; pos < text.size(); pos += 3)
+        parser.feed(text.data() + pos, std::min(size_t(3), text.size() - pos));
+    parser.finish();
+    assert(json::dump(pushed, 1) == text);
+
+      // any change replaces the whole vector
+    Series changed = series;
+    changed.ticks[7].price = 1;
+    const auto patch = json::dump_diff(series, changed);
+    assert(patch.find(R"("ticks": {"id": [0, 1,)") != std::string::npos && patch.find("name") == std::string::npos);
+    assert(json::dump_diff(series, series) == "{}");
+    Series patched = series;
+    json::apply_patch(patched, patch);
+    assert(json::dump(patched) == json::dump(changed));
+    json::apply_patch(patched, R"({"ticks": null})");
+    assert(patched.ticks.empty());
+
+    assert(json::extract<std::vector<int>>(json::dump(series), "/ticks/id").size() == 50);
+
+} // test_fields
+
+// ----------------------------------------------------------------------
+
+void test_errors()
+{
+    auto expect_error = [](const char* source) {
+        try {
+            Series target;
+            json::parse(source, target);
+            std::cerr << "no error for " << source << std::endl;
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+        try {
+            json::validate<Series>(source);
+            std::cerr << "validated " << source << std::endl;
+            assert(false);
+        }
+        catch (json::parsing_error&) {
+        }
+        try {
+            Series target;
+            json::push_parser<Series> parser(target);
+            parser.feed(source);
+            parser.finish();
+            std::cerr << "no push parser error for " << source << std::endl;
+            assert(false);
+        }
+        catch (json::parsing_error&) {
+        }
+    };
+    expect_error(R"({"ticks": {"id": [1, 2], "price": [1]}})");
+    expect_error(R"({"ticks": {"id": [1], "price": [1, 2]}})");
+    expect_error(R"({"ticks": {"id": [], "symbol": ["a"]}})");
+    expect_error(R"({"ticks": {"id": 1}})");
+    expect_error(R"({"ticks": {"id": [1], "extra": [1]}})");
+    expect_error(R"({"ticks": {"id": ["1"]}})");
+    expect_error(R"({"ticks": [{"id": 1}]})");
+
+    Series target;
+    json::parse(R"({"ticks": {"id": [1], "extra": [1]}})", target, json::ignore_unknown);
+    assert(target.ticks.size() == 1);
+
+    try {
+        std::map<std::string, std::vector<int>> uneven{{"id", {1, 2}}, {"price", {1}}};
+        json::columns<Tick> ticks;
+        json::parse_cbor(json::dump_cbor(uneven), ticks);
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+} // test_errors
+
+// ----------------------------------------------------------------------
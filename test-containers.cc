@@ -0,0 +1,151 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_parse();
+static void test_output();
+static void test_patch();
+
+// ----------------------------------------------------------------------
+
+class Entry
+{
+ public:
+    inline Entry() : count(0) {}
+    inline Entry(int aCount, std::string aName) : count(aCount), name(aName) {}
+
+    int count;
+    std::string name;
+
+    inline bool operator==(const Entry& other) const { return count == other.count && name == other.name; }
+
+    friend inline auto json_fields(Entry& a)
+        {
+            return std::make_tuple("count", &a.count, "name", &a.name);
+        }
+};
+
+template <typename M> class Index
+{
+ public:
+    M entries;
+    json::flat_set<std::string> tags;
+    std::unordered_map<std::string, double> weights;
+
+    friend inline auto json_fields(Index& a)
+        {
+            return std::make_tuple("entries", &a.entries, "tags", &a.tags, "weights", &a.weights);
+        }
+};
+
+template <typename M> static inline Index<M> make_index(size_t size)
+{
+    Index<M> index;
+    for (size_t no = 0; no < size; ++no) {
+        const auto key = "key-" + std::to_string(no * 7919 % 10007);
+        index.entries.emplace(key, Entry(static_cast<int>(no), "entry " + std::to_string(no)));
+        index.tags.insert("tag-" + std::to_string(no % 17));
+        index.weights.emplace(key, no * 0.5);
+    }
+    return index;
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_parse();
+    test_output();
+    test_patch();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_parse()
+{
+    const char* source = R"({"b": {"count": 2, "name": "b"}, "a": {"count": 1, "name": "a"}, "c": {"count": 3, "name": "c"}, "a": {"count": 4, "name": "dup"}})";
+    std::map<std::string, Entry> tree;
+    json::parse(source, tree);
+
+    std::unordered_map<std::string, Entry> hash;
+    json::parse(source, hash);
+    assert(hash.size() == tree.size());
+    for (const auto& entry: tree)
+        assert(hash.at(entry.first) == entry.second);
+
+    json::flat_map<Entry> flat;
+    json::parse(source, flat);
+    assert(flat.size() == tree.size() && std::equal(flat.begin(), flat.end(), tree.begin(), [](const auto& e1, const auto& e2) { return e1.first == e2.first && e1.second == e2.second; }));
+    assert(flat.at("a").name == "a" && flat.find("d") == flat.end() && flat.count("c") == 1);
+    json::parse("{}", flat);
+    assert(flat.empty());
+
+    json::flat_set<int> numbers;
+    json::parse("[5, 3, 9, 3, 1, 5]", numbers);
+    assert(numbers == (json::flat_set<int>{1, 3, 5, 9}) && numbers.size() == 4);
+    json::parse("[1, 2, 3]", numbers);  // sorted input, not sorted again
+    assert(numbers == (json::flat_set<int>{1, 2, 3}));
+
+    Index<json::flat_map<Entry>> index;
+    json::push_parser<Index<json::flat_map<Entry>>> pusher(index);
+    const auto text = json::dump(make_index<std::map<std::string, Entry>>(100), 0, json::sorted_keys);
+    for (size_t pos = 0; pos < text.size(); pos += 7)
+        pusher.feed(text.data() + pos, std::min(size_t(7), text.size() - pos));
+    pusher.finish();
+    assert(json::dump(index, 0, json::sorted_keys) == text);
+
+} // test_parse
+
+// ----------------------------------------------------------------------
+
+void test_output()
+{
+    const auto tree = make_index<std::map<std::string, Entry>>(50);
+    const auto flat = make_index<json::flat_map<Entry>>(50);
+    const auto hash = make_index<std::unordered_map<std::string, Entry>>(50);
+    for (int indent: {0, 2}) {
+        const auto text = json::dump(tree, indent, json::sorted_keys);
+        assert(json::dump(flat, indent, json::sorted_keys) == text);
+        assert(json::dump(hash, indent, json::sorted_keys) == text);
+        assert(json::dump(flat, indent).size() == text.size());
+        assert(json::dump(hash, indent).size() == text.size());
+    }
+    std::cout << json::dump(make_index<std::unordered_map<std::string, Entry>>(3), 1, json::sorted_keys) << std::endl;
+
+    std::unordered_map<std::string, json::cached<Entry>> cached{{"x", Entry(1, "x")}};
+    json::dump(cached);
+    assert(json::dump(cached, 0, json::sorted_keys) == R"({"x": {"count": 1, "name": "x"}})");
+
+} // test_output
+
+// ----------------------------------------------------------------------
+
+void test_patch()
+{
+    auto old_hash = make_index<std::unordered_map<std::string, Entry>>(20);
+    auto new_hash = old_hash;
+    new_hash.entries.erase("key-0");
+    new_hash.entries["key-7919"].count = -1;
+    new_hash.entries.emplace("new", Entry(5, "new"));
+    new_hash.weights["key-0"] = 100;
+    const auto patch = json::dump_diff(old_hash, new_hash);
+    std::cout << patch << std::endl;
+    auto target = old_hash;
+    json::apply_patch(target, patch);
+    assert(json::dump(target, 0, json::sorted_keys) == json::dump(new_hash, 0, json::sorted_keys));
+    assert(json::dump_diff(new_hash, target) == "{}");
+
+    auto old_flat = make_index<json::flat_map<Entry>>(20);
+    auto new_flat = old_flat;
+    new_flat.entries.erase("key-0");
+    new_flat.entries["key-7919"].count = -1;
+    new_flat.entries.emplace("new", Entry(5, "new"));
+    new_flat.tags.erase("tag-3");
+    auto flat_target = old_flat;
+    json::apply_patch(flat_target, json::dump_diff(old_flat, new_flat));
+    assert(json::dump(flat_target) == json::dump(new_flat));
+
+} // test_patch
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,153 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_sizes();
+static void test_discarded();
+static void test_options();
+
+// ----------------------------------------------------------------------
+
+class Item
+{
+ public:
+    inline Item() : id(0), weight(0), active(false) {}
+
+    int id;
+    double weight;
+    bool active;
+    std::string name;
+    std::vector<int> codes;
+    std::map<std::string, double> extra;
+
+    friend inline auto json_fields(Item& a)
+        {
+            return std::make_tuple("id", &a.id, "weight", &a.weight, "active", &a.active, "name", &a.name,
+                                   "codes", &a.codes, "extra", &a.extra, "?", json::comment("item"));
+        }
+};
+
+  // odd ids are not written, i.e. output is discarded after json_fields() throws
+class Partial
+{
+ public:
+    inline Partial(int aId = 0) : id(aId) {}
+
+    int id;
+
+    friend inline auto json_fields(Partial& a, bool for_output)
+        {
+            if (for_output && a.id % 2)
+                throw json::no_value();
+            return std::make_tuple("id", &a.id);
+        }
+};
+
+class Container
+{
+ public:
+    std::vector<Item> items;
+    std::vector<Partial> partial;
+    std::string note;
+
+    friend inline auto json_fields(Container& a)
+        {
+            return std::make_tuple("items", &a.items, "partial", &a.partial, "note", json::field(&a.note, json::output_if_not_empty));
+        }
+};
+
+static inline Container make_container(int number)
+{
+    Container container;
+    for (int no = 0; no < number; ++no) {
+        Item item;
+        item.id = no * 37 - 500;
+        item.weight = no / 3.0;
+        item.active = no % 2 == 0;
+        item.name = "item " + std::to_string(no);
+        item.codes.assign(static_cast<size_t>(no % 4), no);
+        if (no % 3 == 0)
+            item.extra = {{"x", 1.5}, {"y", -no / 7.0}};
+        container.items.push_back(item);
+        container.partial.emplace_back(no);
+    }
+    return container;
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_sizes();
+    test_discarded();
+    test_options();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_sizes()
+{
+    for (int number: {0, 1, 5, 100}) {
+        const auto container = make_container(number);
+        for (int indent: {0, 1, 2, 4}) {
+            const auto text = json::dump(container, indent);
+            assert(json::dumped_size(container, indent) == text.size());
+            assert(json::dump(container, indent, json::exact_size) == text);
+        }
+    }
+
+    assert(json::dumped_size(0) == 1 && json::dumped_size(-2147483647 - 1) == 11);
+    assert(json::dumped_size(std::string("abc")) == 5);
+    assert(json::dumped_size(std::vector<double>{0.1, 1e300, -0.0}) == json::dump(std::vector<double>{0.1, 1e300, -0.0}).size());
+
+} // test_sizes
+
+// ----------------------------------------------------------------------
+
+void test_discarded()
+{
+    Container container;
+    for (int id = 1; id <= 10; ++id)
+        container.partial.emplace_back(id);
+    const auto text = json::dump(container, 1);
+    assert(text.find("\"id\": 1\n") == std::string::npos && text.find("\"id\": 10") != std::string::npos);
+    assert(json::dumped_size(container, 1) == text.size());
+    assert(json::dump(container, 0, json::exact_size) == json::dump(container));
+
+    Container odd;
+    odd.partial = {Partial(1), Partial(3)};
+    odd.note = "odd";
+    assert(json::dumped_size(odd) == json::dump(odd).size());
+    assert(json::dumped_size(Partial(5)) == json::dump(Partial(5)).size());
+
+} // test_discarded
+
+// ----------------------------------------------------------------------
+
+  // options of dump and dumped_size combined
+void test_options()
+{
+    std::unordered_map<std::string, double> hash;
+    for (int no = 0; no < 50; ++no)
+        hash["key-" + std::to_string(no)] = no / 3.0;
+    std::map<std::string, double> tree(hash.begin(), hash.end());
+
+    for (int indent: {0, 2}) {
+        const auto sorted = json::dump(tree, indent);
+        assert(json::dump(hash, indent, json::sorted_keys) == sorted);
+        assert(json::dump(hash, indent, json::exact_size, json::sorted_keys) == sorted);
+        assert(json::dump(hash, indent, json::sorted_keys, json::exact_size) == sorted);
+        assert(json::dumped_size(hash, indent, json::sorted_keys) == sorted.size());
+
+        const auto fixed = json::dump(tree, indent, json::fixed(2));
+        assert(fixed.find("\"key-1\": 0.33") != std::string::npos);
+        assert(json::dump(hash, indent, json::sorted_keys, json::fixed(2)) == fixed);
+        assert(json::dump(hash, indent, json::fixed(2), json::exact_size, json::sorted_keys) == fixed);
+        assert(json::dumped_size(hash, indent, json::fixed(2), json::sorted_keys) == fixed.size());
+        assert(json::dumped_size(tree, indent, json::fixed(2), json::exact_size) == fixed.size());
+    }
+
+} // test_options
+
+// ----------------------------------------------------------------------
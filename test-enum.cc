@@ -0,0 +1,184 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_parse();
+static void test_errors();
+
+// ----------------------------------------------------------------------
+
+namespace events
+{
+    enum class Severity { debug, info, warning, error, fatal };
+
+    inline auto json_enum_names(Severity)
+    {
+        return json::enum_names<Severity>{{Severity::debug, "debug"}, {Severity::info, "info"}, {Severity::warning, "warning"}, {Severity::error, "error"}, {Severity::fatal, "fatal"}};
+    }
+
+      // sparse values, an alias
+    enum class Status : short { unknown = -1, ok = 200, not_found = 404, failed = 500, internal_error = 500 };
+
+    inline auto json_enum_names(Status)
+    {
+        return json::enum_names<Status>{{Status::unknown, "unknown"}, {Status::ok, "ok"}, {Status::not_found, "not-found"}, {Status::failed, "failed"}, {Status::internal_error, "internal-error"}};
+    }
+
+    enum Channel { web, mobile, api, batch };
+
+    inline auto json_enum_names(Channel)
+    {
+        return json::enum_names<Channel>{{web, "web"}, {mobile, "mobile"}, {api, "api"}, {batch, "batch"}};
+    }
+
+    enum class Unnamed { a, b };
+
+    class Event
+    {
+     public:
+        inline Event() : id(0), severity(Severity::info), status(Status::ok), channel(web), steps{{Severity::debug, Severity::debug}} {}
+
+        int id;
+        Severity severity;
+        Status status;
+        Channel channel;
+        std::vector<Severity> history;
+        std::map<std::string, Status> upstream;
+        std::array<Severity, 2> steps;
+
+        friend inline auto json_fields(Event& a)
+            {
+                return std::make_tuple("id", &a.id, "severity", &a.severity, "status", &a.status, "channel", &a.channel,
+                                       "history", &a.history, "upstream", &a.upstream, "steps", &a.steps);
+            }
+    };
+
+    static inline Event make_event(int id)
+    {
+        Event event;
+        event.id = id;
+        event.severity = static_cast<Severity>(id % 5);
+        event.status = id % 3 == 0 ? Status::not_found : (id % 7 == 0 ? Status::failed : Status::ok);
+        event.channel = static_cast<Channel>(id % 4);
+        for (int i = 0; i < id % 4; ++i)
+            event.history.push_back(static_cast<Severity>((id + i) % 5));
+        if (id % 2)
+            event.upstream = {{"db", Status::ok}, {"cache", Status::unknown}};
+        event.steps = {{Severity::warning, event.severity}};
+        return event;
+    }
+
+} // namespace events
+
+using namespace events;
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_parse();
+    test_errors();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_parse()
+{
+    assert(json::dump(Severity::warning) == R"("warning")");
+    assert(json::dump(Status::internal_error) == R"("failed")"); // the first name of the value
+    assert(json::dump(std::vector<Channel>{api, web}) == R"(["api", "web"])");
+
+    Status status = Status::ok;
+    json::parse(R"("internal-error")", status);
+    assert(status == Status::failed);
+    json::parse(R"("unknown")", status);
+    assert(status == Status::unknown);
+
+    std::vector<Event> events;
+    for (int id = 0; id < 100; ++id)
+        events.push_back(make_event(id));
+    const auto text = json::dump(events, 2);
+    std::vector<Event> parsed;
+    json::parse(text, parsed);
+    assert(json::dump(parsed, 2) == text);
+    assert(parsed[3].status == Status::not_found && parsed[3].channel == batch && parsed[3].steps[0] == Severity::warning);
+    assert(json::dumped_size(events, 2) == text.size());
+
+    Event pushed;
+    const auto one = json::dump(make_event(7));
+    json::push_parser<Event> parser(pushed);
+    for (size_t pos = 0; pos < one.size(); pos += 2)
+        parser.feed(one.data() + pos, std::min(size_t(2), one.size() - pos));
+    parser.finish();
+    assert(json::dump(pushed) == one);
+
+    Event changed = events[5];
+    changed.severity = Severity::fatal;
+    const auto patch = json::dump_diff(events[5], changed);
+    assert(patch == R"({"severity": "fatal"})");
+    Event patched = events[5];
+    json::apply_patch(patched, patch);
+    assert(patched.severity == Severity::fatal);
+
+} // test_parse
+
+// ----------------------------------------------------------------------
+
+void test_errors()
+{
+    auto expect_error = [](const char* source, auto target) {
+        try {
+            json::parse(source, target);
+            std::cerr << "no error for " << source << std::endl;
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+    };
+    expect_error(R"("warn")", Severity());
+    expect_error(R"("warning2")", Severity());
+    expect_error(R"({"id": 1, "severity": 2})", Event());
+    expect_error(R"({"id": 1, "severity": null})", Event());
+    expect_error(R"({"id": 1, "status": "gone"})", Event());
+    expect_error(R"({"id": 1, "history": ["info", "trace"]})", Event());
+
+    try {
+        Event event;
+        json::push_parser<Event> parser(event);
+        parser.feed(R"({"severity": [)");
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+    try {
+        Severity severity;
+        json::parse_cbor(json::dump_cbor(std::string("trace")), severity);
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+    try {
+        json::dump(static_cast<Status>(201));
+        assert(false);
+    }
+    catch (std::out_of_range& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+    try {
+        json::enum_names<Unnamed>{{Unnamed::a, "a"}, {Unnamed::b, "a"}};
+        assert(false);
+    }
+    catch (std::invalid_argument& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+} // test_errors
+
+// ----------------------------------------------------------------------
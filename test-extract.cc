@@ -0,0 +1,172 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_single();
+static void test_multiple();
+static void test_errors();
+
+// ----------------------------------------------------------------------
+
+class Hop
+{
+ public:
+    inline Hop() : id(0), weight(0) {}
+
+    int id;
+    std::string host;
+    double weight;
+
+    friend inline auto json_fields(Hop& a)
+        {
+            return std::make_tuple("id", &a.id, "host", &a.host, "weight", &a.weight);
+        }
+};
+
+class Header
+{
+ public:
+    std::string name;
+    std::vector<Hop> route;
+    std::map<std::string, std::string> labels;
+
+    friend inline auto json_fields(Header& a)
+        {
+            return std::make_tuple("name", &a.name, "route", &a.route, "labels", &a.labels);
+        }
+};
+
+class Message
+{
+ public:
+    Header header;
+    std::vector<std::vector<int>> body;
+
+    friend inline auto json_fields(Message& a)
+        {
+            return std::make_tuple("header", &a.header, "body", &a.body);
+        }
+};
+
+static inline Message make_message(size_t hops, size_t rows)
+{
+    Message message;
+    message.header.name = "message";
+    for (size_t no = 0; no < hops; ++no) {
+        Hop hop;
+        hop.id = static_cast<int>(no) * 10;
+        hop.host = "host-" + std::to_string(no);
+        hop.weight = static_cast<double>(no) / 4;
+        message.header.route.push_back(hop);
+    }
+    message.header.labels = {{"a/b", "slash"}, {"c~d", "tilde"}, {"", "empty"}};
+    for (size_t no = 0; no < rows; ++no)
+        message.body.push_back({static_cast<int>(no), 1, 2, 3});
+    return message;
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_single();
+    test_multiple();
+    test_errors();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_single()
+{
+    const auto message = make_message(5, 10);
+    const auto text = json::dump(message, 2);
+
+    assert(json::extract<int>(text, "/header/route/3/id") == 30);
+    assert(json::extract<std::string>(text, "/header/route/0/host") == "host-0");
+    assert(json::extract<double>(text, "/header/route/2/weight") == 0.5);
+    assert(json::extract<std::string>(text, "/header/labels/a~1b") == "slash");
+    assert(json::extract<std::string>(text, "/header/labels/c~0d") == "tilde");
+    assert(json::extract<std::string>(text, "/header/labels/") == "empty");
+    assert(json::extract<std::vector<int>>(text, "/body/9") == (std::vector<int>{9, 1, 2, 3}));
+    assert(json::extract<int>(text, "/body/9/0") == 9);
+
+    const auto hop = json::extract<Hop>(text, "/header/route/4");
+    assert(hop.id == 40 && hop.host == "host-4");
+    const auto whole = json::extract<Message>(text, "");
+    assert(json::dump(whole, 2) == text);
+
+    const char* partial = R"({"a": {"b": [10, 20, {"c": 30}]}, "x": [1, 2)"; // the rest is not scanned
+    assert(json::extract<int>(partial, "/a/b/2/c") == 30);
+
+    assert(json::extract<Hop>(R"({"route": [{"id": 1, "extra": true}]})", "/route/0", json::ignore_unknown).id == 1);
+
+} // test_single
+
+// ----------------------------------------------------------------------
+
+void test_multiple()
+{
+    const auto text = json::dump(make_message(20, 100));
+
+    int id = 0, first_row_item = 0;
+    std::string name, host, missing = "unchanged";
+    std::vector<Hop> route;
+    const auto found = json::extract(text, std::make_tuple("/header/route/7/id", &id, "/header/name", &name, "/header/route/19/host", &host,
+                                                           "/body/0/3", &first_row_item, "/header/route", &route, "/header/route/20/host", &missing));
+    assert(found.count() == 5 && !found[5]);
+    assert(id == 70 && name == "message" && host == "host-19" && first_row_item == 3 && route.size() == 20);
+    assert(missing == "unchanged");
+
+      // the same value at two pointers
+    int a = 0, b = 0;
+    assert(json::extract(R"({"x": [5]})", std::make_tuple("/x/0", &a, "/x/0", &b)).all() && a == 5 && b == 5);
+
+    int deeper = 7;
+    assert(json::extract(R"({"x": 1})", std::make_tuple("/x/y", &deeper)).none() && deeper == 7);
+    assert(json::extract(R"({"x": [1]})", std::make_tuple("/x/-", &deeper, "/x/01", &deeper, "/x/y", &deeper)).none());
+
+} // test_multiple
+
+// ----------------------------------------------------------------------
+
+void test_errors()
+{
+    const auto text = json::dump(make_message(3, 3));
+    try {
+        json::extract<int>(text, "/header/route/5/id");
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+    try {
+        json::extract<int>(text, "/header/name");
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+    try {
+        json::extract<int>(R"({"a" 1, "b": 2})", "/b");
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+    for (const char* pointer: {"header", "/a~2"}) {
+        try {
+            json::extract<int>(text, pointer);
+            assert(false);
+        }
+        catch (std::invalid_argument& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+    }
+
+} // test_errors
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,158 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_formats();
+static void test_fields();
+
+// ----------------------------------------------------------------------
+
+class Position
+{
+ public:
+    double lat = 0, lon = 0;
+
+    friend inline auto json_fields(Position& a)
+        {
+            return std::make_tuple("lat", &a.lat, "lon", &a.lon);
+        }
+};
+
+class Reading
+{
+ public:
+    int id = 0;
+    double temperature = 0;
+    double price = 0;
+    float ratio = 0;
+    double raw = 0;
+    std::vector<double> samples;
+    Position position;
+
+    friend inline auto json_fields(Reading& a)
+        {
+            return std::make_tuple("id", &a.id, "temperature", json::field(&a.temperature, json::precision(3)), "price", json::field(&a.price, json::fixed(2)),
+                                   "ratio", json::field(&a.ratio, json::precision(2)), "raw", &a.raw,
+                                   "samples", json::field(&a.samples, json::fixed(1)), "position", json::field(&a.position, json::fixed(4)));
+        }
+};
+
+static inline Reading make_reading(int id)
+{
+    Reading reading;
+    reading.id = id;
+    reading.temperature = 20 + id / 7.0;
+    reading.price = 9.5 + id;
+    reading.ratio = 1.0f / static_cast<float>(id + 3);
+    reading.raw = id / 3.0;
+    reading.samples = {id / 4.0, -id / 8.0};
+    reading.position.lat = 52.5 + id / 1000.0;
+    reading.position.lon = 13.4 - id / 3000.0;
+    return reading;
+}
+
+static inline std::string format(double val, const json::float_format& fmt)
+{
+    return json::dump(val, 0, fmt);
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_formats();
+    test_fields();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_formats()
+{
+    assert(format(0.1, json::precision(3)) == "0.1");
+    assert(format(1234.5678, json::precision(4)) == "1235");
+    assert(format(1234.5678, json::precision(6)) == "1234.57");
+    assert(format(123456789.0, json::precision(4)) == "1.235e+08");
+    assert(format(1e-7, json::precision(2)) == "1e-07");
+    assert(format(0.000123456, json::precision(3)) == "0.000123");
+    assert(format(1e21, json::precision(1)) == "1e+21");
+    assert(format(-2.25, json::precision(2)) == "-2.3"); // half away from zero
+    assert(format(9.9999, json::precision(3)) == "10");
+    assert(format(0, json::precision(5)) == "0");
+    assert(format(1.5e-300, json::precision(2)) == "1.5e-300");
+    assert(format(0.1, json::precision(17)) == json::dump(0.1)); // the default shortest round-trip output
+    assert(format(1234.5678, json::precision(0)) == "1e+03" && format(1234.5678, json::float_format(json::float_format::significant, 0)) == "1e+03");
+    assert(json::float_format(json::float_format::significant, -3).digits() == 1 && json::float_format(json::float_format::fixed, -3).digits() == 0);
+
+    assert(format(0.1, json::fixed(3)) == "0.100");
+    assert(format(1234.5678, json::fixed(2)) == "1234.57");
+    assert(format(2.5, json::fixed(0)) == "3");
+    assert(format(-0.125, json::fixed(2)) == "-0.13");
+    assert(format(-0.0001, json::fixed(2)) == "0.00");
+    assert(format(1e-7, json::fixed(4)) == "0.0000");
+    assert(format(1e21, json::fixed(2)) == json::dump(1e21)); // too big, written as by default
+
+    for (const auto& fmt: {json::precision(4), json::fixed(2)}) {
+        assert(format(std::numeric_limits<double>::quiet_NaN(), fmt) == "null");
+        assert(format(std::numeric_limits<double>::infinity(), fmt) == json::dump(std::numeric_limits<double>::infinity()));
+    }
+
+      // dump-wide default, arrays of numbers, sizes
+    const std::vector<double> values{1.0 / 3, 2.0 / 3, std::numeric_limits<double>::quiet_NaN(), 1e-9, 42};
+    assert(json::dump(values, 0, json::precision(3)) == "[0.333, 0.667, null, 1e-09, 42]");
+    assert(json::dump(values, 0, json::fixed(2)) == "[0.33, 0.67, null, 0.00, 42.00]");
+    assert(json::dump(values, 1, json::fixed(2)) == "[\n 0.33,\n 0.67,\n null,\n 0.00,\n 42.00\n]");
+    for (int digits = 0; digits < 18; ++digits) {
+        assert(json::dumped_size(values, 0, json::precision(digits)) == json::dump(values, 0, json::precision(digits)).size());
+        assert(json::dumped_size(values, 2, json::fixed(digits)) == json::dump(values, 2, json::fixed(digits)).size());
+    }
+
+      // read back within the rounding
+    std::vector<double> parsed;
+    json::parse(json::dump(values, 0, json::precision(6)), parsed);
+    assert(std::fabs(parsed[0] - values[0]) < 1e-6 && std::isnan(parsed[2]) && parsed[4] == 42);
+
+} // test_formats
+
+// ----------------------------------------------------------------------
+
+void test_fields()
+{
+    const auto reading = make_reading(4);
+    const auto text = json::dump(reading);
+    assert(text == R"({"id": 4, "temperature": 20.6, "price": 13.50, "ratio": 0.14, "raw": 1.3333333333333333, "samples": [1.0, -0.5], "position": {"lat": 52.5040, "lon": 13.3987}})");
+    assert(json::dumped_size(reading) == text.size());
+
+      // the dump-wide format applies to fields without their own
+    const auto rounded = json::dump(reading, 0, json::fixed(1));
+    assert(rounded.find(R"("temperature": 20.6, "price": 13.50, "ratio": 0.14, "raw": 1.3,)") != std::string::npos);
+    assert(json::dumped_size(reading, 0, json::fixed(1)) == rounded.size());
+
+    Reading parsed;
+    json::parse(text, parsed);
+    assert(parsed.id == 4 && parsed.price == 13.5 && std::fabs(parsed.temperature - reading.temperature) < 0.05 && parsed.raw == reading.raw);
+
+    std::vector<Reading> readings;
+    for (int id = 0; id < 20; ++id)
+        readings.push_back(make_reading(id));
+    const auto indented = json::dump(readings, 2);
+    std::vector<Reading> parsed_readings;
+    json::parse(indented, parsed_readings);
+    assert(json::dump(parsed_readings, 2) == indented);
+
+    Reading changed = reading;
+    changed.price = 15.5;
+    changed.position.lon = 0.25;
+    assert(json::dump_diff(reading, changed) == R"({"price": 15.50, "position": {"lon": 0.2500}})");
+    Reading patched = reading;
+    json::apply_patch(patched, json::dump_diff(reading, changed));
+    assert(patched.price == 15.5 && patched.position.lon == 0.25);
+
+      // binary formats and snapshots store exact values
+    Reading binary;
+    json::parse_cbor(json::dump_cbor(reading), binary);
+    assert(binary.temperature == reading.temperature && json::dump(binary) == text);
+
+} // test_fields
+
+// ----------------------------------------------------------------------
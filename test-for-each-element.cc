@@ -0,0 +1,135 @@
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_string();
+static void test_stream();
+static void test_errors();
+
+// ----------------------------------------------------------------------
+
+class Record
+{
+ public:
+    inline Record() : id(0), amount(0) {}
+
+    int id;
+    double amount;
+    std::string name;
+    std::vector<int> codes;
+
+    friend inline auto json_fields(Record& a)
+        {
+            return std::make_tuple("id", &a.id, "amount", &a.amount, "name", &a.name, "codes", &a.codes);
+        }
+};
+
+static inline std::string make_records(size_t number)
+{
+    std::vector<Record> records(number);
+    for (size_t no = 0; no < number; ++no) {
+        records[no].id = static_cast<int>(no);
+        records[no].amount = no * 0.25;
+        records[no].name = "record \\\"" + std::to_string(no) + "\\\"";
+        if (no % 2)
+            records[no].codes = {1, 2, static_cast<int>(no)};
+    }
+    return json::dump(records, 1);
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_string();
+    test_stream();
+    test_errors();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_string()
+{
+    const auto source = make_records(1000);
+    std::vector<Record> records;
+    json::parse(source, records);
+
+    size_t count = 0;
+    const Record* scratch = nullptr;
+    json::for_each_element<Record>(source, [&](const Record& record) {
+            assert(json::dump(record) == json::dump(records[count]));
+            assert(scratch == nullptr || scratch == &record); // the same object is reused
+            scratch = &record;
+            ++count;
+        });
+    assert(count == records.size());
+
+    double sum = 0;
+    json::for_each_element<double>(" [1, 2.5, null, -0.5] ", [&sum](double value) { if (!std::isnan(value)) sum += value; });
+    assert(sum == 3);
+    json::for_each_element<int>("[]", [](int) { assert(false); });
+
+    count = 0;
+    json::for_each_element<Record>(R"([{"id": 1, "extra": [1, 2]}, {"id": 2}])", [&count](Record& record) { count += static_cast<size_t>(record.id); }, json::ignore_unknown);
+    assert(count == 3);
+
+} // test_string
+
+// ----------------------------------------------------------------------
+
+void test_stream()
+{
+    const auto source = make_records(10000);
+    const char* filename = "test-for-each-element.tmp";
+    std::ofstream(filename) << source;
+
+    std::vector<Record> records;
+    json::parse(source, records);
+
+    size_t count = 0;
+    std::ifstream input(filename);
+    json::for_each_element<Record>(input, [&](const Record& record) {
+            assert(json::dump(record) == json::dump(records[count]));
+            ++count;
+        });
+    assert(count == records.size());
+    std::remove(filename);
+
+    std::istringstream numbers("[1, 2, 3]");
+    int sum = 0;
+    json::for_each_element<int>(numbers, [&sum](int value) { sum += value; });
+    assert(sum == 6);
+
+} // test_stream
+
+// ----------------------------------------------------------------------
+
+void test_errors()
+{
+    const char* sources[] = {"{}", "[1, 2", R"([{"id": 1}, {"id": "x"}])", R"([{"id": 1}, {"unknown": 1}])"};
+    for (const char* source: sources) {
+        try {
+            json::for_each_element<Record>(source, [](const Record&) {});
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+        try {
+            std::istringstream input(source);
+            json::for_each_element<Record>(input, [](const Record&) {});
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error (stream): " << err.what() << std::endl;
+        }
+    }
+
+} // test_errors
+
+// ----------------------------------------------------------------------
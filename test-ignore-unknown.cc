@@ -0,0 +1,131 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_ignore_unknown();
+static void test_strict();
+static void test_projection();
+
+// ----------------------------------------------------------------------
+
+class A
+{
+ public:
+    inline A() : i(0), f(0) {}
+
+    int i;
+    double f;
+    std::string s;
+
+    friend inline auto json_fields(A& a)
+        {
+            return std::make_tuple("i", &a.i, "f", &a.f, "s", &a.s, "?", json::comment("comment is never read"));
+        }
+};
+
+class B
+{
+ public:
+    std::vector<A> va;
+    A a;
+
+    friend inline auto json_fields(B& b)
+        {
+            return std::make_tuple("va", &b.va, "a", &b.a);
+        }
+};
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_ignore_unknown();
+    test_strict();
+    test_projection();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_ignore_unknown()
+{
+    const char* source = R"({"unknown1": {"x": [1, {"y": "]}"}, [[]]], "z": null},
+                             "va": [{"i": 1, "new": "q\"}]", "s": "one"}, {"s": "two", "old": [true, false, -1.5e3], "i": 2}],
+                             "a": {"i": 3, "?": "c", "deep": [[[[{"a": [[]]}]]]], "f": 3.5},
+                             "unknown2": 17})";
+    B b;
+    json::parse(source, b, json::ignore_unknown);
+    std::cout << json::dump(b, 1) << std::endl;
+    assert(b.va.size() == 2);
+    assert(b.va[0].i == 1 && b.va[0].s == "one");
+    assert(b.va[1].i == 2 && b.va[1].s == "two");
+    assert(b.a.i == 3 && b.a.f == 3.5);
+
+} // test_ignore_unknown
+
+// ----------------------------------------------------------------------
+
+void test_strict()
+{
+    const char* source = R"({"i": 1, "unknown": 2, "s": "one"})";
+    A a;
+    try {
+        json::parse(source, a);
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+} // test_strict
+
+// ----------------------------------------------------------------------
+
+class P
+{
+ public:
+    inline P() : i(0) {}
+
+    int i;
+    std::string s;
+
+    friend inline auto json_fields(P& p)
+        {
+            return std::make_tuple("s", &p.s, "i", &p.i);
+        }
+};
+
+class Q
+{
+ public:
+    int a = 0, b = 0, c = 0;
+
+    friend inline auto json_fields(Q& q)
+        {
+            return std::make_tuple("a", &q.a, "_", json::comment("comment"), "b", json::field(&q.b, json::output_only), "c", &q.c);
+        }
+};
+
+void test_projection()
+{
+    std::string source = R"({"i": 42, "s": "head", "tail": [)";
+    for (int i = 0; i < 1000; ++i)
+        source += R"({"x": [1, 2, 3], "y": "\"quoted\" {not} [an] object"}, )";
+    source += R"(null]})";
+
+    P p1;
+    json::parse(source, p1, json::projection);
+    assert(p1.i == 42 && p1.s == "head");
+
+    P p2;
+    json::parse(source, p2, json::ignore_unknown);
+    assert(p2.i == 42 && p2.s == "head");
+
+      // comments and output only fields are not counted as read
+    Q q;
+    json::parse(R"({"a": 1, "_": "hello", "b": 2, "c": 3, "tail": [1]})", q, json::projection);
+    assert(q.a == 1 && q.b == 0 && q.c == 3);
+
+} // test_projection
+
+// ----------------------------------------------------------------------
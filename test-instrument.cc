@@ -0,0 +1,137 @@
+#define JSON_STRUCT_INSTRUMENT
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_dump();
+static void test_parse();
+static void test_disabled();
+
+// ----------------------------------------------------------------------
+
+class Point
+{
+ public:
+    inline Point() : x(0), y(0) {}
+    inline Point(int aX, int aY) : x(aX), y(aY) {}
+
+    int x, y;
+
+    friend inline auto json_fields(Point& a, bool for_output)
+        {
+            if (for_output && a.x < 0)
+                throw json::no_value();
+            return std::make_tuple("x", &a.x, "y", &a.y);
+        }
+};
+
+class Path
+{
+ public:
+    std::string name;
+    std::vector<Point> points;
+    std::map<std::string, int> marks;
+
+    friend inline auto json_fields(Path& a)
+        {
+            return std::make_tuple("name", &a.name, "points", &a.points, "marks", &a.marks, "?", json::field(&a.name, json::output_only_if_not_empty));
+        }
+};
+
+static inline Path make_path()
+{
+    Path path;
+    for (int i = 0; i < 100; ++i)
+        path.points.emplace_back(i % 10 == 9 ? -1 : i, i * 2);
+    path.marks["a"] = 1;
+    path.marks["b"] = 2;
+    return path;
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_dump();
+    test_parse();
+    test_disabled();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_dump()
+{
+    const auto path = make_path();
+    json::instrument::profile profile;
+    std::string text;
+    {
+        json::instrument::scoped_observer observe(profile);
+        text = json::dump(path);
+    }
+    std::cout << json::dump(profile, 1) << std::endl;
+
+    const auto& path_entry = profile.dump.at("Path");
+    assert(path_entry.documents == 1 && path_entry.objects == 1);
+    assert(path_entry.bytes == text.size());
+    assert(path_entry.elements == 102); // points and marks
+    const auto& point_entry = profile.dump.at("Point");
+    assert(point_entry.objects == 100 && point_entry.skipped == 10);
+    assert(profile.dump.at(json::instrument::type_name(typeid(std::string))).reallocations > 0); // output buffer
+    assert(profile.parse.empty());
+
+} // test_dump
+
+// ----------------------------------------------------------------------
+
+void test_parse()
+{
+    const auto text = json::dump(make_path());
+    json::instrument::profile profile;
+    json::instrument::scoped_observer observe(profile);
+    Path path;
+    json::parse(text, path);
+    try {
+        json::parse(R"({"name": "x", "points": [{"x": 1, "z": 2}]})", path);
+        assert(false);
+    }
+    catch (json::parsing_error&) {
+    }
+    json::parse(text, path);
+
+    const auto& path_entry = profile.parse.at("Path");
+    assert(path_entry.documents == 3 && path_entry.objects == 2);
+    assert(path_entry.bytes == 2 * text.size());
+    assert(path_entry.elements == 2 * 92);
+    assert(profile.parse.at("Point").objects == 2 * 90); // objects of the failed document are not ended
+    assert(profile.parse.at(json::instrument::type_name(typeid(std::vector<Point>))).reallocations > 0);
+
+} // test_parse
+
+// ----------------------------------------------------------------------
+
+class Counter : public json::instrument::observer
+{
+ public:
+    inline Counter() : events(0) {}
+    size_t events;
+
+    virtual inline void object_begin(json::instrument::kind, const std::type_info&) { ++events; }
+};
+
+void test_disabled()
+{
+    Counter counter;
+    {
+        json::instrument::scoped_observer observe(counter);
+        json::dump(make_path());
+    }
+    const auto events = counter.events;
+    assert(events == 101);
+    json::dump(make_path()); // no observer
+    assert(counter.events == events);
+    assert(json::instrument::current() == nullptr);
+
+} // test_disabled
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,174 @@
+#include <thread>
+
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_parse();
+static void test_threads();
+static void test_patch();
+
+// ----------------------------------------------------------------------
+
+class Visit
+{
+ public:
+    inline Visit() : id(0) {}
+
+    int id;
+    json::interned_string country;
+    json::interned_string host;
+    std::vector<json::interned_string> tags;
+    std::string note;
+
+    friend inline auto json_fields(Visit& a)
+        {
+            return std::make_tuple("id", &a.id, "country", &a.country, "host", &a.host, "tags", &a.tags, "note", json::field(&a.note, json::output_if_not_empty));
+        }
+};
+
+  // the same as Visit, but with plain strings
+class PlainVisit
+{
+ public:
+    inline PlainVisit() : id(0) {}
+
+    int id;
+    std::string country;
+    std::string host;
+    std::vector<std::string> tags;
+    std::string note;
+
+    friend inline auto json_fields(PlainVisit& a)
+        {
+            return std::make_tuple("id", &a.id, "country", &a.country, "host", &a.host, "tags", &a.tags, "note", json::field(&a.note, json::output_if_not_empty));
+        }
+};
+
+static const char* const countries[] = {"DE", "FR", "NL", "US", "JP"};
+
+static inline std::vector<PlainVisit> make_visits(size_t number)
+{
+    std::vector<PlainVisit> visits(number);
+    for (size_t no = 0; no < number; ++no) {
+        auto& visit = visits[no];
+        visit.id = static_cast<int>(no);
+        visit.country = countries[no % 5];
+        visit.host = "frontend-" + std::to_string(no % 37) + ".eu-central.example.com";
+        visit.tags = {"tag-" + std::to_string(no % 3), "long tag shared by every visit"};
+        if (no % 10 == 0)
+            visit.note = "note " + std::to_string(no);
+    }
+    return visits;
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_parse();
+    test_threads();
+    test_patch();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_parse()
+{
+    const auto text = json::dump(make_visits(1000), 1);
+
+    json::string_pool pool;
+    std::vector<Visit> visits;
+    json::parse(text, visits, json::interning(pool));
+    assert(json::dump(visits, 1) == text);
+    assert(pool.size() == 5 + 37 + 3 + 1);
+    assert(visits[0].host.data() == visits[37].host.data()); // storage is shared
+    assert(visits[0].country == visits[5].country && visits[0].country != visits[1].country);
+    assert(&visits[0].tags[1].str() == &visits[999].tags[1].str());
+
+    const auto again = pool.intern("DE", 2);
+    assert(again.data() == visits[0].country.data());
+    assert(pool.size() == 46);
+
+    Visit visit;
+    json::parse(R"({"id": 1, "country": null, "host": "", "tags": ["a \"quoted\" tag"]})", visit, json::interning(pool));
+    assert(visit.country.empty() && visit.host.empty() && visit.tags[0].str() == R"(a \"quoted\" tag)");
+    assert(json::interned_string() == visit.country);
+
+      // without the pool option values cannot be read, null and empty strings need no pool
+    Visit without_pool;
+    try {
+        json::parse(R"({"id": 2, "country": "DE", "host": "h", "tags": []})", without_pool);
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+    json::parse(R"({"id": 2, "country": null, "host": "", "tags": []})", without_pool);
+    assert(without_pool.id == 2 && without_pool.country.empty());
+
+      // a pool grows beyond its expected size
+    json::string_pool small(2);
+    std::vector<json::interned_string> many;
+    for (int i = 0; i < 1000; ++i)
+        many.push_back(small.intern("value " + std::to_string(i)));
+    for (int i = 0; i < 1000; ++i)
+        assert(small.intern("value " + std::to_string(i)).data() == many[static_cast<size_t>(i)].data());
+    assert(small.size() == 1000);
+
+    std::vector<json::interned_string> pushed;
+    json::push_parser<std::vector<json::interned_string>> parser(pushed, json::interning(pool));
+    parser.feed(R"(["DE", "FR", )");
+    parser.feed(R"("XX"])");
+    parser.finish();
+    assert(pushed.size() == 3 && pushed[0].data() == visits[0].country.data() && pool.size() == 48);
+
+    size_t count = 0;
+    json::for_each_element<Visit>(text, [&](const Visit& item) { count += item.host.data() == visits[item.id].host.data(); }, json::interning(pool));
+    assert(count == visits.size());
+
+} // test_parse
+
+// ----------------------------------------------------------------------
+
+void test_threads()
+{
+    const auto text = json::dump(make_visits(20000));
+    json::string_pool pool(4);  // grows while threads are reading
+    std::vector<std::vector<Visit>> results(4);
+    std::vector<std::thread> threads;
+    for (auto& result: results)
+        threads.emplace_back([&text, &pool, &result]() { json::parse(text, result, json::interning(pool)); });
+    for (auto& thread: threads)
+        thread.join();
+
+    assert(pool.size() == 46);
+    for (const auto& result: results) {
+        assert(json::dump(result) == text);
+        for (size_t no = 0; no < result.size(); no += 97)
+            assert(result[no].host.data() == results[0][no].host.data());
+    }
+
+} // test_threads
+
+// ----------------------------------------------------------------------
+
+  // the patch has the text of changed interned strings, applying it adds them to the pool
+void test_patch()
+{
+    json::string_pool pool;
+    std::vector<Visit> visits;
+    json::parse(json::dump(make_visits(10)), visits, json::interning(pool));
+
+    Visit changed = visits[7];
+    changed.host = pool.intern("moved.example.com", 17);
+    const auto patch = json::dump_diff(visits[7], changed);
+    assert(patch == R"({"host": "moved.example.com"})");
+    Visit patched = visits[7];
+    json::apply_patch(patched, patch, json::interning(pool));
+    assert(patched.host == changed.host && patched.host.data() == changed.host.data());
+
+} // test_patch
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,197 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_diff();
+static void test_apply();
+static void test_few_changes();
+
+// ----------------------------------------------------------------------
+
+class Item
+{
+ public:
+    inline Item() : count(0), weight(0) {}
+
+    int count;
+    double weight;
+    std::vector<int> tags;
+
+    friend inline auto json_fields(Item& a)
+        {
+            return std::make_tuple("count", &a.count, "weight", &a.weight, "tags", &a.tags);
+        }
+};
+
+class State
+{
+ public:
+    inline State() : version(0) {}
+
+    int version;
+    std::string name;
+    std::string note;
+    Item main;
+    std::map<std::string, Item> items;
+    std::map<std::string, double> values;
+
+    friend inline auto json_fields(State& a)
+        {
+            return std::make_tuple("version", &a.version,
+                                   "name", &a.name,
+                                   "note", json::field(&a.note, json::output_if_not_empty),
+                                   "main", &a.main,
+                                   "items", &a.items,
+                                   "values", &a.values,
+                                   "?", json::comment("not in patches unless changed"));
+        }
+};
+
+static inline State make_state(size_t items)
+{
+    State state;
+    state.version = 1;
+    state.name = "state";
+    state.main.count = 3;
+    state.main.tags = {1, 2, 3};
+    for (size_t i = 0; i < items; ++i) {
+        auto& item = state.items["item-" + std::to_string(i)];
+        item.count = static_cast<int>(i);
+        item.weight = i * 0.5;
+        item.tags = {static_cast<int>(i), static_cast<int>(i) + 1};
+        state.values["value-" + std::to_string(i)] = i * 2.5;
+    }
+    return state;
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_diff();
+    test_apply();
+    test_few_changes();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_diff()
+{
+    const State s1 = make_state(3);
+    State s2 = s1;
+    assert(json::dump_diff(s1, s2) == "{}");
+    assert(json::dump_diff(s1, s2, 1) == "{}");
+
+    s2.version = 2;
+    s2.note = "changed";
+    s2.main.tags.push_back(4);
+    s2.items["item-1"].weight = 7;
+    s2.items.erase("item-2");
+    s2.items["item-9"].count = 9;
+    s2.values["value-0"] = -1;
+    const auto patch = json::dump_diff(s1, s2);
+    std::cout << patch << std::endl;
+    assert(patch == R"({"version": 2, "note": "changed", "main": {"tags": [1, 2, 3, 4]}, "items": {"item-1": {"weight": 7}, "item-2": null, "item-9": {"count": 9, "weight": 0, "tags": []}}, "values": {"value-0": -1}})");
+    std::cout << json::dump_diff(s1, s2, 1) << std::endl;
+
+    s2 = s1;
+    s2.note = "n";
+    const State s3 = s2;
+    s2.note.clear();
+    assert(json::dump_diff(s3, s2) == R"({"note": null})");
+
+    std::map<std::string, int> m1{{"a", 1}, {"b", 2}}, m2{{"b", 2}, {"c", 3}};
+    assert(json::dump_diff(m1, m2) == R"({"a": null, "c": 3})");
+    assert(json::dump_diff(1, 2) == "2");
+
+} // test_diff
+
+// ----------------------------------------------------------------------
+
+void test_apply()
+{
+    const State s1 = make_state(5);
+    State s2 = s1;
+    s2.version = 7;
+    s2.name = "renamed";
+    s2.note = "note";
+    s2.main.count = 0;
+    s2.main.tags.clear();
+    s2.items["item-3"].tags = {42};
+    s2.items.erase("item-0");
+    s2.items["new"].weight = 0.25;
+    s2.values.erase("value-4");
+
+    State target = s1;
+    json::apply_patch(target, json::dump_diff(s1, s2));
+    assert(json::dump(target) == json::dump(s2));
+
+    const State s3 = s2;
+    s2.note.clear();
+    json::apply_patch(target, json::dump_diff(s3, s2, 2));
+    assert(json::dump(target) == json::dump(s2));
+
+    json::apply_patch(target, R"({"version": null, "main": {"weight": null, "count": 5}, "values": {"value-1": null, "x": 1.5}})");
+    assert(target.version == 0 && target.main.count == 5 && std::isnan(target.main.weight));
+    assert(target.values.size() == s2.values.size() && target.values.count("value-1") == 0 && target.values["x"] == 1.5);
+    assert(target.items.size() == s2.items.size());
+
+      // NaN map entries: unchanged ones are not in the patch, a new NaN value cannot be passed (null removes the entry)
+    State with_nan = s2;
+    with_nan.values["nan"] = std::numeric_limits<double>::quiet_NaN();
+    State changed_nan = with_nan;
+    changed_nan.values["value-0"] = 42;
+    State patched_nan = with_nan;
+    json::apply_patch(patched_nan, json::dump_diff(with_nan, changed_nan));
+    assert(json::dump(patched_nan) == json::dump(changed_nan) && std::isnan(patched_nan.values["nan"]));
+    changed_nan.values["value-1"] = std::numeric_limits<double>::quiet_NaN();
+    for (const auto& values: {std::make_pair(with_nan.values, changed_nan.values), std::make_pair(s2.values, with_nan.values)}) {
+        try {
+            json::dump_diff(values.first, values.second);
+            assert(false);
+        }
+        catch (std::invalid_argument& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+    }
+    std::unordered_map<std::string, float> unordered{{"a", 1.0f}}, unordered_nan{{"a", std::numeric_limits<float>::quiet_NaN()}};
+    try {
+        json::dump_diff(unordered, unordered_nan);
+        assert(false);
+    }
+    catch (std::invalid_argument& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+    try {
+        json::apply_patch(target, R"({"unknown": null})");
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+} // test_apply
+
+// ----------------------------------------------------------------------
+
+  // patch of a big state with few changes has only the changes
+void test_few_changes()
+{
+    const State s1 = make_state(1000);
+    State s2 = s1;
+    s2.version = 2;
+    s2.items["item-500"].count = -1;
+    s2.values["value-999"] = 0;
+
+    const auto patch = json::dump_diff(s1, s2);
+    assert(patch == R"({"version": 2, "items": {"item-500": {"count": -1}}, "values": {"value-999": 0}})");
+
+    State target = s1;
+    json::apply_patch(target, patch);
+    assert(target.items["item-500"].count == -1 && target.values["value-999"] == 0 && target.items.size() == s1.items.size());
+
+} // test_few_changes
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,250 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_parse();
+static void test_output();
+static void test_std_array();
+static void test_errors();
+
+// ----------------------------------------------------------------------
+
+class Point
+{
+ public:
+    inline Point() : x(0), y(0) {}
+    inline Point(double aX, double aY) : x(aX), y(aY) {}
+
+    double x, y;
+
+    friend inline auto json_fields(Point& a)
+        {
+            return std::make_tuple("x", &a.x, "y", &a.y);
+        }
+};
+
+class Sample
+{
+ public:
+    inline Sample() : id(0), matrix{}, range{} {}
+
+    int id;
+    std::vector<double> values;
+    std::vector<unsigned> counts;
+    std::array<int, 3> matrix;
+    std::array<Point, 2> range;
+    std::array<std::string, 2> names;
+
+    friend inline auto json_fields(Sample& a)
+        {
+            return std::make_tuple("id", &a.id, "values", &a.values, "counts", &a.counts, "matrix", &a.matrix, "range", &a.range, "names", &a.names);
+        }
+};
+
+static inline Sample make_sample(int id)
+{
+    Sample sample;
+    sample.id = id;
+    for (int i = 0; i < id % 7; ++i) {
+        sample.values.push_back(id * 0.25 - i);
+        sample.counts.push_back(static_cast<unsigned>(id * i));
+    }
+    sample.matrix = {{id, -id, id * 1000}};
+    sample.range = {{Point(id, 0.5), Point(-id, 1e-3)}};
+    sample.names = {{"first " + std::to_string(id), "second"}};
+    return sample;
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_parse();
+    test_output();
+    test_std_array();
+    test_errors();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_parse()
+{
+    std::vector<int> integers{7, 7};
+    json::parse(" [ 1,-22 ,333,\n 4444 , 0, -0 ] ", integers);
+    assert(integers == (std::vector<int>{1, -22, 333, 4444, 0, 0}));
+    json::parse("[]", integers);
+    assert(integers.empty());
+
+    std::vector<long long> longs;
+    json::parse("[9223372036854775807, -9223372036854775808]", longs);
+    assert(longs[0] == std::numeric_limits<long long>::max() && longs[1] == std::numeric_limits<long long>::min());
+
+    std::vector<unsigned char> bytes;
+    json::parse("[0, 128, 255]", bytes);
+    assert(bytes == (std::vector<unsigned char>{0, 128, 255}));
+    std::vector<signed char> small;
+    json::parse("[127, -128]", small);
+    assert(small == (std::vector<signed char>{127, -128}));
+    std::vector<uint64_t> huge;
+    json::parse("[18446744073709551615]", huge);
+    assert(huge[0] == std::numeric_limits<uint64_t>::max());
+
+    std::vector<double> reals;
+    json::parse("[1, -2.5, 1e3, 0.125E-2, null, -0]", reals);
+    assert(reals.size() == 6 && reals[1] == -2.5 && reals[2] == 1000 && reals[3] == 0.00125 && std::isnan(reals[4]) && reals[5] == 0);
+    json::parse("[0.000000000000000000000000000000000000000000000000000000000000000000000000000001]", reals);
+    assert(reals.size() == 1 && reals[0] == 1e-78);
+
+    std::vector<float> floats;
+    json::parse("[0.5, 3]", floats);
+    assert(floats == (std::vector<float>{0.5f, 3.0f}));
+
+    std::vector<bool> flags; // not a number, generic path
+    json::parse("[true, false]", flags);
+    assert(flags.size() == 2 && flags[0] && !flags[1]);
+
+    std::vector<Sample> samples(10), parsed;
+    for (int id = 0; id < 10; ++id)
+        samples[static_cast<size_t>(id)] = make_sample(id);
+    const auto text = json::dump(samples, 2);
+    json::parse(text, parsed);
+    assert(json::dump(parsed, 2) == text);
+
+} // test_parse
+
+// ----------------------------------------------------------------------
+
+void test_output()
+{
+    const std::vector<int> integers{1, -22, 333};
+    assert(json::dump(integers) == "[1, -22, 333]");
+    assert(json::dump(integers, 2) == "[\n  1,\n  -22,\n  333\n]");
+    assert(json::dump(std::vector<int>{}) == "[]");
+    assert(json::dump(std::vector<int>{5}, 2) == "[\n  5\n]");
+    assert(json::dump(std::vector<double>{0.5, std::numeric_limits<double>::quiet_NaN(), -3}) == "[0.5, null, -3]");
+
+    std::map<std::string, std::vector<long>> nested{{"a", {1, 2}}, {"b", {}}, {"c", {std::numeric_limits<long>::min(), 0, std::numeric_limits<long>::max()}}};
+    for (int indent: {0, 1, 4}) {
+        const auto text = json::dump(nested, indent);
+        assert(json::dumped_size(nested, indent) == text.size());
+        std::map<std::string, std::list<long>> generic{{"a", {1, 2}}, {"b", {}}, {"c", {std::numeric_limits<long>::min(), 0, std::numeric_limits<long>::max()}}};
+        assert(json::dump(generic, indent) == text);
+    }
+
+      // more than fits into one formatting batch
+    std::vector<int> many(3000);
+    for (size_t i = 0; i < many.size(); ++i)
+        many[i] = static_cast<int>(i * 7919) - 1000000;
+    const std::list<int> many_list(many.begin(), many.end());
+    for (int indent: {0, 2, 100})
+        assert(json::dump(many, indent) == json::dump(many_list, indent));
+    const std::vector<double> fractions{0.5, -1.25, 3, std::numeric_limits<double>::quiet_NaN()};
+    const std::list<double> fractions_list(fractions.begin(), fractions.end());
+    for (int indent: {0, 2, 100}) {
+        assert(json::dump(fractions, indent) == json::dump(fractions_list, indent));
+        assert(json::dumped_size(fractions, indent) == json::dump(fractions_list, indent).size());
+    }
+
+} // test_output
+
+// ----------------------------------------------------------------------
+
+void test_std_array()
+{
+    std::array<int, 3> integers{};
+    json::parse("[1, 2, 3]", integers);
+    assert(integers == (std::array<int, 3>{{1, 2, 3}}));
+    assert(json::dump(integers) == "[1, 2, 3]");
+    std::array<double, 0> nothing;
+    json::parse(" [ ] ", nothing);
+    assert(json::dump(nothing) == "[]");
+
+    const Sample sample = make_sample(5);
+    const auto text = json::dump(sample);
+    std::cout << text << std::endl;
+
+    Sample pushed;
+    json::push_parser<Sample> parser(pushed);
+    for (size_t pos = 0; pos < text.size(); pos += 3)
+        parser.feed(text.data() + pos, std::min(size_t(3), text.size() - pos));
+    parser.finish();
+    assert(json::dump(pushed) == text);
+
+    Sample binary;
+    json::parse_cbor(json::dump_cbor(sample), binary);
+    assert(json::dump(binary) == text);
+    json::parse_msgpack(json::dump_msgpack(make_sample(6)), binary);
+    assert(json::dump(binary) == json::dump(make_sample(6)));
+
+    Sample snapshot;
+    json::parse_snapshot(json::dump_snapshot(sample), snapshot);
+    assert(json::dump(snapshot) == text);
+
+    Sample changed = sample;
+    changed.matrix[1] = 42;
+    const auto patch = json::dump_diff(sample, changed);
+    assert(patch == R"({"matrix": [5, 42, 5000]})");
+    Sample patched = sample;
+    json::apply_patch(patched, patch);
+    assert(json::dump(patched) == json::dump(changed));
+
+} // test_std_array
+
+// ----------------------------------------------------------------------
+
+void test_errors()
+{
+    auto expect_error = [](const char* source, auto target) {
+        try {
+            json::parse(source, target);
+            std::cerr << "no error for " << source << std::endl;
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+    };
+    expect_error("[1, 2", std::vector<int>());
+    expect_error("[1 2]", std::vector<int>());
+    expect_error("[1, ]", std::vector<int>());
+    expect_error("[1.5]", std::vector<int>());
+    expect_error("[-1]", std::vector<unsigned>());
+    expect_error("[null]", std::vector<int>());
+    expect_error("[1e]", std::vector<double>());
+    expect_error("[-]", std::vector<double>());
+    expect_error("[1, 2]", std::array<int, 3>());
+    expect_error("[1, 2, 3, 4]", std::array<int, 3>());
+    expect_error(R"({"matrix": [1, 2]})", Sample());
+    expect_error("[300]", std::vector<unsigned char>());
+    expect_error("[-129]", std::vector<signed char>());
+    expect_error("[3000000000]", std::vector<int>());
+    expect_error("[-2147483649]", std::vector<int>());
+    expect_error("[18446744073709551616]", std::vector<uint64_t>());
+    expect_error("[12345678901234567890123]", std::vector<long long>());
+    expect_error("[+5]", std::vector<int>());
+
+      // malformed input does not reserve storage for what looks like many items
+    for (const std::string& source: {"[" + std::string(100000, ',') + "]", "[1, 2," + std::string(100000, ',') + "]", "[1, x" + std::string(100000, ',') + "]"}) {
+        std::vector<double> values;
+        try {
+            json::parse(source, values);
+            assert(false);
+        }
+        catch (json::parsing_error&) {
+        }
+        assert(values.capacity() <= 2);
+    }
+
+    std::array<int, 2> target;
+    try {
+        json::parse_cbor(json::dump_cbor(std::vector<int>{1, 2, 3}), target);
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+} // test_errors
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,188 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_chunks();
+static void test_options();
+static void test_errors();
+
+// ----------------------------------------------------------------------
+
+class Point
+{
+ public:
+    inline Point() : x(0), y(0) {}
+
+    double x, y;
+
+    friend inline auto json_fields(Point& a)
+        {
+            return std::make_tuple("x", &a.x, "y", &a.y);
+        }
+};
+
+class Shape
+{
+ public:
+    inline Shape() : closed(false), layer(0) {}
+
+    std::string name;
+    bool closed;
+    std::vector<Point> points;
+    std::set<std::string> tags;
+    std::map<std::string, std::vector<int>> groups;
+    Point center;
+    std::string label;
+
+    inline int get_layer() const { return layer; }
+    inline void set_layer(int aLayer) { layer = aLayer; }
+    inline Point get_center() const { return center; }
+    inline void set_center(const Point& aCenter) { center = aCenter; }
+
+    friend inline auto json_fields(Shape& a)
+        {
+            return std::make_tuple("name", &a.name,
+                                   "closed", &a.closed,
+                                   "points", &a.points,
+                                   "tags", &a.tags,
+                                   "groups", &a.groups,
+                                   "layer", json::field(&a, &Shape::get_layer, &Shape::set_layer),
+                                   "center", json::field(&a, &Shape::get_center, &Shape::set_center),
+                                   "label", json::field(&a.label, json::output_if_not_empty),
+                                   "?", json::comment("comment"));
+        }
+
+ private:
+    int layer;
+};
+
+class Drawing
+{
+ public:
+    std::vector<Shape> shapes;
+    std::map<std::string, double> scale;
+
+    friend inline auto json_fields(Drawing& a)
+        {
+            return std::make_tuple("shapes", &a.shapes, "scale", &a.scale);
+        }
+};
+
+static inline Drawing make_drawing(size_t shapes)
+{
+    Drawing drawing;
+    for (size_t no = 0; no < shapes; ++no) {
+        Shape shape;
+        shape.name = "shape \\\"" + std::to_string(no) + "\\\" {[,]}";
+        shape.closed = no % 2 == 0;
+        for (size_t i = 0; i < no % 5; ++i) {
+            Point point;
+            point.x = no * 1.5 + i;
+            point.y = -static_cast<double>(i) / 3.0;
+            shape.points.push_back(point);
+        }
+        shape.tags = {"t" + std::to_string(no % 3), "all"};
+        shape.groups["g" + std::to_string(no % 4)] = {1, 2, static_cast<int>(no)};
+        shape.groups["empty"];
+        shape.set_layer(static_cast<int>(no % 7));
+        Point center;
+        center.x = static_cast<double>(no);
+        center.y = std::numeric_limits<double>::quiet_NaN();
+        shape.set_center(center);
+        if (no % 3 == 0)
+            shape.label = "label " + std::to_string(no);
+        drawing.shapes.push_back(shape);
+    }
+    drawing.scale["x"] = 0.5;
+    drawing.scale["y"] = 2;
+    return drawing;
+}
+
+template <typename T> static inline void push(T& target, const std::string& source, size_t chunk)
+{
+    json::push_parser<T> parser(target);
+    for (size_t pos = 0; pos < source.size(); pos += chunk) {
+        parser.feed(source.data() + pos, std::min(chunk, source.size() - pos));
+    }
+    parser.finish();
+    assert(parser.done());
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_chunks();
+    test_options();
+    test_errors();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_chunks()
+{
+    const auto source = json::dump(make_drawing(20), 2);
+    for (size_t chunk: {1, 2, 3, 7, 16, 64, 1000, 100000}) {
+        Drawing drawing;
+        push(drawing, source, chunk);
+        assert(json::dump(drawing, 2) == source);
+    }
+
+    std::vector<int> numbers;
+    push(numbers, " [1, -22, 333 , 4444]\n", 1);
+    assert(numbers == (std::vector<int>{1, -22, 333, 4444}));
+    double number = 0;
+    push(number, "-12.5e1", 3);
+    assert(number == -125);
+    std::string text;
+    push(text, R"("a \"quoted\" text")", 4);
+    assert(text == R"(a \"quoted\" text)");
+    std::map<std::string, Point> points;
+    push(points, R"({"a": {"x": 1, "y": 2}, "b": {}})", 5);
+    assert(points.size() == 2 && points["a"].y == 2);
+
+} // test_chunks
+
+// ----------------------------------------------------------------------
+
+void test_options()
+{
+    Point point;
+    json::push_parser<Point> parser(point, json::ignore_unknown);
+    parser.feed(R"({"z": [1, {"a": "}"}], "x": 1, "w": {"q": null}, "y")");
+    assert(!parser.done());
+    parser.feed(R"(: 2})");
+    parser.finish();
+    assert(point.x == 1 && point.y == 2);
+
+} // test_options
+
+// ----------------------------------------------------------------------
+
+void test_errors()
+{
+    const char* sources[] = {
+        R"({"x": 1, "z": 2})",
+        R"({"x": 1 "y": 2})",
+        R"({"x": [1]})",
+        R"({"x": 1, "y": 2)",
+        R"({"x": 1, "y": 2} x)",
+        R"({"x": 1x})",
+        R"({"x": "1"})",
+        R"({"x": 1, "y": )",
+    };
+    for (const char* source: sources) {
+        try {
+            Point point;
+            push(point, source, 3);
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+    }
+
+} // test_errors
+
+// ----------------------------------------------------------------------
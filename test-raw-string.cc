@@ -0,0 +1,172 @@
+#include <fstream>
+#include <cstdio>
+
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_parse();
+static void test_file();
+static void test_errors();
+
+// ----------------------------------------------------------------------
+
+class Event
+{
+ public:
+    inline Event() : id(0) {}
+
+    int id;
+    json::raw_string kind;
+    json::raw_string message;
+    std::vector<json::raw_string> labels;
+
+    friend inline auto json_fields(Event& a)
+        {
+            return std::make_tuple("id", &a.id, "kind", &a.kind, "message", &a.message, "labels", &a.labels);
+        }
+};
+
+  // the same as Event, but with copied strings
+class PlainEvent
+{
+ public:
+    inline PlainEvent() : id(0) {}
+
+    int id;
+    std::string kind;
+    std::string message;
+    std::vector<std::string> labels;
+
+    friend inline auto json_fields(PlainEvent& a)
+        {
+            return std::make_tuple("id", &a.id, "kind", &a.kind, "message", &a.message, "labels", &a.labels);
+        }
+};
+
+  // recursive, i.e. has_raw_string looks into Node once
+class Node
+{
+ public:
+    json::raw_string name;
+    std::vector<Node> children;
+    std::map<std::string, std::vector<Node>> groups;
+
+    friend inline auto json_fields(Node& a)
+        {
+            return std::make_tuple("name", &a.name, "children", &a.children, "groups", &a.groups);
+        }
+};
+
+static inline std::vector<PlainEvent> make_events(size_t number)
+{
+    std::vector<PlainEvent> events(number);
+    for (size_t no = 0; no < number; ++no) {
+        auto& event = events[no];
+        event.id = static_cast<int>(no);
+        event.kind = no % 2 ? "request" : "response";
+        event.message = "event " + std::to_string(no) + " with a \\\"quoted\\\" message longer than the small string buffer";
+        event.labels = {"label-" + std::to_string(no % 5), ""};
+    }
+    return events;
+}
+
+static inline bool inside(const json::raw_string& value, const std::string& source)
+{
+    return value.data() >= source.data() && value.data() + value.size() <= source.data() + source.size();
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_parse();
+    test_file();
+    test_errors();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_parse()
+{
+    const auto text = json::dump(make_events(100), 2);
+    std::vector<Event> events;
+    json::parse(text, events);
+    assert(json::dump(events, 2) == text);
+    for (const auto& event: events) {
+        assert(inside(event.kind, text) && inside(event.message, text) && inside(event.labels[0], text));
+        assert(event.labels[1].empty());
+    }
+    assert(events[3].kind == json::raw_string("request") && events[3].kind.str() == "request");
+    assert(events[4].message.str() == R"(event 4 with a \"quoted\" message longer than the small string buffer)"); // escapes are kept as with std::string
+
+    Event event;
+    const std::string empty = R"({"id": 1, "kind": null, "message": "", "labels": []})";
+    json::parse(empty, event);
+    assert(event.kind.empty() && event.message.empty());
+
+    Event changed = events[7];
+    const std::string moved = "moved";
+    changed.kind = moved;
+    const auto patch = json::dump_diff(events[7], changed);
+    assert(patch == R"({"kind": "moved"})");
+    Event patched = events[7];
+    json::apply_patch(patched, patch);
+    assert(patched.kind == changed.kind && inside(patched.kind, patch));
+
+      // json::parse(json::dump(x), events) does not compile, events would point into the temporary
+    static_assert(json::u::has_raw_string<Event>::value && json::u::has_raw_string<std::vector<Event>>::value, "");
+    static_assert(json::u::has_raw_string<Node>::value && json::u::has_raw_string<std::map<std::string, Node>>::value, "");
+    static_assert(!json::u::has_raw_string<PlainEvent>::value && !json::u::has_raw_string<std::vector<PlainEvent>>::value, "");
+    std::vector<PlainEvent> plain;
+    json::parse(json::dump(make_events(3)), plain);
+    assert(plain.size() == 3 && plain[2].kind == "response");
+
+} // test_parse
+
+// ----------------------------------------------------------------------
+
+void test_file()
+{
+    const auto text = json::dump(make_events(1000));
+    const char* filename = "test-raw-string.tmp";
+    std::ofstream(filename) << text;
+
+    std::vector<Event> events;
+    {
+        const auto mapping = json::parse_file(filename, events);
+        std::remove(filename);  // mapping stays valid
+        assert(json::dump(events) == text);
+        assert(events[10].message.data() >= mapping->data() && events[10].message.data() < mapping->data() + mapping->size());
+    }
+
+} // test_file
+
+// ----------------------------------------------------------------------
+
+void test_errors()
+{
+    try {
+        Event event;
+        json::push_parser<Event> parser(event);
+        parser.feed(R"({"id": 1, "kind": "request"})");
+        parser.finish();
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+    try {
+        std::vector<Event> events;
+        json::parse_file("test-raw-string.does-not-exist", events);
+        assert(false);
+    }
+    catch (std::runtime_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+} // test_errors
+
+// ----------------------------------------------------------------------
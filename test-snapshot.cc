@@ -0,0 +1,418 @@
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+class A
+{
+ public:
+    inline A() : i(0), f(0) {}
+    inline A(int aI) : i(aI), f(aI / 3.0), s(std::to_string(aI)), vd(static_cast<size_t>(aI % 5), aI * 0.5) {}
+
+    int i;
+    double f;
+    std::string s;
+    std::vector<double> vd;
+
+    friend inline auto json_fields(A& a, bool for_output)
+        {
+            if (for_output && a.i % 7 == 6)
+                throw json::no_value();
+            return std::make_tuple("i", &a.i, "f", &a.f, "s", &a.s, "vd", &a.vd);
+        }
+};
+
+class S
+{
+ public:
+    inline S() : version(0), flag(false) {}
+
+    int version;
+    bool flag;
+    std::string name;
+    std::vector<int> vi;
+    std::vector<A> va;
+    std::set<std::string> tags;
+    std::map<std::string, A> index;
+    std::vector<int> not_written;
+
+    friend inline auto json_fields(S& s)
+        {
+            return std::make_tuple("version", &s.version, "flag", &s.flag, "name", &s.name, "vi", &s.vi, "va", &s.va, "tags", &s.tags,
+                                   "index", &s.index, "not_written", json::field(&s.not_written, json::output_if_not_empty), "?", json::comment("snapshot test"));
+        }
+};
+
+class Visit
+{
+ public:
+    inline Visit() : id(0) {}
+
+    int id;
+    json::interned_string country;
+    std::vector<json::interned_string> tags;
+
+    friend inline auto json_fields(Visit& a)
+        {
+            return std::make_tuple("id", &a.id, "country", &a.country, "tags", &a.tags);
+        }
+};
+
+class Event
+{
+ public:
+    inline Event() : id(0) {}
+
+    int id;
+    json::raw_string message;
+    std::vector<json::raw_string> labels;
+
+    friend inline auto json_fields(Event& a)
+        {
+            return std::make_tuple("id", &a.id, "message", &a.message, "labels", &a.labels);
+        }
+};
+
+static inline bool inside(const json::raw_string& value, const std::string& data)
+{
+    return value.data() >= data.data() && value.data() + value.size() <= data.data() + data.size();
+}
+
+// ----------------------------------------------------------------------
+
+class Attachment
+{
+ public:
+    inline Attachment() : id(0) {}
+
+    int id;
+    json::blob thumbnail;
+
+    friend inline auto json_fields(Attachment& a)
+        {
+            return std::make_tuple("id", &a.id, "thumbnail", &a.thumbnail);
+        }
+};
+
+static inline std::vector<Attachment> make_attachments()
+{
+    std::vector<Attachment> attachments(31);
+    for (size_t no = 0; no < attachments.size(); ++no) {
+        std::vector<unsigned char> bytes(no < 30 ? no * 11 : 70000); // 32 bit sizes for the last one
+        for (size_t i = 0; i < bytes.size(); ++i)
+            bytes[i] = static_cast<unsigned char>(i * 7 + no);
+        attachments[no].id = static_cast<int>(no);
+        attachments[no].thumbnail = bytes;
+    }
+    return attachments;
+}
+
+// ----------------------------------------------------------------------
+
+class Point
+{
+ public:
+    int id = 0;
+    double x = 0;
+    std::string label;
+
+    friend inline auto json_fields(Point& a)
+        {
+            return std::make_tuple("id", &a.id, "x", &a.x, "label", &a.label);
+        }
+};
+
+class Points
+{
+ public:
+    std::vector<Point> items;
+
+    friend inline auto json_fields(Points& a)
+        {
+            return std::make_tuple("items", json::field(&a.items, json::columnar));
+        }
+};
+
+static inline Points make_points()
+{
+    Points points;
+    points.items.resize(40);
+    for (size_t no = 0; no < points.items.size(); ++no) {
+        points.items[no].id = static_cast<int>(no);
+        points.items[no].x = static_cast<double>(no) / 4;
+        points.items[no].label = no % 2 ? "odd" : "even";
+    }
+    return points;
+}
+
+// ----------------------------------------------------------------------
+
+namespace events
+{
+    enum class Severity { debug, info, warning, error, fatal };
+
+    inline auto json_enum_names(Severity)
+    {
+        return json::enum_names<Severity>{{Severity::debug, "debug"}, {Severity::info, "info"}, {Severity::warning, "warning"}, {Severity::error, "error"}, {Severity::fatal, "fatal"}};
+    }
+
+    class Log
+    {
+     public:
+        inline Log() : level(Severity::info) {}
+
+        Severity level;
+        std::vector<Severity> history;
+        std::map<std::string, Severity> sources;
+
+        friend inline auto json_fields(Log& a)
+            {
+                return std::make_tuple("level", &a.level, "history", &a.history, "sources", &a.sources);
+            }
+    };
+
+    static inline Log make_log()
+    {
+        Log log;
+        log.level = Severity::warning;
+        for (int no = 0; no < 12; ++no)
+            log.history.push_back(static_cast<Severity>(no % 5));
+        log.sources = {{"db", Severity::error}, {"cache", Severity::debug}};
+        return log;
+    }
+
+} // namespace events
+
+// ----------------------------------------------------------------------
+
+  // counts and indexes of the (untrusted) data must not lead to reading outside of it
+template <typename T, typename Item> static inline void expect_corrupt(const T& value, uint64_t count, Item item)
+{
+    const std::string text = json::dump_snapshot(value);
+    std::vector<uint64_t> data((text.size() + 7) / 8);
+    std::memcpy(data.data(), text.data(), text.size());
+    data[data[2] / 8] = count;  // the count at the root value
+    const auto root = json::snapshot::root_view<T>(reinterpret_cast<const char*>(data.data()), text.size());
+    for (size_t no = 0; no < 3; ++no) {
+        try {
+            switch (no) {
+              case 0: root.materialize(); break;
+              case 1: root.size(); break;
+              case 2: item(root, 300); break;
+            }
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+    }
+}
+
+static inline void test_corrupt()
+{
+    const auto index = [](const auto& root, size_t no) { return root[no]; };
+    expect_corrupt(std::vector<double>{1, 2, 3}, (uint64_t(1) << 61) + 1, index);
+    expect_corrupt(std::vector<int>{1, 2, 3}, 1000, index);
+    expect_corrupt(std::vector<std::string>{"a", "b"}, (uint64_t(1) << 61) + 1, index);
+    expect_corrupt(std::map<std::string, int>{{"a", 1}}, uint64_t(1) << 60, [](const auto& root, size_t no) { return root.value(no); });
+
+    const std::string numbers = json::dump_snapshot(std::vector<double>{1, 2, 3});
+    std::vector<uint64_t> aligned((numbers.size() + 7) / 8);
+    std::memcpy(aligned.data(), numbers.data(), numbers.size());
+    const auto vd = json::snapshot::root_view<std::vector<double>>(reinterpret_cast<const char*>(aligned.data()), numbers.size());
+    assert(vd.size() == 3 && vd[2] == 3);
+    try {
+        vd[3];
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+
+    const std::string text = json::dump_snapshot(std::string("abc"));
+    std::vector<uint64_t> data((text.size() + 7) / 8);
+    std::memcpy(data.data(), text.data(), text.size());
+    const auto root = json::snapshot::root_view<std::string>(reinterpret_cast<const char*>(data.data()), text.size());
+    assert(root.str() == "abc");
+    for (uint64_t size: {~uint64_t(0), ~uint64_t(0) - 7, uint64_t(1) << 20}) {
+        data[data[2] / 8] = size;
+        try {
+            root.str();
+            assert(false);
+        }
+        catch (json::parsing_error& err) {
+            std::cerr << "expected error: " << err.what() << std::endl;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+
+  // unordered and flat containers are written and materialized as other maps and sets
+static inline void test_containers()
+{
+    std::unordered_map<std::string, int> hash;
+    json::flat_set<std::string> tags;
+    for (int no = 0; no < 30; ++no) {
+        hash.emplace("key-" + std::to_string(no * 7919 % 10007), no);
+        tags.insert("tag-" + std::to_string(no % 17));
+    }
+
+    const auto snapshot = json::dump_snapshot(hash);
+    json::flat_map<int> flat;
+    json::parse_snapshot(snapshot, flat);
+    assert(json::dump(flat) == json::dump(hash, 0, json::sorted_keys));
+    std::unordered_map<std::string, int> hash2;
+    json::parse_snapshot(json::dump_snapshot(flat), hash2);
+    assert(hash2 == hash);
+
+    std::set<std::string> tags2;
+    json::parse_snapshot(json::dump_snapshot(tags), tags2);
+    assert(json::dump(tags2) == json::dump(tags));
+}
+
+// ----------------------------------------------------------------------
+
+  // interned strings are materialized into the pool given with json::interning, without a pool it fails
+static inline void test_interning()
+{
+    const char* const countries[] = {"DE", "FR", "NL", "US", "JP"};
+    json::string_pool pool;
+    std::vector<Visit> visits(50);
+    for (size_t no = 0; no < visits.size(); ++no) {
+        visits[no].id = static_cast<int>(no);
+        visits[no].country = pool.intern(countries[no % 5]);
+        visits[no].tags = {pool.intern("tag-" + std::to_string(no % 3)), pool.intern("shared")};
+    }
+
+    const auto data = json::dump_snapshot(visits);
+    std::vector<Visit> snapshot;
+    json::parse_snapshot(data, snapshot, json::interning(pool));
+    assert(json::dump(snapshot) == json::dump(visits) && snapshot[3].country.data() == visits[3].country.data());
+    assert(json::snapshot::root_view<std::vector<Visit>>(data.data(), data.size())[4].field(&Visit::country).materialize(&pool).data() == visits[4].country.data());
+    try {
+        json::parse_snapshot(data, snapshot);
+        assert(false);
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "expected error: " << err.what() << std::endl;
+    }
+}
+
+// ----------------------------------------------------------------------
+
+  // raw strings materialized from a snapshot point into its data
+static inline void test_raw_strings()
+{
+    const std::vector<std::string> messages{"plain", "with \"quotes\" and \\ escapes", std::string(100, 'x'), ""};
+    std::vector<Event> events(messages.size());
+    for (size_t no = 0; no < events.size(); ++no) {
+        events[no].id = static_cast<int>(no);
+        events[no].message = json::raw_string(messages[no].data(), messages[no].size());
+        events[no].labels = {json::raw_string(messages[0].data(), messages[0].size()), events[no].message};
+    }
+
+    const auto data = json::dump_snapshot(events);
+    std::vector<Event> snapshot;
+    json::parse_snapshot(data, snapshot);
+    assert(json::dump(snapshot) == json::dump(events) && inside(snapshot[1].message, data) && inside(snapshot[2].labels[1], data));
+}
+
+// ----------------------------------------------------------------------
+
+  // enums with json_enum_names() are read back from a snapshot
+static inline void test_enums()
+{
+    const auto log = events::make_log();
+    events::Log snapshot;
+    json::parse_snapshot(json::dump_snapshot(log), snapshot);
+    assert(json::dump(snapshot) == json::dump(log));
+}
+
+// ----------------------------------------------------------------------
+
+  // blobs are stored as bytes and can be viewed without copying
+static inline void test_blobs()
+{
+    const auto attachments = make_attachments();
+    const auto data = json::dump_snapshot(attachments);
+    std::vector<Attachment> snapshot;
+    json::parse_snapshot(data, snapshot);
+    assert(json::dump(snapshot) == json::dump(attachments));
+    const auto thumbnail = json::snapshot::root_view<std::vector<Attachment>>(data.data(), data.size())[7].field(&Attachment::thumbnail);
+    assert(thumbnail.size() == 77 && std::equal(attachments[7].thumbnail.begin(), attachments[7].thumbnail.end(), thumbnail.bytes()));
+}
+
+// ----------------------------------------------------------------------
+
+  // json::columnar fields are materialized back into items
+static inline void test_columnar()
+{
+    const auto points = make_points();
+    Points snapshot;
+    json::parse_snapshot(json::dump_snapshot(points), snapshot);
+    assert(json::dump(snapshot) == json::dump(points));
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_corrupt();
+    test_containers();
+    test_interning();
+    test_raw_strings();
+    test_enums();
+    test_blobs();
+    test_columnar();
+
+    S s;
+    s.version = 3;
+    s.flag = true;
+    s.name = "state";
+    for (int i = 0; i < 1000; ++i) {
+        s.vi.push_back(i * 3 - 7);
+        s.va.emplace_back(i);
+    }
+    for (int i = 0; i < 100; ++i)
+        s.index.emplace("k" + std::to_string(i), A(i));
+    s.tags = {"x", "y", "z"};
+
+    const std::string data = json::dump_snapshot(s);
+
+    const char* filename = "test-snapshot.tmp";
+    std::ofstream(filename, std::ios::binary) << data;
+
+    json::snapshot::file<S> file(filename);
+    const auto root = file.root();
+
+    assert(root.field(&S::version) == 3);
+    assert(root.field<bool>("flag"));
+    assert(root.field(&S::name).str() == "state");
+    const auto vi = root.field(&S::vi);
+    assert(vi.size() == s.vi.size() && std::equal(vi.begin(), vi.end(), s.vi.begin()));
+    const auto va = root.field(&S::va);
+    assert(va.size() == s.va.size() - s.va.size() / 7); // every 7th is not written
+    assert(va[10].field(&A::s).str() == "11");
+    assert(va[10].field(&A::vd).size() == 1 && va[10].field(&A::vd)[0] == 5.5);
+    const auto index = root.field(&S::index);
+    assert(index["k42"].field(&A::i) == 42);
+    assert(index.find("k13") == index.size());
+    assert(!root.has("not_written") && root.has("?"));
+
+    S s1 = file.materialize();
+    S expected = s;
+    expected.va.erase(std::remove_if(expected.va.begin(), expected.va.end(), [](const A& a) { return a.i % 7 == 6; }), expected.va.end());
+    for (auto it = expected.index.begin(); it != expected.index.end(); )
+        it = it->second.i % 7 == 6 ? expected.index.erase(it) : std::next(it);
+    assert(json::dump(s1) == json::dump(expected));
+
+    std::remove(filename);
+    return 0;
+}
+
+// ----------------------------------------------------------------------
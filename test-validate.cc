@@ -0,0 +1,224 @@
+#include "json-struct.hh"
+
+// ----------------------------------------------------------------------
+
+static void test_well_formed();
+static void test_schema();
+static void test_against_parse();
+
+// ----------------------------------------------------------------------
+
+enum class Priority { low, high };
+
+inline auto json_enum_names(Priority)
+{
+    return json::enum_names<Priority>{{Priority::low, "low"}, {Priority::high, "high"}};
+}
+
+class Line
+{
+ public:
+    inline Line() : quantity(0), price(0) {}
+
+    std::string sku;
+    unsigned char quantity;
+    double price;
+
+    friend inline auto json_fields(Line& a)
+        {
+            return std::make_tuple("sku", &a.sku, "quantity", &a.quantity, "price", &a.price);
+        }
+};
+
+class Order
+{
+ public:
+    inline Order() : id(0), paid(false), priority(Priority::low), position{} {}
+
+    long id;
+    bool paid;
+    Priority priority;
+    std::string customer;
+    std::vector<Line> lines;
+    std::map<std::string, std::vector<int>> tags;
+    std::array<double, 2> position;
+
+    int get_version() const { return 2; }
+    void set_version(int) {}
+
+    friend inline auto json_fields(Order& a)
+        {
+            return std::make_tuple("_", json::comment("order"), "id", &a.id, "paid", &a.paid, "priority", &a.priority, "customer", &a.customer,
+                                   "lines", &a.lines, "tags", &a.tags, "position", &a.position,
+                                   "version", json::field(&a, &Order::get_version, &Order::set_version));
+        }
+};
+
+static inline std::vector<Order> make_orders(size_t number)
+{
+    std::vector<Order> orders(number);
+    for (size_t no = 0; no < number; ++no) {
+        auto& order = orders[no];
+        order.id = static_cast<long>(no) * 1000;
+        order.paid = no % 2 == 0;
+        order.priority = no % 3 ? Priority::low : Priority::high;
+        order.customer = "customer \\\"" + std::to_string(no % 100) + "\\\" \\u00e9";
+        order.lines.resize(no % 4);
+        for (auto& line: order.lines) {
+            line.sku = "SKU-" + std::to_string(no);
+            line.quantity = static_cast<unsigned char>(no % 256);
+            line.price = static_cast<double>(no) / 8;
+        }
+        if (no % 5 == 0)
+            order.tags = {{"a", {1, 2}}, {"b", {}}};
+        order.position = {{-0.5, 1e10}};
+    }
+    return orders;
+}
+
+template <typename... Option> static inline bool valid(const std::string& source, Option... option)
+{
+    try {
+        json::validate(source, option...);
+        return true;
+    }
+    catch (json::parsing_error&) {
+        return false;
+    }
+}
+
+template <typename T, typename... Option> static inline bool valid_for(const std::string& source, Option... option)
+{
+    try {
+        json::validate<T>(source, option...);
+        return true;
+    }
+    catch (json::parsing_error& err) {
+        std::cerr << "    " << err.what() << std::endl;
+        return false;
+    }
+}
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_well_formed();
+    test_schema();
+    test_against_parse();
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void test_well_formed()
+{
+    const char* good[] = {
+        "0", "-0", "1.5e-3", "-12E+2", " true ", "false", "null", R"("")", R"("a\"b\\c\/\b\f\n\r\té")",
+        "[]", "[ ]", "[1, [2, [3, {}]]]", R"({"a": {"b": [null, true]}, "": 1})", "\n{ \"x\" :\t[ 1 , 2 ] }\r\n",
+    };
+    for (const char* source: good) {
+        if (!valid(source))
+            std::cerr << "rejected " << source << std::endl;
+        assert(valid(source));
+    }
+
+    const char* bad[] = {
+        "", " ", "01", "1.", ".5", "+1", "-", "1e", "0x10", "tru", "nul", "True", R"("abc)", R"("\x")", R"("\u12G4")", "\"a\nb\"",
+        "[1,]", "[1 2]", "[", "]", "{", R"({"a" 1})", R"({"a": 1,})", R"({a: 1})", R"({"a": 1} x)", "1 2", "[1]]", R"({"a": [}])",
+    };
+    for (const char* source: bad) {
+        if (valid(source))
+            std::cerr << "accepted " << source << std::endl;
+        assert(!valid(source));
+    }
+
+    assert(valid(json::dump(make_orders(100), 2)));
+
+} // test_well_formed
+
+// ----------------------------------------------------------------------
+
+void test_schema()
+{
+    const auto orders = make_orders(100);
+    const auto text = json::dump(orders, 1);
+    assert(valid_for<std::vector<Order>>(text));
+    assert(valid_for<Order>(json::dump(orders[3])));
+
+    assert(valid_for<std::vector<int>>("[1, -2147483648, 2147483647]"));
+    assert(!valid_for<std::vector<int>>("[2147483648]"));
+    assert(!valid_for<std::vector<int>>("[1.5]"));
+    assert(!valid_for<std::vector<unsigned>>("[-1]"));
+    assert(valid_for<std::vector<uint64_t>>("[18446744073709551615]"));
+    assert(!valid_for<std::vector<uint64_t>>("[18446744073709551616]"));
+    assert(valid_for<std::vector<double>>("[1, null, 2.5e3]"));
+    assert(!valid_for<std::vector<double>>(R"([1, "2"])"));
+    assert(valid_for<std::vector<bool>>("[true, 0, 1, false]"));
+    assert(!valid_for<std::vector<bool>>("[null]"));
+    assert(valid_for<std::vector<std::string>>(R"(["a", null])"));
+    assert(!valid_for<std::vector<std::string>>("[1]"));
+    typedef std::map<std::string, std::array<int, 2>> pairs;
+    assert(valid_for<pairs>(R"({"a": [1, 2], "b": [3, 4]})"));
+    assert(!valid_for<pairs>(R"({"a": [1, 2, 3]})"));
+    typedef std::array<int, 2> pair;
+    assert(!valid_for<pair>("[1]"));
+    assert(!valid_for<std::vector<int>>("{}"));
+    assert(valid_for<std::vector<Priority>>(R"(["low", "high"])"));
+    assert(!valid_for<std::vector<Priority>>(R"(["medium"])"));
+
+    assert(valid_for<Order>(R"({"id": 1})")); // missing fields are fine
+    assert(valid_for<Order>(R"({"_": "comment is skipped", "version": 3})"));
+    assert(!valid_for<Order>(R"({"id": "1"})"));
+    assert(!valid_for<Order>(R"({"id": 1, "lines": [{"quantity": 256}]})"));
+    assert(!valid_for<Order>(R"({"id": 1, "lines": [{"sku": 5}]})"));
+    assert(!valid_for<Order>(R"({"id": 1, "extra": {"x": [1]}})"));
+    assert(valid_for<Order>(R"({"id": 1, "extra": {"x": [1]}})", json::ignore_unknown));
+    assert(valid_for<Order>(R"({"id": 1, "extra": {"x": [1]}})", json::projection));
+    assert(!valid_for<Order>(R"({"id": 1, "extra": {"x": [1}})", json::ignore_unknown));
+    assert(!valid_for<Order>(R"({"id": 1} [])"));
+    assert(!valid_for<Order>("[]"));
+
+} // test_schema
+
+// ----------------------------------------------------------------------
+
+  // whatever validate<T> accepts, parse reads
+void test_against_parse()
+{
+    const auto text = json::dump(make_orders(8));
+    size_t accepted = 0;
+    for (size_t pos = 0; pos < text.size(); ++pos) {
+        const auto source = text.substr(0, pos) + text.substr(pos + 1);
+        bool ok = true;
+        try {
+            json::validate<std::vector<Order>>(source);
+        }
+        catch (json::parsing_error&) {
+            ok = false;
+        }
+        if (ok) {
+            ++accepted;
+            std::vector<Order> target;
+            json::parse(source, target);
+        }
+    }
+    std::cout << "removing one char of " << text.size() << ": " << accepted << " documents still valid" << std::endl;
+
+      // where validate<T> is stricter than parse (see json::validate)
+    const char* stricter[] = {
+        R"({"id": 01})", R"({"id": 99999999999999999999})", R"({"position": [.5, 1]})", R"({"position": [1., 01]})",
+        R"({"position": [+1, 2]})", R"({"customer": "a\qb"})", "{\"customer\": \"a\tb\"}", R"({"customer": "\u12"})", R"({"id": 1} x)",
+    };
+    for (const char* source: stricter)
+        assert(!valid_for<Order>(source));
+    typedef std::array<double, 2> position_t;
+    for (const char* source: {R"([.5, 1])", R"([1., +2])", R"([01, 2])"}) {
+        position_t position;
+        json::parse(source, position);
+        assert(!valid_for<position_t>(source));
+    }
+
+} // test_against_parse
+
+// ----------------------------------------------------------------------